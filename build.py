@@ -76,6 +76,29 @@ platform_win_clang = platform_win._replace(
 )
 
 
+# Headless platform for batch runs on build machines (no window, input, audio or renderer)
+platform_linux = Platform(
+        name                  = 'linux',
+        compiler              = 'g++',
+        toolset               = 'GCC',
+        common_compiler_flags = [
+            '-std=c++17', '-g', '-fno-rtti', '-fno-exceptions', '-fno-strict-aliasing', '-Wall', '-Werror',
+            '-Wno-unknown-pragmas',
+            '-Wno-comment',
+            '-Wno-switch',              # Unhandled enum case in switch
+            '-Wno-sign-compare',
+            '-Wno-parentheses',
+            '-Wno-unused-variable',
+            '-Wno-unused-but-set-variable',
+            '-Wno-unused-function',
+            '-Wno-class-memaccess',
+            '-Wno-stringop-truncation',
+            '-Wno-missing-braces'
+            ],
+        libs                  = ['-lpthread'],
+        common_linker_flags   = []
+)
+
 
 Config = namedtuple('Configuration', ['name', 'platform', 'cmdline_opts', 'compiler_flags', 'linker_flags'])
 
@@ -107,11 +130,31 @@ config_win_release = Config(
         linker_flags   = ['/debug:full']
 )
 
+config_linux_debug = config_win_debug._replace(
+        platform       = platform_linux,
+        compiler_flags = ['-DDEBUG=1', '-O0'],
+        linker_flags   = []
+)
+config_linux_develop = config_win_develop._replace(
+        platform       = platform_linux,
+        compiler_flags = ['-DDEVELOP=1', '-O2'],
+        linker_flags   = []
+)
+config_linux_release = config_win_release._replace(
+        platform       = platform_linux,
+        compiler_flags = ['-DRELEASE=1', '-O2'],
+        linker_flags   = []
+)
+
 
 default_config = config_win_debug
 # default_config = config_win_develop
 default_platform = platform_win
 
+if sys.platform.startswith('linux'):
+    default_config = config_linux_debug
+    default_platform = platform_linux
+
 
 class colors:
     GRAY = '\033[1;30m'
@@ -141,11 +184,13 @@ def print_color(text, color_string):
 
 
 def begin_time():
-    subprocess.call(['ctime', '-begin', 'rr.time'])
+    if default_platform is platform_win:
+        subprocess.call(['ctime', '-begin', 'rr.time'])
 
 def end_time():
     # TODO Check this picks up failures etc.
-    subprocess.call(['ctime', '-end', 'rr.time'])
+    if default_platform is platform_win:
+        subprocess.call(['ctime', '-end', 'rr.time'])
 
     
 if __name__ == '__main__':
@@ -196,12 +241,20 @@ if __name__ == '__main__':
     # TODO Determine platform/config
     platform = default_platform
     config = default_config
-    if in_args.debug:
-        config = config_win_debug
-    elif in_args.dev:
-        config = config_win_develop
-    elif in_args.release:
-        config = config_win_release
+    if platform is platform_linux:
+        if in_args.debug:
+            config = config_linux_debug
+        elif in_args.dev:
+            config = config_linux_develop
+        elif in_args.release:
+            config = config_linux_release
+    else:
+        if in_args.debug:
+            config = config_win_debug
+        elif in_args.dev:
+            config = config_win_develop
+        elif in_args.release:
+            config = config_win_release
 
     with open(os.path.join(binpath, 'config'), 'w') as cfg_file:
         print(f'-> Config \'{config.name}\'')
@@ -271,6 +324,24 @@ if __name__ == '__main__':
 
             ret |= subprocess.call(out_args, cwd=binpath)
 
+        elif platform.toolset == 'GCC':
+            # Build headless platform executable (game code is linked in statically)
+            out_args = [platform.compiler]
+            out_args.extend(platform.common_compiler_flags)
+            out_args.extend(config.compiler_flags)
+            out_args.append(os.path.join(srcpath, 'linux_platform.cpp'))
+            out_args.extend(['-o', 'robotrider_headless'])
+            out_args.extend(platform.common_linker_flags)
+            out_args.extend(config.linker_flags)
+            out_args.extend(platform.libs)
+
+            if in_args.verbose:
+                print('\nBuilding headless platform executable...')
+                print_color(out_args, colors.GRAY)
+            cfg_file.write(f'Platform exe args:\n{out_args}\n\n')
+
+            ret = subprocess.call(out_args, cwd=binpath)
+
         else:
             sys.exit('Unsupported toolset')
 
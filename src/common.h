@@ -14,7 +14,11 @@
 #define persistent static
 
 
+#if _MSC_VER
 #define HALT() (__debugbreak(), 1) //( (*(volatile int *)0x0A55 = 0) != 0 )
+#else
+#define HALT() (__builtin_trap(), 1)
+#endif
 #if !RELEASE
 #define ASSERT(expr) ((void)( !(expr) && (globalAssertHandler( #expr, __FILE__, __LINE__ ), 1) && HALT()))
 #define ASSERTM(expr, msg) ((void)( !(expr) && (globalAssertHandler( msg, __FILE__, __LINE__ ), 1) && HALT()))
@@ -239,12 +243,13 @@ int main()
 
 */
 
+// NOTE Return by value (no function-local static) so these are usable in constant expressions on all compilers
 #define _ENUM_BUILDER(x) static constexpr EnumName x() \
-    { static EnumName _inst = { #x, (u32)Enum::x, ValueType() }; return _inst; }
+    { return EnumName{ #x, (u32)Enum::x, ValueType() }; }
 #define _ENUM_BUILDER_WITH_NAMES(x, n) static constexpr EnumName x() \
-    { static EnumName _inst = { n, (u32)Enum::x, ValueType() }; return _inst; }
+    { return EnumName{ n, (u32)Enum::x, ValueType() }; }
 #define _ENUM_BUILDER_WITH_VALUES(x, v) static constexpr EnumName x() \
-    { static EnumName _inst = { #x, (u32)Enum::x, v }; return _inst; }
+    { return EnumName{ #x, (u32)Enum::x, v }; }
 #define _ENUM_ENTRY(x, ...) x,
 #define _ENUM_NAME(x, ...) x().name,
 #define _ENUM_ITEM(x, ...) x(),
@@ -36,10 +36,12 @@ struct ConsoleCommand
 };
 
 internal COMMAND(CmdSub);
+internal COMMAND(CmdMemStats);
 
 internal ConsoleCommand knownCommands[] =
 {
     { "sub", CmdSub },
+    { "memstats", CmdMemStats },
 };
 
 
@@ -230,3 +232,24 @@ CmdSub( const char *args, char *output )
     return true;
 }
 
+internal bool
+CmdMemStats( const char *args, char *output )
+{
+#if !RELEASE
+    char filename[256] = "memstats.txt";
+    sscanf( args, "%255s", filename );
+
+    if( !DEBUGglobalMemoryStats || !DumpMemoryStats( DEBUGglobalMemoryStats, filename ) )
+    {
+        snprintf( output, CONSOLE_LINE_MAXLEN, "Error writing memory stats to '%s'", filename );
+        return false;
+    }
+
+    snprintf( output, CONSOLE_LINE_MAXLEN, "Memory stats written to '%s'", filename );
+    return true;
+#else
+    snprintf( output, CONSOLE_LINE_MAXLEN, "Memory stats are not tracked in release builds" );
+    return false;
+#endif
+}
+
@@ -318,17 +318,89 @@ struct Array2
 
 /////     GRID (wrapper for multi-dimensional arrays)   /////
 
-template <typename T>
+// Memory layouts for Grid3D. They just map cell coords to an offset into the grid's storage
+
+// Row-major, X first
+struct LinearGridLayout
+{
+    v3i dims;
+
+    void Init( v3i const& dims_ )
+    {
+        dims = dims_;
+    }
+
+    sz StorageCount() const
+    {
+        return (sz)dims.x * dims.y * dims.z;
+    }
+
+    INLINE sz Offset( int x, int y, int z ) const
+    {
+        return ((sz)z * dims.y + y) * dims.x + x;
+    }
+
+    // Offset of the cell at p + delta, given the offset of the cell at p
+    INLINE sz Step( sz offset, v3i const& p, v3i const& delta ) const
+    {
+        return offset + ((sz)delta.z * dims.y + delta.y) * dims.x + delta.x;
+    }
+};
+
+// Cells are grouped in cubic tiles that are stored one after the other (X first), so neighbours along any axis
+// are most likely in the same tile. Dims are padded to a whole number of tiles
+template <int TileSizeLog2>
+struct TiledGridLayout
+{
+    static const int TileSize = 1 << TileSizeLog2;
+    static const int TileMask = TileSize - 1;
+    static const int TileCellCount = TileSize * TileSize * TileSize;
+
+    v3i tileDims;
+
+    void Init( v3i const& dims_ )
+    {
+        tileDims = { (dims_.x + TileMask) >> TileSizeLog2, (dims_.y + TileMask) >> TileSizeLog2, (dims_.z + TileMask) >> TileSizeLog2 };
+    }
+
+    sz StorageCount() const
+    {
+        return (sz)tileDims.x * tileDims.y * tileDims.z * TileCellCount;
+    }
+
+    INLINE sz Offset( int x, int y, int z ) const
+    {
+        sz tileIndex = ((sz)(z >> TileSizeLog2) * tileDims.y + (y >> TileSizeLog2)) * tileDims.x + (x >> TileSizeLog2);
+        i32 cellIndex = ((z & TileMask) << (2 * TileSizeLog2)) | ((y & TileMask) << TileSizeLog2) | (x & TileMask);
+        return tileIndex * TileCellCount + cellIndex;
+    }
+
+    // Offset of the cell at p + delta, given the offset of the cell at p
+    INLINE sz Step( sz offset, v3i const& p, v3i const& delta ) const
+    {
+        // Cells inside a tile are linear, so we only need the full calculation when crossing into another tile
+        v3i tileP = { (p.x & TileMask) + delta.x, (p.y & TileMask) + delta.y, (p.z & TileMask) + delta.z };
+        if( (u32)tileP.x < (u32)TileSize && (u32)tileP.y < (u32)TileSize && (u32)tileP.z < (u32)TileSize )
+            return offset + (delta.z * TileSize + delta.y) * TileSize + delta.x;
+        else
+            return Offset( p.x + delta.x, p.y + delta.y, p.z + delta.z );
+    }
+};
+
+// NOTE Layouts other than linear mean 'data' can't be indexed directly
+template <typename T, typename Layout = LinearGridLayout>
 struct Grid3D
 {
     T* data;
     v3i dims;
+    Layout layout;
 
 
     Grid3D()
     {
         data = nullptr;
         dims = V3iZero;
+        layout = {};
     }
 
     Grid3D( MemoryArena* arena, v3i dims_, MemoryParams params = DefaultMemoryParams() )
@@ -337,7 +409,8 @@ struct Grid3D
         ASSERT( dims_.y > 0 );
         ASSERT( dims_.z > 0 );
         dims = dims_;
-        data = PUSH_ARRAY( arena, T, dims.x * dims.y * dims.z, params );
+        layout.Init( dims );
+        data = PUSH_ARRAY( arena, T, layout.StorageCount(), params );
     }
 
     INLINE T& operator()( int x, int y, int z )
@@ -345,7 +418,7 @@ struct Grid3D
         ASSERT( x >= 0 && x < dims.x );
         ASSERT( y >= 0 && y < dims.y );
         ASSERT( z >= 0 && z < dims.z );
-        return data[ z * dims.y * dims.x + y * dims.x + x ];
+        return data[ layout.Offset( x, y, z ) ];
     }
 
     INLINE T const& operator()( int x, int y, int z ) const
@@ -353,7 +426,7 @@ struct Grid3D
         ASSERT( x >= 0 && x < dims.x );
         ASSERT( y >= 0 && y < dims.y );
         ASSERT( z >= 0 && z < dims.z );
-        return data[ z * dims.y * dims.x + y * dims.x + x ];
+        return data[ layout.Offset( x, y, z ) ];
     }
 
 #if 0
@@ -375,7 +448,7 @@ struct Grid3D
         ASSERT( v.x >= 0 && v.x < dims.x );
         ASSERT( v.y >= 0 && v.y < dims.y );
         ASSERT( v.z >= 0 && v.z < dims.z );
-        return data[ v.z * dims.y * dims.x + v.y * dims.x + v.x ];
+        return data[ layout.Offset( v.x, v.y, v.z ) ];
     }
 
     INLINE T const& operator()( v3i const& v ) const
@@ -383,7 +456,240 @@ struct Grid3D
         ASSERT( v.x >= 0 && v.x < dims.x );
         ASSERT( v.y >= 0 && v.y < dims.y );
         ASSERT( v.z >= 0 && v.z < dims.z );
-        return data[ v.z * dims.y * dims.x + v.y * dims.x + v.x ];
+        return data[ layout.Offset( v.x, v.y, v.z ) ];
+    }
+
+    // Keeps the storage offset of the current cell, so its neighbours (and the next cell along X) are found by stepping
+    // from it, instead of working out the full offset from their coords every time
+    struct Cursor
+    {
+        Grid3D* grid;
+        v3i p;
+        sz offset;
+
+        INLINE T& Cell() const
+        {
+            ASSERT( p.x >= 0 && p.x < grid->dims.x );
+            ASSERT( p.y >= 0 && p.y < grid->dims.y );
+            ASSERT( p.z >= 0 && p.z < grid->dims.z );
+            return grid->data[ offset ];
+        }
+
+        INLINE T& Neighbour( v3i const& delta ) const
+        {
+            ASSERT( p.x + delta.x >= 0 && p.x + delta.x < grid->dims.x );
+            ASSERT( p.y + delta.y >= 0 && p.y + delta.y < grid->dims.y );
+            ASSERT( p.z + delta.z >= 0 && p.z + delta.z < grid->dims.z );
+            return grid->data[ grid->layout.Step( offset, p, delta ) ];
+        }
+
+        INLINE T& Neighbour( int dx, int dy, int dz ) const
+        {
+            return Neighbour( V3i( dx, dy, dz ) );
+        }
+
+        // NOTE Can step past the end of a row, as long as the cell there is not accessed
+        INLINE void NextX()
+        {
+            offset = grid->layout.Step( offset, p, V3i( 1, 0, 0 ) );
+            p.x++;
+        }
+    };
+
+    INLINE Cursor CursorAt( int x, int y, int z )
+    {
+        return { this, V3i( x, y, z ), layout.Offset( x, y, z ) };
+    }
+};
+
+// Sparse version of the above, for big grids that are mostly empty.
+// Space is split into cubic bricks, and a brick only gets its own cells once something different from its current
+// (uniform) value is written to it. Until then, it's stored as just that one value.
+// NOTE Non-const access always makes the brick dense, so use Get() for reading
+template <typename T, int BrickSizeLog2 = 3>
+struct BrickGrid3D
+{
+    static const int BrickSize = 1 << BrickSizeLog2;
+    static const int BrickMask = BrickSize - 1;
+    static const int BrickCellCount = BrickSize * BrickSize * BrickSize;
+
+    struct DenseBrick
+    {
+        DenseBrick* next;
+        i32 brickIndex;
+        T cells[BrickCellCount];
+    };
+
+    // Per brick. Null if all its cells have the same value
+    DenseBrick** denseBricks;
+    T* uniformValues;
+    // All dense bricks, for quick iteration
+    DenseBrick* firstDenseBrick;
+    i32 denseBrickCount;
+
+    v3i dims;
+    v3i brickDims;
+
+    MemoryArena* arena;
+    MemoryParams memoryParams;
+
+
+    BrickGrid3D()
+    {
+        denseBricks = nullptr;
+        uniformValues = nullptr;
+        firstDenseBrick = nullptr;
+        denseBrickCount = 0;
+        dims = brickDims = V3iZero;
+        arena = nullptr;
+        memoryParams = {};
+    }
+
+    BrickGrid3D( MemoryArena* arena_, v3i dims_, T initialValue = T(), MemoryParams params = DefaultMemoryParams() )
+    {
+        ASSERT( dims_.x > 0 && (dims_.x & BrickMask) == 0 );
+        ASSERT( dims_.y > 0 && (dims_.y & BrickMask) == 0 );
+        ASSERT( dims_.z > 0 && (dims_.z & BrickMask) == 0 );
+        dims = dims_;
+        brickDims = { dims.x >> BrickSizeLog2, dims.y >> BrickSizeLog2, dims.z >> BrickSizeLog2 };
+        arena = arena_;
+        memoryParams = params;
+
+        i32 brickCount = BrickCount();
+        denseBricks = PUSH_ARRAY( arena, DenseBrick*, brickCount, params );
+        uniformValues = PUSH_ARRAY( arena, T, brickCount, NoClearParams( params ) );
+        for( int b = 0; b < brickCount; ++b )
+            uniformValues[b] = initialValue;
+
+        firstDenseBrick = nullptr;
+        denseBrickCount = 0;
+    }
+
+    i32 BrickCount() const
+    {
+        return brickDims.x * brickDims.y * brickDims.z;
+    }
+
+    v3i BrickOrigin( i32 brickIndex ) const
+    {
+        v3i result =
+        {
+            (brickIndex % brickDims.x) << BrickSizeLog2,
+            ((brickIndex / brickDims.x) % brickDims.y) << BrickSizeLog2,
+            (brickIndex / (brickDims.x * brickDims.y)) << BrickSizeLog2,
+        };
+        return result;
+    }
+
+    INLINE T Get( int x, int y, int z ) const
+    {
+        ASSERT( x >= 0 && x < dims.x );
+        ASSERT( y >= 0 && y < dims.y );
+        ASSERT( z >= 0 && z < dims.z );
+
+        i32 brickIndex = BrickIndex( x, y, z );
+        DenseBrick const* brick = denseBricks[brickIndex];
+        return brick ? brick->cells[CellIndex( x, y, z )] : uniformValues[brickIndex];
+    }
+
+    INLINE T& operator()( int x, int y, int z )
+    {
+        ASSERT( x >= 0 && x < dims.x );
+        ASSERT( y >= 0 && y < dims.y );
+        ASSERT( z >= 0 && z < dims.z );
+
+        i32 brickIndex = BrickIndex( x, y, z );
+        DenseBrick* brick = denseBricks[brickIndex];
+        if( !brick )
+            brick = MakeDense( brickIndex );
+        return brick->cells[CellIndex( x, y, z )];
+    }
+
+    INLINE T const& operator()( int x, int y, int z ) const
+    {
+        ASSERT( x >= 0 && x < dims.x );
+        ASSERT( y >= 0 && y < dims.y );
+        ASSERT( z >= 0 && z < dims.z );
+
+        i32 brickIndex = BrickIndex( x, y, z );
+        DenseBrick const* brick = denseBricks[brickIndex];
+        return brick ? brick->cells[CellIndex( x, y, z )] : uniformValues[brickIndex];
+    }
+
+    INLINE T& operator()( v3i const& v )
+    {
+        return (*this)( v.x, v.y, v.z );
+    }
+
+    INLINE T const& operator()( v3i const& v ) const
+    {
+        return (*this)( v.x, v.y, v.z );
+    }
+
+    // Sets all cells between min & max (inclusive). Fully covered bricks that are not dense yet just change their uniform value
+    void Fill( v3i const& minP, v3i const& maxP, T value )
+    {
+        ASSERT( minP.x >= 0 && minP.y >= 0 && minP.z >= 0 );
+        ASSERT( maxP.x < dims.x && maxP.y < dims.y && maxP.z < dims.z );
+
+        for( int bk = minP.z >> BrickSizeLog2; bk <= maxP.z >> BrickSizeLog2; ++bk )
+            for( int bj = minP.y >> BrickSizeLog2; bj <= maxP.y >> BrickSizeLog2; ++bj )
+                for( int bi = minP.x >> BrickSizeLog2; bi <= maxP.x >> BrickSizeLog2; ++bi )
+                {
+                    v3i brickMinP = V3i( bi << BrickSizeLog2, bj << BrickSizeLog2, bk << BrickSizeLog2 );
+                    v3i brickMaxP = brickMinP + V3i( BrickMask );
+                    i32 brickIndex = (bk * brickDims.y + bj) * brickDims.x + bi;
+
+                    bool covered = minP.x <= brickMinP.x && minP.y <= brickMinP.y && minP.z <= brickMinP.z
+                        && maxP.x >= brickMaxP.x && maxP.y >= brickMaxP.y && maxP.z >= brickMaxP.z;
+                    if( covered && !denseBricks[brickIndex] )
+                    {
+                        uniformValues[brickIndex] = value;
+                        continue;
+                    }
+                    if( !denseBricks[brickIndex] && uniformValues[brickIndex] == value )
+                        continue;
+
+                    DenseBrick* brick = denseBricks[brickIndex] ? denseBricks[brickIndex] : MakeDense( brickIndex );
+                    for( int k = Max( minP.z, brickMinP.z ); k <= Min( maxP.z, brickMaxP.z ); ++k )
+                        for( int j = Max( minP.y, brickMinP.y ); j <= Min( maxP.y, brickMaxP.y ); ++j )
+                            for( int i = Max( minP.x, brickMinP.x ); i <= Min( maxP.x, brickMaxP.x ); ++i )
+                                brick->cells[CellIndex( i, j, k )] = value;
+                }
+    }
+
+private:
+
+    INLINE i32 BrickIndex( int x, int y, int z ) const
+    {
+        return ((z >> BrickSizeLog2) * brickDims.y + (y >> BrickSizeLog2)) * brickDims.x + (x >> BrickSizeLog2);
+    }
+
+    INLINE static i32 CellIndex( int x, int y, int z )
+    {
+        return ((z & BrickMask) << (2 * BrickSizeLog2)) | ((y & BrickMask) << BrickSizeLog2) | (x & BrickMask);
+    }
+
+    static MemoryParams NoClearParams( MemoryParams params )
+    {
+        params.flags &= ~MemoryFlags_ClearToZero;
+        return params;
+    }
+
+    DenseBrick* MakeDense( i32 brickIndex )
+    {
+        DenseBrick* result = PUSH_STRUCT( arena, DenseBrick, NoClearParams( memoryParams ) );
+        result->brickIndex = brickIndex;
+        T value = uniformValues[brickIndex];
+        for( int c = 0; c < BrickCellCount; ++c )
+            result->cells[c] = value;
+
+        result->next = firstDenseBrick;
+        firstDenseBrick = result;
+        denseBrickCount++;
+
+        denseBricks[brickIndex] = result;
+        return result;
     }
 };
 
@@ -522,23 +828,63 @@ struct RingStack
 
 
 /////     HASH TABLE    /////
+// Open addressing with Robin Hood probing: on insertion, entries that are closer to their ideal slot give way
+// to those further away, so probe sequences stay short even at high load. Deletion shifts the following entries back
+// instead of leaving tombstones.
+// When the load gets too high a table twice as big is pushed from the arena, and entries are moved over a few at a time
+// on every insertion & removal (lookups check both tables in the meantime), so no single operation pays for a full rehash.
+// Values live in separate pages that never move, so pointers returned by Find & InsertEmpty stay valid until
+// that key is removed (or the table is cleared).
 
 // NOTE Type K must support == comparison
+// Hash functions don't need to be great, as the result is mixed again before masking
 template <typename K, typename V, u32 (*H)( const K&, i32 )>
 struct HashTable
 {
-    struct Slot
+    struct ValueEntry
     {
-        Slot* nextInHash;
         V value;
+        ValueEntry* nextFree;
+    };
+
+    struct ValuePage
+    {
+        ValuePage* next;
+        ValueEntry* entries;
+    };
+
+    struct Slot
+    {
         K key;
-        bool occupied;
+        ValueEntry* entry;
+        // Zero means empty
+        u32 hash;
+    };
+
+    struct Table
+    {
+        Slot* slots;
+        u32 mask;
     };
 
+    static const i32 ValuePageSize = 256;
+    // Slots moved to the new table on each insertion or removal while growing
+    static const i32 MigrationStepSize = 8;
+
+
+    Table table;
+    // Only valid while growing
+    Table oldTable;
+    u32 migrationIndex;
 
-    Slot* table;
-    i32 tableSize;
     i32 count;
+    // Passed to the hash function, so hashes don't change when growing
+    i32 initialCapacity;
+
+    ValuePage* firstPage;
+    ValuePage* currentPage;
+    i32 currentPageUsed;
+    ValueEntry* freeEntries;
 
     MemoryArena* arena;
     MemoryParams memoryParams;
@@ -547,87 +893,79 @@ struct HashTable
     HashTable( MemoryArena* arena_, int size, MemoryParams params = DefaultMemoryParams() )
     {
         ASSERT( size > 0 );
-        table = PUSH_ARRAY( arena_, Slot, size, params );
-        tableSize = size;
-        count = 0;
         arena = arena_;
         memoryParams = params;
 
-        Clear();
+        u32 capacity = IsPowerOf2( (sz)size ) ? (u32)size : NextPowerOf2( (u32)size );
+        table = AllocTable( capacity );
+        initialCapacity = (i32)capacity;
+        oldTable = {};
+        migrationIndex = 0;
+        count = 0;
+
+        firstPage = currentPage = nullptr;
+        currentPageUsed = 0;
+        freeEntries = nullptr;
     }
 
     // Disallow implicit copying
     HashTable( const HashTable& ) = delete;
     HashTable& operator =( const HashTable& ) = delete;
 
+    i32 Capacity() const
+    {
+        return (i32)table.mask + 1;
+    }
+
     void Clear()
     {
-        for( int i = 0; i < tableSize; ++i )
-            table[i].occupied = false;
-        // FIXME Add existing externally chained elements to a free list like in BucketArray
+        // An ongoing migration can just be dropped
+        oldTable = {};
+        migrationIndex = 0;
+
+        for( u32 i = 0; i <= table.mask; ++i )
+            table.slots[i].hash = 0;
         count = 0;
+
+        // Reuse all value pages from the start
+        currentPage = firstPage;
+        currentPageUsed = 0;
+        freeEntries = nullptr;
     }
 
     V* Find( const K& key )
     {
-        int idx = IndexFromKey( key );
-
-        Slot* slot = &table[idx];
-        if( slot->occupied )
-        {
-            do
-            {
-                if( slot->key == key )
-                    return &slot->value;
+        u32 hash = HashKey( key );
 
-                slot = slot->nextInHash;
-            } while( slot );
-        }
+        Slot* slot = FindSlot( table, key, hash );
+        if( !slot && oldTable.slots )
+            slot = FindSlot( oldTable, key, hash );
 
-        return nullptr;
+        return slot ? &slot->entry->value : nullptr;
     }
 
     const V* Find( const K& key ) const
     {
-        return Find( key );
+        return const_cast<HashTable*>(this)->Find( key );
     }
 
-#if 0
-    V& operator[]( const K& key )
-    {
-        return *Find( key );
-    }
-#endif
-
+    // Returns null if the key was already present
     V* InsertEmpty( const K& key )
     {
-        int idx = IndexFromKey( key );
-
-        Slot* prev = nullptr;
-        Slot* slot = &table[idx];
-        if( slot->occupied )
-        {
-            do
-            {
-                // TODO Allow key comparisons different from bit-equality if needed
-                if( slot->key == key )
-                    return nullptr;
-
-                prev = slot;
-                slot = slot->nextInHash;
-            } while( slot );
+        if( Find( key ) )
+            return nullptr;
 
-            slot = PUSH_STRUCT( arena, Slot, memoryParams );
-            prev->nextInHash = slot;
-        }
+        if( (u32)(count + 1) * 8 > (table.mask + 1) * 7 )
+            Grow();
+        else
+            MigrateStep();
 
+        ValueEntry* entry = AllocEntry();
+        PZERO( &entry->value, sizeof(V) );
+        InsertIntoTable( &table, key, HashKey( key ), entry );
         count++;
-        slot->occupied = true;
-        slot->key = key;
-        slot->nextInHash = nullptr;
-        PZERO( &slot->value, sizeof(V) );
 
-        return &slot->value;
+        return &entry->value;
     }
 
     bool Insert( const K& key, const V& value )
@@ -644,58 +982,210 @@ struct HashTable
         return result;
     }
 
+    // Returns whether the key was present
+    bool Remove( const K& key )
+    {
+        u32 hash = HashKey( key );
+
+        Table* owner = &table;
+        Slot* slot = FindSlot( table, key, hash );
+        if( !slot && oldTable.slots )
+        {
+            owner = &oldTable;
+            slot = FindSlot( oldTable, key, hash );
+        }
+        if( !slot )
+            return false;
+
+        slot->entry->nextFree = freeEntries;
+        freeEntries = slot->entry;
+        RemoveFromTable( owner, (u32)(slot - owner->slots) );
+        count--;
+
+        MigrateStep();
+        return true;
+    }
+
     Array<K> Keys( MemoryArena* arena_, MemoryParams params = DefaultMemoryParams() ) const
     {
         Array<K> result( arena_, count, params );
-        for( int i = 0; i < tableSize; ++i )
+        // Old table (if any) first
+        Table const* tables[] = { &oldTable, &table };
+        for( Table const* t : tables )
+            for( u32 i = 0; t->slots && i <= t->mask; ++i )
+                if( t->slots[i].hash )
+                    result.Push( t->slots[i].key );
+        return result;
+    }
+
+    // NOTE Same order as Keys()
+    Array<V> Values( MemoryArena* arena_, MemoryParams params = DefaultMemoryParams() ) const
+    {
+        Array<V> result( arena_, count, params );
+        // Old table (if any) first
+        Table const* tables[] = { &oldTable, &table };
+        for( Table const* t : tables )
+            for( u32 i = 0; t->slots && i <= t->mask; ++i )
+                if( t->slots[i].hash )
+                    result.Push( t->slots[i].entry->value );
+        return result;
+    }
+
+private:
+
+    static u32 Distance( u32 hash, u32 index, u32 mask )
+    {
+        return (index - (hash & mask)) & mask;
+    }
+
+    u32 HashKey( const K& key ) const
+    {
+        // Finalizer from MurmurHash3
+        u32 hash = H( key, initialCapacity );
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+        // Zero is reserved for empty slots
+        return hash ? hash : 1;
+    }
+
+    Table AllocTable( u32 capacity )
+    {
+        Table result;
+        result.slots = PUSH_ARRAY( arena, Slot, capacity, memoryParams );
+        result.mask = capacity - 1;
+        for( u32 i = 0; i < capacity; ++i )
+            result.slots[i].hash = 0;
+        return result;
+    }
+
+    ValueEntry* AllocEntry()
+    {
+        ValueEntry* result = freeEntries;
+        if( result )
+            freeEntries = result->nextFree;
+        else
         {
-            if( table[i].occupied )
+            if( !currentPage || currentPageUsed == ValuePageSize )
             {
-                result.Push( table[i].key );
-                if( table[i].nextInHash )
+                ValuePage* nextPage = currentPage ? currentPage->next : firstPage;
+                if( !nextPage )
                 {
-                    Slot* slot = table[i].nextInHash;
-                    while( slot )
-                    {
-                        result.Push( slot->key );
-                        slot = slot->nextInHash;
-                    }
+                    nextPage = PUSH_STRUCT( arena, ValuePage, memoryParams );
+                    nextPage->entries = PUSH_ARRAY( arena, ValueEntry, ValuePageSize, memoryParams );
+                    nextPage->next = nullptr;
+
+                    if( currentPage )
+                        currentPage->next = nextPage;
+                    else
+                        firstPage = nextPage;
                 }
+                currentPage = nextPage;
+                currentPageUsed = 0;
             }
+            result = currentPage->entries + currentPageUsed++;
         }
         return result;
     }
 
-    Array<V> Values( MemoryArena* arena_, MemoryParams params = DefaultMemoryParams() ) const
+    static Slot* FindSlot( Table const& t, const K& key, u32 hash )
     {
-        Array<V> result( arena_, count, params );
-        for( int i = 0; i < tableSize; ++i )
+        u32 index = hash & t.mask;
+        for( u32 dist = 0; ; ++dist )
         {
-            if( table[i].occupied )
+            Slot* slot = t.slots + index;
+            // Anything this far from its ideal slot would have taken our place
+            if( !slot->hash || Distance( slot->hash, index, t.mask ) < dist )
+                return nullptr;
+            // TODO Allow key comparisons different from bit-equality if needed
+            if( slot->hash == hash && slot->key == key )
+                return slot;
+
+            index = (index + 1) & t.mask;
+        }
+    }
+
+    static void InsertIntoTable( Table* t, K key, u32 hash, ValueEntry* entry )
+    {
+        u32 index = hash & t->mask;
+        for( u32 dist = 0; ; ++dist )
+        {
+            Slot* slot = t->slots + index;
+            if( !slot->hash )
             {
-                result.Push( table[i].value );
-                if( table[i].nextInHash )
-                {
-                    Slot* slot = table[i].nextInHash;
-                    while( slot )
-                    {
-                        result.Push( slot->value );
-                        slot = slot->nextInHash;
-                    }
-                }
+                *slot = { key, entry, hash };
+                return;
             }
+
+            // Rob the rich
+            u32 slotDist = Distance( slot->hash, index, t->mask );
+            if( slotDist < dist )
+            {
+                Slot displaced = *slot;
+                *slot = { key, entry, hash };
+                key = displaced.key;
+                entry = displaced.entry;
+                hash = displaced.hash;
+                dist = slotDist;
+            }
+
+            index = (index + 1) & t->mask;
         }
-        return result;
     }
 
-private:
+    static void RemoveFromTable( Table* t, u32 index )
+    {
+        // Shift back all following entries in the same run
+        for( ;; )
+        {
+            u32 next = (index + 1) & t->mask;
+            Slot* nextSlot = t->slots + next;
+            if( !nextSlot->hash || Distance( nextSlot->hash, next, t->mask ) == 0 )
+                break;
+
+            t->slots[index] = *nextSlot;
+            index = next;
+        }
+        t->slots[index].hash = 0;
+    }
 
-    int IndexFromKey( const K& key ) const
+    void Grow()
     {
-        u32 hashValue = H( key, tableSize );
-        // TODO Make tableSize a power of 2 and mask instead
-        int result = I32( hashValue % tableSize );
-        return result;
+        // Finish any previous migration first (only happens with lots of insertions in a row)
+        while( oldTable.slots )
+            MigrateStep();
+
+        // NOTE The old table memory is not reclaimed until the arena is cleared
+        oldTable = table;
+        migrationIndex = 0;
+        table = AllocTable( (table.mask + 1) * 2 );
+
+        MigrateStep();
+    }
+
+    void MigrateStep()
+    {
+        if( !oldTable.slots )
+            return;
+
+        // Removing the entry at migrationIndex may shift the next ones back into it, so only advance once it's empty.
+        // That way no live entries are ever left behind it (removals can only shift entries into later slots)
+        for( int step = 0; step < MigrationStepSize && migrationIndex <= oldTable.mask; ++step )
+        {
+            Slot* slot = oldTable.slots + migrationIndex;
+            if( slot->hash )
+            {
+                InsertIntoTable( &table, slot->key, slot->hash, slot->entry );
+                RemoveFromTable( &oldTable, migrationIndex );
+            }
+            else
+                migrationIndex++;
+        }
+
+        if( migrationIndex > oldTable.mask )
+            oldTable = {};
     }
 };
 
@@ -1416,11 +1906,11 @@ struct LinkedList
     // in more than one LinkedList
     // (need to find a 'clean' way to retrieve the T* from the node pointer, specify Node field as part of the
     // template signature somehow)
-    template <typename T>
+    template <typename U>
     struct Node
     {
-        Node<T>* next;
-        Node<T>* prev;
+        Node<U>* next;
+        Node<U>* prev;
     };
 
     // Dummy value so that the list always has something in it, and we don't have to check
@@ -1532,113 +2022,560 @@ struct Queue
 };
 
 
-/////     CONCURRENT QUEUE     /////
-// TODO Reimplement using ticket-taking
-// (https://hero.handmade.network/episode/code/day325/)
-// TODO Test!
+/////     WORK STEALING DEQUE     /////
+// Lock-free Chase-Lev style deque with a fixed capacity.
+// The owner thread pushes & pops at the bottom (LIFO), while any other thread can steal from the top (FIFO).
+// NOTE Indices grow monotonically and are compared as signed differences, so they can safely wrap around
 
 template <typename T>
-struct ConcurrentQueue
+struct WorkStealingDeque
+{
+    // Owner and thieves operate on opposite ends, so keep them in separate cache lines
+    alignas(64) volatile u32 top;
+    alignas(64) volatile u32 bottom;
+    alignas(64) T* data;
+    u32 capacity;
+
+
+    WorkStealingDeque()
+    {}
+
+    WorkStealingDeque( MemoryArena* arena, u32 capacity_, MemoryParams params = DefaultMemoryParams() )
+    {
+        ASSERT( IsPowerOf2( (u64)capacity_ ) );
+        data = PUSH_ARRAY( arena, T, capacity_, params );
+        capacity = capacity_;
+        top = 0;
+        bottom = 0;
+    }
+
+    // NOTE Only a snapshot when called concurrently
+    i32 Count() const
+    {
+        i32 result = (i32)(bottom - top);
+        return result > 0 ? result : 0;
+    }
+
+    // Owner only
+    bool Push( T const& item )
+    {
+        u32 b = bottom;
+        u32 t = AtomicLoad( &top );
+        if( (i32)(b - t) >= (i32)capacity )
+            return false;
+
+        data[b & (capacity - 1)] = item;
+        // Make sure the item is visible before the new bottom is
+        AtomicExchange( &bottom, b + 1 );
+
+        return true;
+    }
+
+    // Owner only
+    bool Pop( T* item )
+    {
+        u32 b = bottom - 1;
+        // Needs a full barrier, as the store to bottom can't be reordered after the load of top below
+        AtomicExchange( &bottom, b );
+        u32 t = AtomicLoad( &top );
+
+        i32 size = (i32)(b - t);
+        if( size < 0 )
+        {
+            // Was empty
+            bottom = t;
+            return false;
+        }
+
+        *item = data[b & (capacity - 1)];
+        if( size > 0 )
+            return true;
+
+        // This was the last item, so race against any thieves for it
+        bool result = AtomicCompareExchange( &top, t + 1, t ) == t;
+        bottom = t + 1;
+
+        return result;
+    }
+
+    // Any thread. Can fail spuriously when racing against other thieves or the owner
+    bool Steal( T* item )
+    {
+        u32 t = AtomicLoad( &top );
+        u32 b = AtomicLoad( &bottom );
+
+        if( (i32)(b - t) <= 0 )
+            return false;
+
+        *item = data[t & (capacity - 1)];
+        return AtomicCompareExchange( &top, t + 1, t ) == t;
+    }
+};
+
+/////     BOUNDED MPMC QUEUE     /////
+// Lock-free multiple producer / multiple consumer ring with a fixed capacity.
+// Producers and consumers take tickets (positions) by bumping 'head' and 'tail' respectively, and each slot has a
+// sequence number telling whether it's ready to be written (== ticket) or read (== ticket + 1) for the current lap
+// (http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue)
+
+template <typename T>
+struct MPMCQueue
 {
-    Queue<T> queue;
+    struct Slot
+    {
+        volatile u32 sequence;
+        T item;
+    };
+
+    alignas(64) volatile u32 head;
+    alignas(64) volatile u32 tail;
+    alignas(64) Slot* slots;
+    u32 capacity;
+
+
+    MPMCQueue()
+    {}
+
+    MPMCQueue( MemoryArena* arena, u32 capacity_, MemoryParams params = DefaultMemoryParams() )
+    {
+        ASSERT( IsPowerOf2( (u64)capacity_ ) );
+        slots = PUSH_ARRAY( arena, Slot, capacity_, params );
+        capacity = capacity_;
+        head = 0;
+        tail = 0;
+
+        for( u32 i = 0; i < capacity; ++i )
+            slots[i].sequence = i;
+    }
+
+    // NOTE Only a snapshot when called concurrently
+    i32 Count() const
+    {
+        i32 result = (i32)(head - tail);
+        return result > 0 ? result : 0;
+    }
+
+    // Returns false when full
+    bool TryPush( T const& item )
+    {
+        Slot* slot;
+        u32 pos = AtomicLoad( &head );
+
+        while( true )
+        {
+            slot = &slots[pos & (capacity - 1)];
+            i32 diff = (i32)(AtomicLoad( &slot->sequence ) - pos);
+
+            if( diff == 0 )
+            {
+                u32 prevPos = AtomicCompareExchange( &head, pos + 1, pos );
+                if( prevPos == pos )
+                    break;
+                pos = prevPos;
+            }
+            else if( diff < 0 )
+                // Slot still has an item from the previous lap
+                return false;
+            else
+                // Someone else got this ticket
+                pos = AtomicLoad( &head );
+        }
+
+        slot->item = item;
+        // Publish the item (full barrier)
+        AtomicExchange( &slot->sequence, pos + 1 );
+
+        return true;
+    }
+
+    // Returns false when empty
+    bool TryPop( T* item )
+    {
+        Slot* slot;
+        u32 pos = AtomicLoad( &tail );
+
+        while( true )
+        {
+            slot = &slots[pos & (capacity - 1)];
+            i32 diff = (i32)(AtomicLoad( &slot->sequence ) - (pos + 1));
+
+            if( diff == 0 )
+            {
+                u32 prevPos = AtomicCompareExchange( &tail, pos + 1, pos );
+                if( prevPos == pos )
+                    break;
+                pos = prevPos;
+            }
+            else if( diff < 0 )
+                // Nothing written for this lap yet
+                return false;
+            else
+                pos = AtomicLoad( &tail );
+        }
+
+        *item = slot->item;
+        // Hand the slot over to the producer for the next lap
+        AtomicExchange( &slot->sequence, pos + capacity );
+
+        return true;
+    }
+};
+
+/////     TICKET MUTEX     /////
+// Spinning lock that's granted in the same order it was requested, so nobody starves
+// Only meant for really short critical sections
+
+struct TicketMutex
+{
+    volatile u32 ticket;
+    volatile u32 serving;
+};
+
+inline void
+BeginTicketMutex( TicketMutex* mutex )
+{
+    u32 ticket = AtomicAdd( &mutex->ticket, 1u );
+    while( ticket != AtomicLoad( &mutex->serving ) )
+        _mm_pause();
+}
+
+inline void
+EndTicketMutex( TicketMutex* mutex )
+{
+    AtomicAdd( &mutex->serving, 1u );
+}
+
+
+/////     LIGHTWEIGHT SEMAPHORE     /////
+// Counting semaphore that only goes to the OS when a thread actually has to sleep or be woken up
+// (https://preshing.com/20150316/semaphores-are-surprisingly-versatile/)
+// FIXME Use the OS semaphore / futex directly once we get rid of the std stuff
+
+struct LightweightSemaphore
+{
+    // Negative means there's threads waiting
+    volatile u32 count;
 
     std::mutex mutex;
     std::condition_variable condition;
+    i32 pendingWakeups;
 
-    void Push( T* item )
+
+    LightweightSemaphore( i32 initialCount = 0 )
     {
-        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT( initialCount >= 0 );
+        count = (u32)initialCount;
+        pendingWakeups = 0;
+    }
 
-        queue.Push( item );
-        lock.unlock();
+    bool TryWait()
+    {
+        u32 prevCount = AtomicLoad( &count );
+        while( (i32)prevCount > 0 )
+        {
+            u32 actualCount = AtomicCompareExchange( &count, prevCount - 1, prevCount );
+            if( actualCount == prevCount )
+                return true;
+            prevCount = actualCount;
+        }
+        return false;
+    }
+
+    void Wait()
+    {
+        i32 prevCount = (i32)AtomicAdd( &count, (u32)-1 );
+        if( prevCount <= 0 )
+        {
+            std::unique_lock<std::mutex> lock(mutex);
 
-        condition.notify_one();
+            while( pendingWakeups == 0 )
+                condition.wait( lock );
+            pendingWakeups--;
+        }
     }
 
-    bool TryPop( T** destItem )
+    void Signal()
     {
-        std::unique_lock<std::mutex> lock(mutex);
-        
-        if( queue.IsEmpty() )
+        i32 prevCount = (i32)AtomicAdd( &count, 1u );
+        if( prevCount < 0 )
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            pendingWakeups++;
+            lock.unlock();
+
+            condition.notify_one();
+        }
+    }
+};
+
+
+/////     CONCURRENT QUEUE     /////
+// Bounded lock-free MPMC queue, with an optional blocking pop for consumers that have nothing else to do.
+// Producers and consumers take tickets on the underlying MPMCQueue, and the semaphore keeps
+// count of published items, so it's only ever touched by the OS when a consumer needs to sleep.
+
+template <typename T>
+struct ConcurrentQueue
+{
+    MPMCQueue<T> queue;
+    LightweightSemaphore available;
+
+
+    ConcurrentQueue()
+    {}
+
+    ConcurrentQueue( MemoryArena* arena, u32 capacity, MemoryParams params = DefaultMemoryParams() )
+        : queue( arena, capacity, params )
+    {}
+
+    // Returns false when full
+    bool Push( T const& item )
+    {
+        if( !queue.TryPush( item ) )
             return false;
 
-        *destItem = queue.Pop();
+        available.Signal();
         return true;
     }
 
-    T* PopOrBlock()
+    // Returns false when empty
+    bool TryPop( T* item )
     {
-        std::unique_lock<std::mutex> lock(mutex);
-        
-        while( queue.IsEmpty() )
-            condition.wait( lock );
+        if( !available.TryWait() )
+            return false;
 
-        return queue.Pop();
+        PopReserved( item );
+        return true;
     }
 
-    bool IsEmpty()
+    T PopOrBlock()
     {
-        std::unique_lock<std::mutex> lock(mutex);
+        available.Wait();
 
-        return queue.IsEmpty();
+        T result;
+        PopReserved( &result );
+        return result;
     }
-};
 
+    // NOTE Only a snapshot when called concurrently
+    bool IsEmpty()
+    {
+        return (i32)AtomicLoad( &available.count ) <= 0;
+    }
 
+private:
+    void PopReserved( T* item )
+    {
+        // We own one of the published items, but the slot at the tail may still belong to
+        // a producer that took its ticket earlier and hasn't finished writing yet
+        while( !queue.TryPop( item ) )
+            _mm_pause();
+    }
+};
 
 /////     GENERAL RESOURCE HANDLER     /////
-// NOTE Not too sure we want to use so much C++ nonsense,
-// but I want to capture the general idea
-// TODO Test!
+// Handles are runtime references to resources living in some allocator, so they're a glorified pointer.
+// They're 64 bit: 8 bit allocator id, 8 bit flags, 16 bit generation & 32 bit allocator-dependent index.
+// Once a resource is removed its slot's generation is bumped, so lookups through stale handles fail instead of dangling.
+// A zero handle is always invalid (generations start at 1)
+
+#define HANDLE_INDEX_BITS 32
+#define HANDLE_GENERATION_BITS 16
+#define HANDLE_FLAGS_BITS 8
+#define HANDLE_ALLOCATOR_BITS 8
 
-// TODO Would be good to have some kind of type marker so their type can be enforce in function signatures, etc
 template <typename T>
 struct ResourceHandle
 {
-    u32 locator;
+    u64 value;
+
+    u32 Index() const       { return (u32)value; }
+    u16 Generation() const  { return (u16)(value >> HANDLE_INDEX_BITS); }
+    u8 Flags() const        { return (u8)(value >> (HANDLE_INDEX_BITS + HANDLE_GENERATION_BITS)); }
+    u8 Allocator() const    { return (u8)(value >> (HANDLE_INDEX_BITS + HANDLE_GENERATION_BITS + HANDLE_FLAGS_BITS)); }
+
+    bool IsValid() const    { return value != 0; }
+
+    bool operator ==( ResourceHandle<T> const& other ) const { return value == other.value; }
+    bool operator !=( ResourceHandle<T> const& other ) const { return value != other.value; }
 };
 
+template <typename T>
+inline ResourceHandle<T>
+MakeHandle( u8 allocator, u8 flags, u16 generation, u32 index )
+{
+    ResourceHandle<T> result;
+    result.value = ((u64)allocator << (HANDLE_INDEX_BITS + HANDLE_GENERATION_BITS + HANDLE_FLAGS_BITS))
+        | ((u64)flags << (HANDLE_INDEX_BITS + HANDLE_GENERATION_BITS))
+        | ((u64)generation << HANDLE_INDEX_BITS)
+        | (u64)index;
+    return result;
+}
+
+// Fixed capacity pool of resources referenced by handle.
+// Items are kept densely packed so they can be iterated quickly (removing swaps the last item into the hole),
+// and an indirection table of slots (the handle index) maps handles to their current position.
+// Free slots form an intrusive linked list, so both adding and removing are O(1)
 template <typename T>
 struct ResourcePool
 {
-    Array<T> pool;
-    u32 nextFreeItem;
-private:
-    u32 locatorIndexMask;
+    struct Slot
+    {
+        // Position in the dense arrays while in use, next free slot otherwise
+        u32 denseIndexOrNextFree;
+        u16 generation;
+        u8 flags;
+        bool used;
+    };
 
+    T* items;
+    // Slot index for each dense item
+    u32* itemSlots;
+    Slot* slots;
 
-public:
-    ResourcePool( MemoryArena* arena, u32 maxResourceCount )
-        : pool( arena, maxResourceCount )
+    i32 count;
+    i32 capacity;
+    u32 firstFreeSlot;
+    u8 allocatorId;
+
+
+    ResourcePool()
     {
-        locatorIndexMask = NextPowerOf2( maxResourceCount ) - 1;
+        items = nullptr;
+        itemSlots = nullptr;
+        slots = nullptr;
+        count = capacity = 0;
+        firstFreeSlot = 0;
+        allocatorId = 0;
     }
 
-    ResourceHandle<T> Add( const T& item )
+    ResourcePool( MemoryArena* arena, i32 capacity_, u8 allocatorId_ = 0, MemoryParams params = DefaultMemoryParams() )
     {
-        // Generate fingerprint
-        u32 fingerprint = Fletcher32( &item, sizeof(T) );
-        u32 index = FindNextFreeIndex();
-        u32 locator = (fingerprint & ~locatorIndexMask) | (index & locatorIndexMask);
+        ASSERT( capacity_ > 0 );
+        items = PUSH_ARRAY( arena, T, capacity_, params );
+        itemSlots = PUSH_ARRAY( arena, u32, capacity_, params );
+        slots = PUSH_ARRAY( arena, Slot, capacity_, params );
+        count = 0;
+        capacity = capacity_;
+        allocatorId = allocatorId_;
+
+        for( int i = 0; i < capacity; ++i )
+            slots[i] = { (u32)(i + 1), 1, 0, false };
+        firstFreeSlot = 0;
+    }
 
-        // TODO Enforce this somehow in the template?
-        item.locator = locator;
-        pool.Insert( item, index );
+    // Returns an invalid handle if the pool is full
+    ResourceHandle<T> Add( T const& item, u8 flags = 0 )
+    {
+        ResourceHandle<T> result = {};
+
+        if( count < capacity )
+        {
+            u32 slotIndex = firstFreeSlot;
+            Slot& slot = slots[slotIndex];
+            ASSERT( !slot.used );
+            firstFreeSlot = slot.denseIndexOrNextFree;
+
+            slot.denseIndexOrNextFree = (u32)count;
+            slot.flags = flags;
+            slot.used = true;
+
+            items[count] = item;
+            itemSlots[count] = slotIndex;
+            count++;
+
+            result = MakeHandle<T>( allocatorId, flags, slot.generation, slotIndex );
+        }
 
-        ResourceHandle result = { locator };
         return result;
     }
 
-    // NOTE Returned pointer should never be stored or passed around!
+    // Returns whether the handle was still valid
+    bool Remove( ResourceHandle<T> handle )
+    {
+        Slot* slot = FindSlot( handle );
+        if( !slot )
+            return false;
+
+        // Move the last item into the hole
+        u32 denseIndex = slot->denseIndexOrNextFree;
+        u32 lastIndex = (u32)(count - 1);
+        if( denseIndex != lastIndex )
+        {
+            items[denseIndex] = items[lastIndex];
+            itemSlots[denseIndex] = itemSlots[lastIndex];
+            slots[itemSlots[denseIndex]].denseIndexOrNextFree = denseIndex;
+        }
+        count--;
+
+        slot->used = false;
+        slot->generation++;
+        if( slot->generation == 0 )
+            slot->generation = 1;
+        slot->denseIndexOrNextFree = firstFreeSlot;
+        firstFreeSlot = handle.Index();
+
+        return true;
+    }
+
+    // NOTE Returned pointer should never be stored or passed around! (it changes when other items are removed)
+    // Returns null for stale or invalid handles
     T* GetTransientPointer( ResourceHandle<T> handle )
     {
-        u32 index = handle.locator & locatorIndexMask;
-        ASSERT( index < pool.count );
-        T* result = resourceBase + index;
-        // Make sure the high bits are also the same
-        // NOTE Expects a 'locator' field in the resource type
-        ASSERT( handle.locator == result->locator );
-        return result;
+        Slot* slot = FindSlot( handle );
+        return slot ? items + slot->denseIndexOrNextFree : nullptr;
+    }
+
+    bool Contains( ResourceHandle<T> handle ) const
+    {
+        return const_cast<ResourcePool<T>*>(this)->FindSlot( handle ) != nullptr;
+    }
+
+    void Clear()
+    {
+        // Invalidate all outstanding handles
+        for( int i = 0; i < count; ++i )
+        {
+            Slot& slot = slots[itemSlots[i]];
+            slot.used = false;
+            slot.generation++;
+            if( slot.generation == 0 )
+                slot.generation = 1;
+            slot.denseIndexOrNextFree = firstFreeSlot;
+            firstFreeSlot = itemSlots[i];
+        }
+        count = 0;
+    }
+
+    // Dense iteration
+    T& operator[]( int i )
+    {
+        ASSERT( i >= 0 && i < count );
+        return items[i];
+    }
+
+    T const& operator[]( int i ) const
+    {
+        ASSERT( i >= 0 && i < count );
+        return items[i];
+    }
+
+    ResourceHandle<T> HandleAt( int i ) const
+    {
+        ASSERT( i >= 0 && i < count );
+        Slot const& slot = slots[itemSlots[i]];
+        return MakeHandle<T>( allocatorId, slot.flags, slot.generation, itemSlots[i] );
+    }
+
+private:
+    Slot* FindSlot( ResourceHandle<T> handle )
+    {
+        u32 index = handle.Index();
+        if( !handle.IsValid() || handle.Allocator() != allocatorId || index >= (u32)capacity )
+            return nullptr;
+
+        Slot* slot = slots + index;
+        return (slot->used && slot->generation == handle.Generation()) ? slot : nullptr;
     }
 };
 
@@ -90,6 +90,13 @@ LogFrameCounter( DebugCycleCounter* c, DebugCounterLog* log, int snapshotIndex,
 }
 
 
+// Work done finding edge crossings while dual contouring
+struct DCEdgeStats
+{
+    volatile u64 crossingCount;
+    volatile u64 sampleCount;
+};
+
 struct DebugState
 {
     // NOTE Since we use __COUNTER__ for indexing, we'd need a separate array for platform counters
@@ -106,6 +113,17 @@ struct DebugState
     u32 totalGeneratedVerticesCount;
     i32 totalEntities;
     u32 totalMeshCount;
+
+    i32 residentClusterCount;
+    u64 residentClusterBytes;
+    u32 clusterCacheHits;
+    u32 clusterCacheMisses;
+    u32 clusterCacheEvictions;
+
+    DCEdgeStats dcEdgeStats;
+
+    // Indexed by MemoryTag
+    MemoryTagStats memoryStats[MemoryTag::Values::count];
 };
 
 
@@ -103,11 +103,14 @@ TickMeshSamplerTest( EditorState* state, MeshPool* meshPoolArray, MemoryArena* e
         state->tests.resampling.displayedLayer = 172;
 
         if( state->tests.resampling.testIsoSurfaceMesh )
-            ReleaseMesh( &state->tests.resampling.testIsoSurfaceMesh );
+            ReleaseMesh( &state->tests.resampling.testIsoSurfaceMesh, meshPoolArray );
         state->tests.resampling.testIsoSurfaceMesh =
             ConvertToIsoSurfaceMesh( state->tests.resampling.sampledMesh, state->tests.resampling.drawingDistance, state->tests.resampling.displayedLayer,
                                      &state->tests.resampling.samplingCache, meshPoolArray, transientArena, renderCommands );
     }
+    // Mesh heap is full (already logged)
+    if( !state->tests.resampling.testIsoSurfaceMesh )
+        return;
 
     RenderSetShader( ShaderProgramName::FlatShading, renderCommands );
     //PushMesh( state->tests.resampling.sampledMesh, renderCommands );
@@ -124,9 +127,9 @@ internal void
 InitWFCTest( EditorState* state, MemoryArena* editorArena, MemoryArena* transientArena )
 {
     if( !IsInitialized( state->tests.wfc.arena ) )
-        state->tests.wfc.arena = MakeSubArena( editorArena, MEGABYTES(512) );
+        state->tests.wfc.arena = MakeSubArena( editorArena, MEGABYTES(512), Tagged( MemoryTag::WFC() ) );
     if( !IsInitialized( state->tests.wfc.displayArena ) )
-        state->tests.wfc.displayArena = MakeSubArena( editorArena, MEGABYTES(16) );
+        state->tests.wfc.displayArena = MakeSubArena( editorArena, MEGABYTES(16), Tagged( MemoryTag::Editor() ) );
 
     TemporaryMemory tmpMemory = BeginTemporaryMemory( transientArena );
 
@@ -339,14 +342,17 @@ TickSurfaceContouringTest( const GameInput& input, EditorState* state, RenderCom
         {
             case ContouringTechnique::MarchingCubes().index:
             {
-                MarchVolumeFast( { V3Zero, V3iZero }, V3( ClusterSizeMeters ), VoxelSizeMeters, SimpleSurfaceFunc, (SamplingData*)&samplingData,
-                                 &currentSettings.mcSamplingCache, &tmpVertices, &tmpIndices, settings.mcInterpolate );
+                MarchVolumeFast( { V3Zero, V3iZero }, V3( ClusterSizeMeters ), VoxelSizeMeters, SimpleSurfaceBatchFunc, SimpleSurfaceRangeFunc,
+                                 (SamplingData*)&samplingData,
+                                 &currentSettings.mcSamplingCache, &tmpVertices, &tmpIndices, tempArena, settings.mcInterpolate,
+                                 globalPlatform.hiPriorityQueue );
                
             } break;
             case ContouringTechnique::DualContouring().index:
             {
-                DCVolume( { V3Zero, V3iZero }, V3( ClusterSizeMeters ), VoxelSizeMeters, SimpleSurfaceFunc, (SamplingData*)&samplingData,
-                          &tmpVertices, &tmpIndices, editorArena, tempArena, settings.dc );
+                DCVolume( { V3Zero, V3iZero }, V3( ClusterSizeMeters ), VoxelSizeMeters, SimpleSurfaceFunc, SimpleSurfaceBatchFunc,
+                          SimpleSurfaceGradientFunc, SimpleSurfaceRangeFunc, (SamplingData*)&samplingData,
+                          &tmpVertices, &tmpIndices, editorArena, tempArena, settings.dc, globalPlatform.hiPriorityQueue );
 
             } break;
         }
@@ -562,7 +568,7 @@ UpdateAndRenderEditor( const GameInput& input, GameState* gameState, TransientSt
             break;
         case EditorTest::MeshResampling().index:
             // Resampling meshes using marching cubes
-            TickMeshSamplerTest( editorState, &world->meshPools[0], editorArena, transientArena, elapsedT, renderCommands );
+            TickMeshSamplerTest( editorState, &world->workerData[0].meshPool, editorArena, transientArena, elapsedT, renderCommands );
             break;
 #if 0
         case EditorTest::MeshDecimation().index:
@@ -28,6 +28,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
 #include <ctype.h>
 #include <string.h>
 #include <math.h>
@@ -313,6 +315,9 @@ struct GameMemory
     u64 transientStorageSize;
     void *transientStorage;         // NOTE Required to be cleared to zero at startup
 
+    // Only set when the storage above is just reserved, so arenas need to commit pages as they grow
+    VirtualMemoryBacking* storageBacking;
+
 #if !RELEASE
     u64 debugStorageSize;
     void *debugStorage;             // NOTE Required to be cleared to zero at startup
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <intrin.h>
 #else
 #include <x86intrin.h>
+#include <cpuid.h>
 #endif
 
 #if NON_UNITY_BUILD
@@ -168,6 +169,14 @@ Min( u64 a, u64 b )
     return a < b ? a : b;
 }
 
+#if !_WIN32
+INLINE sz
+Min( sz a, sz b )
+{
+    return a < b ? a : b;
+}
+#endif
+
 INLINE i32
 Max( i32 a, i32 b )
 {
@@ -180,6 +189,20 @@ Max( u32 a, u32 b )
     return a > b ? a : b;
 }
 
+INLINE u64
+Max( u64 a, u64 b )
+{
+    return a > b ? a : b;
+}
+
+#if !_WIN32
+INLINE sz
+Max( sz a, sz b )
+{
+    return a > b ? a : b;
+}
+#endif
+
 INLINE f32
 Max( f32 a, f32 b )
 {
@@ -284,6 +307,15 @@ IsPowerOf2( i64 value )
     return value > 0 && (value & (value - 1)) == 0;
 }
 
+#if !_WIN32
+// NOTE size_t is 'unsigned long' on LP64 platforms, a distinct type from u64
+INLINE bool
+IsPowerOf2( sz value )
+{
+    return value > 0 && (value & (value - 1)) == 0;
+}
+#endif
+
 INLINE sz
 Align( sz size, sz alignment )
 {
@@ -313,7 +345,8 @@ NextPowerOf2( u32 value )
         result = 1u << (msbPosition + 1);
     }
 #else
-    u32 leadingZeros = _lzcnt_u32( value );
+    // NOTE Don't require LZCNT support from the target (clz is undefined for 0)
+    u32 leadingZeros = value ? (u32)__builtin_clz( value ) : 32;
     if( leadingZeros < 32 )
     {
         result = 1u << (32 - leadingZeros);
@@ -323,6 +356,34 @@ NextPowerOf2( u32 value )
     return result;
 }
 
+// NOTE Undefined for 0
+INLINE u32
+FindLeastSignificantSetBit( u32 value )
+{
+    ASSERT( value );
+#if _MSC_VER
+    unsigned long result;
+    _BitScanForward( &result, value );
+    return (u32)result;
+#else
+    return (u32)__builtin_ctz( value );
+#endif
+}
+
+// NOTE Undefined for 0
+INLINE u32
+FindMostSignificantSetBit( u64 value )
+{
+    ASSERT( value );
+#if _MSC_VER
+    unsigned long result;
+    _BitScanReverse64( &result, value );
+    return (u32)result;
+#else
+    return 63u - (u32)__builtin_clzll( value );
+#endif
+}
+
 // TODO Rewrite this stuff enforcing sizes with templates
 INLINE u32
 AtomicCompareExchange( volatile u32* value, u32 newValue, u32 expectedValue )
@@ -339,6 +400,20 @@ AtomicCompareExchange( volatile u32* value, u32 newValue, u32 expectedValue )
     return previousValue;
 }
 
+INLINE u64
+AtomicCompareExchange( volatile u64* value, u64 newValue, u64 expectedValue )
+{
+    u64 previousValue = 0;
+#if _MSC_VER
+    previousValue = (u64)_InterlockedCompareExchange64( (volatile i64*)value, (i64)newValue, (i64)expectedValue );
+#else
+    __atomic_compare_exchange_n( value, &expectedValue, newValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+    previousValue = expectedValue;
+#endif
+
+    return previousValue;
+}
+
 INLINE u32
 AtomicExchange( volatile u32* value, u32 newValue )
 {
@@ -436,8 +511,13 @@ INLINE u64
 ReadCycles()
 {
     // Flush the pipeline
+#if _MSC_VER
     int cpuInfo[4];
     __cpuid( cpuInfo, 0 );
+#else
+    u32 eax, ebx, ecx, edx;
+    __cpuid( 0, eax, ebx, ecx, edx );
+#endif
     return __rdtsc();
 }
 
@@ -0,0 +1,1029 @@
+/*
+The MIT License
+
+Copyright (c) 2017 Oscar Peñas Pariente <oscarpp80@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// NOTE This is a headless platform layer intended for batch (offline) runs of the world generation
+// and WFC systems on POSIX machines. There's no window, input, audio or GL context, so the game code
+// is compiled right into the executable instead of being hot-reloaded from a shared library.
+#include "robotrider.cpp"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "linux_platform.h"
+
+
+internal LinuxState globalPlatformState;
+
+
+
+DEBUG_PLATFORM_JOIN_PATHS(LinuxJoinPaths)
+{
+    char buffer[PLATFORM_PATH_MAX] = {};
+
+    sz len = Min( strlen( root ), (sz)PLATFORM_PATH_MAX );
+    strncpy( buffer, root, len );
+
+    // Add separator if root path is not empty and there's none at either of the two
+    if( len > 0 && len < PLATFORM_PATH_MAX )
+    {
+        if( path[0] != '/' && buffer[len-1] != '/' )
+        {
+            buffer[len++] = '/';
+        }
+    }
+
+    len = PLATFORM_PATH_MAX - len;
+    strncat( buffer, path, len );
+    
+    // NOTE realpath fails for paths that don't exist yet, so just return the joined path in that case
+    if( !canonicalize || !realpath( buffer, destination ) )
+        strncpy( destination, buffer, PLATFORM_PATH_MAX );
+
+    return strlen( destination );
+}
+
+internal const char*
+FindFilename( const char* path )
+{
+    const char *onePastLastSlash = path;
+    for( const char *scanChar = path; *scanChar; ++scanChar )
+    {
+        if( *scanChar == '/' )
+        {
+            onePastLastSlash = scanChar + 1;
+        }
+    }
+
+    return onePastLastSlash;
+}
+
+DEBUG_PLATFORM_GET_PARENT_PATH(LinuxGetParentPath)
+{
+    const char *pathSeparator = FindFilename( path );
+    if( pathSeparator != path )
+        --pathSeparator;
+
+    sz len = Sz( pathSeparator - path );
+    if( destination != path )
+        strncpy( destination, path, len );
+
+    destination[len] = 0;
+}
+
+inline bool
+LinuxPathIsRelative( const char* path )
+{
+    return path[0] != '/';
+}
+
+inline bool
+LinuxPathExists( const char* path )
+{
+    struct stat info;
+    return stat( path, &info ) == 0;
+}
+
+
+internal bool
+AcceptAssetFileData( const dirent* entry )
+{
+    bool result = true;
+    String filename( (char*)entry->d_name );
+
+    if( filename.IsEqual( "." ) || filename.IsEqual( ".." ) )
+        result = false;
+
+    return result;
+}
+
+DEBUG_PLATFORM_LIST_ALL_ASSETS(LinuxListAllAssets)
+{
+    DEBUGFileInfoList result = {};
+
+    char joinedPath[PLATFORM_PATH_MAX] = {};
+    LinuxJoinPaths( globalPlatformState.dataFolderPath, relativeRootPath, joinedPath, true );
+
+    DIR* dir = opendir( joinedPath );
+    if( dir )
+    {
+        while( dirent* entry = readdir( dir ) )
+        {
+            if( AcceptAssetFileData( entry ) )
+                ++result.entryCount;
+        }
+
+        result.files = PUSH_ARRAY( arena, DEBUGFileInfo, result.entryCount );
+
+        rewinddir( dir );
+        u32 i = 0;
+        while( dirent* entry = readdir( dir ) )
+        {
+            if( i < result.entryCount && AcceptAssetFileData( entry ) )
+            {
+                DEBUGFileInfo* info = result.files + i++;
+                *info = {};
+                LinuxJoinPaths( joinedPath, entry->d_name, info->fullPath, false );
+                info->name = FindFilename( info->fullPath );
+
+                struct stat fileStat;
+                if( stat( info->fullPath, &fileStat ) == 0 )
+                {
+                    info->size = (sz)fileStat.st_size;
+                    info->lastUpdated = (u64)fileStat.st_mtime;
+                    info->isFolder = S_ISDIR( fileStat.st_mode );
+                }
+            }
+        }
+        // In case something was deleted in between the two passes
+        result.entryCount = i;
+
+        closedir( dir );
+    }
+
+    return result;
+}
+
+DEBUG_PLATFORM_FREE_FILE_MEMORY(DEBUGLinuxFreeFileMemory)
+{
+    if( memory )
+    {
+        free( memory );
+    }
+}
+
+DEBUG_PLATFORM_READ_ENTIRE_FILE(DEBUGLinuxReadEntireFile)
+{
+    DEBUGReadFileResult result = {};
+
+    char absolutePath[PLATFORM_PATH_MAX];
+    if( LinuxPathIsRelative( filename ) )
+    {
+        // If path is relative, use data location to complete it
+        LinuxJoinPaths( globalPlatformState.dataFolderPath, filename, absolutePath, true );
+        filename = absolutePath;
+    }
+
+    FILE* file = fopen( filename, "rb" );
+    if( file )
+    {
+        struct stat fileStat;
+        if( fstat( fileno( file ), &fileStat ) == 0 )
+        {
+            u32 fileSize32 = U32( (u64)fileStat.st_size );
+            result.contents = malloc( fileSize32 + 1 );
+
+            if( result.contents )
+            {
+                sz bytesRead = fread( result.contents, 1, fileSize32, file );
+                if( bytesRead == fileSize32 )
+                {
+                    // Null-terminate to help when handling text files
+                    *((u8 *)result.contents + fileSize32) = '\0';
+                    result.contentSize = I32( fileSize32 + 1 );
+                }
+                else
+                {
+                    LOG( "ERROR: fread failed for '%s'", filename );
+                    DEBUGLinuxFreeFileMemory( result.contents );
+                    result.contents = 0;
+                }
+            }
+            else
+            {
+                LOG( "ERROR: Couldn't allocate buffer for file contents" );
+            }
+        }
+        else
+        {
+            LOG( "ERROR: Failed querying file size for '%s'", filename );
+        }
+
+        fclose( file );
+    }
+    else
+    {
+        LOG( "ERROR: Failed opening file '%s' for reading", filename );
+    }
+
+    return result;
+}
+
+DEBUG_PLATFORM_WRITE_ENTIRE_FILE(DEBUGLinuxWriteEntireFile)
+{
+    bool result = false;
+
+    char absolutePath[PLATFORM_PATH_MAX];
+    if( LinuxPathIsRelative( filename ) )
+    {
+        // If path is relative, use data location to complete it
+        LinuxJoinPaths( globalPlatformState.dataFolderPath, filename, absolutePath, true );
+        filename = absolutePath;
+    }
+
+    FILE* file = fopen( filename, "wb" );
+    if( file )
+    {
+        sz bytesWritten = fwrite( memory, 1, memorySize, file );
+        result = (bytesWritten == memorySize);
+        if( !result )
+        {
+            LOG( "ERROR: fwrite failed" );
+        }
+
+        fclose( file );
+    }
+    else
+    {
+        LOG( "ERROR: Failed opening file for writing" );
+    }
+
+    return result;
+}
+
+PLATFORM_LOG(LinuxLog)
+{
+    char buffer[1024];
+
+    va_list args;
+    va_start( args, fmt );
+    vsnprintf( buffer, ARRAYCOUNT(buffer), fmt, args );
+    va_end( args );
+
+    printf( "%s\n", buffer );
+}
+
+DEBUG_PLATFORM_CURRENT_TIME_MILLIS(LinuxCurrentTimeMillis)
+{
+    timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    f64 result = (f64)now.tv_sec * 1000.0 + (f64)now.tv_nsec / 1000000.0;
+    return result;
+}
+
+
+// Reserves address space only. Pages need to be committed before they can be touched
+internal void*
+LinuxReserveMemory( sz size, bool hugePages )
+{
+    void* result = mmap( 0, size, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0 );
+    if( result == MAP_FAILED )
+        return nullptr;
+
+    // NOTE Just a hint, only effective when transparent huge pages are set to 'madvise' or 'always'
+    if( hugePages )
+        madvise( result, size, MADV_HUGEPAGE );
+
+    return result;
+}
+
+internal
+VIRTUAL_MEMORY_COMMIT(LinuxCommitMemory)
+{
+    sz pageSize = globalPlatformState.pageSize;
+    u8* start = (u8*)((sz)address & ~(pageSize - 1));
+    u8* end = (u8*)Align( (u8*)address + size, pageSize );
+
+    // NOTE Pages are still only backed by physical memory once touched
+    bool result = mprotect( start, Sz( end - start ), PROT_READ|PROT_WRITE ) == 0;
+    return result;
+}
+
+internal
+VIRTUAL_MEMORY_DECOMMIT(LinuxDecommitMemory)
+{
+    sz pageSize = globalPlatformState.pageSize;
+    u8* start = (u8*)Align( address, pageSize );
+    u8* end = (u8*)(((sz)address + size) & ~(pageSize - 1));
+
+    if( end > start )
+    {
+        // Give the physical pages back, then make sure nobody touches them again before committing
+        madvise( start, Sz( end - start ), MADV_DONTNEED );
+        mprotect( start, Sz( end - start ), PROT_NONE );
+    }
+}
+
+
+#define MAIN_THREAD_WORKER_INDEX 0
+#define EXTERNAL_THREAD_WORKER_INDEX -1
+
+// Index of the worker the current thread runs as (used to find its own deque when adding jobs)
+// Threads not belonging to the pool don't have a deque, and can only add jobs through the shared queue
+internal thread_local i32 globalWorkerThreadIndex = EXTERNAL_THREAD_WORKER_INDEX;
+
+internal bool
+LinuxStealJob( PlatformJobQueue* queue, int workerThreadIndex, PlatformJobQueueJob* job )
+{
+    // Start at a pseudo-random victim so thieves don't all convoy on the same deque
+    int victimCount = queue->workerCount;
+    int startIndex = (int)(Rdtsc() % (u64)victimCount);
+
+    for( int i = 0; i < victimCount; ++i )
+    {
+        int victimIndex = (startIndex + i) % victimCount;
+        if( victimIndex != workerThreadIndex && queue->workerQueues[victimIndex].Steal( job ) )
+            return true;
+    }
+
+    return false;
+}
+
+internal void LinuxPushJob( PlatformJobQueue* queue, PlatformJobQueueJob const& job );
+internal void LinuxWakeWorkers( PlatformJobQueue* queue, i32 jobCount );
+
+internal void
+LinuxFinishGroupJob( PlatformJobGroup* group )
+{
+    // NOTE Copy continuations before decrementing, as the group can go away as soon as its count reaches zero
+    PlatformJobContinuation continuations[PLATFORM_MAX_JOB_CONTINUATIONS];
+    u32 continuationCount = group->continuationCount;
+    for( u32 i = 0; i < continuationCount; ++i )
+        continuations[i] = group->continuations[i];
+
+    // Last one out launches all continuations
+    if( AtomicAdd( &group->pendingCount, (u32)-1 ) == 1 )
+    {
+        for( u32 i = 0; i < continuationCount; ++i )
+        {
+            PlatformJobContinuation const& c = continuations[i];
+            // NOTE Already accounted for in the queue's completionTarget when the continuation was added
+            LinuxPushJob( c.queue, { c.callback, c.userData, c.group } );
+            LinuxWakeWorkers( c.queue, 1 );
+        }
+    }
+}
+
+internal bool
+LinuxDoNextQueuedJob( PlatformJobQueue* queue, int workerThreadIndex )
+{
+    PlatformJobQueueJob job;
+
+    bool workAvailable = queue->workerQueues[workerThreadIndex].Pop( &job )
+        || queue->sharedQueue.TryPop( &job )
+        || LinuxStealJob( queue, workerThreadIndex, &job );
+
+    if( workAvailable )
+    {
+        // Whatever the job allocates from its worker's arena is gone as soon as it finishes
+        LinuxWorkerMemory* workerMemory = &queue->pool->workerMemory[workerThreadIndex];
+        TemporaryMemory jobMemory = BeginTemporaryMemory( &workerMemory->arena );
+        // NOTE Jobs can run other jobs while they wait, so restore the outer job's start time afterwards
+        f64 outerJobStartMillis = workerMemory->jobStartMillis;
+        workerMemory->jobStartMillis = LinuxCurrentTimeMillis();
+
+        job.callback( job.userData, workerThreadIndex );
+
+        workerMemory->jobStartMillis = outerJobStartMillis;
+        EndTemporaryMemory( jobMemory );
+
+        if( job.group )
+            LinuxFinishGroupJob( job.group );
+        AtomicAdd( &queue->completionCount, 1 );
+    }
+
+    return workAvailable;
+}
+
+internal bool
+LinuxDoNextPoolJob( LinuxWorkerPool* pool, int workerThreadIndex )
+{
+    for( int i = 0; i < pool->queueCount; ++i )
+    {
+        if( LinuxDoNextQueuedJob( pool->queues[i], workerThreadIndex ) )
+            return true;
+    }
+
+    return false;
+}
+
+internal void*
+LinuxWorkerThreadProc( void* param )
+{
+    LinuxWorkerThreadContext* context = (LinuxWorkerThreadContext*)param;
+    LinuxWorkerPool* pool = context->pool;
+    globalWorkerThreadIndex = context->threadIndex;
+
+    while( true )
+    {
+        if( !LinuxDoNextPoolJob( pool, context->threadIndex ) )
+        {
+            // Announce we're going to sleep and check again, so we can't miss jobs added in between
+            AtomicAdd( &pool->sleepingWorkerCount, 1 );
+            if( !LinuxDoNextPoolJob( pool, context->threadIndex ) )
+                sem_wait( &pool->semaphore );
+            AtomicAdd( &pool->sleepingWorkerCount, (u32)-1 );
+        }
+    }
+
+    return nullptr;
+}
+
+internal void
+LinuxInitJobQueue( PlatformJobQueue* queue, LinuxWorkerPool* pool, int threadCount )
+{
+    *queue = {};
+
+    // Any one thread must be able to have all jobs in flight
+    u32 dequeCapacity = NextPowerOf2( PLATFORM_MAX_JOBQUEUE_JOBS );
+    sz dequeSize = sizeof(WorkStealingDeque<PlatformJobQueueJob>) + dequeCapacity * sizeof(PlatformJobQueueJob);
+    sz sharedQueueSize = sizeof(MPMCQueue<PlatformJobQueueJob>::Slot) * PLATFORM_SHARED_JOBQUEUE_JOBS;
+    sz memorySize = threadCount * dequeSize + sharedQueueSize + 64;
+
+    void* memory = mmap( 0, memorySize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0 );
+    ASSERT( memory != MAP_FAILED );
+    MemoryArena dequeArena;
+    InitArena( &dequeArena, (u8*)memory, memorySize );
+
+    queue->workerQueues = PUSH_ARRAY( &dequeArena, WorkStealingDeque<PlatformJobQueueJob>, threadCount, Aligned( 64 ) );
+    queue->workerCount = threadCount;
+    queue->pool = pool;
+    INIT( &queue->sharedQueue ) MPMCQueue<PlatformJobQueueJob>( &dequeArena, PLATFORM_SHARED_JOBQUEUE_JOBS, NoClear() );
+
+    for( int i = 0; i < threadCount; ++i )
+        INIT( &queue->workerQueues[i] ) WorkStealingDeque<PlatformJobQueueJob>( &dequeArena, dequeCapacity, NoClear() );
+
+    // Queues are added in order of decreasing priority
+    ASSERT( pool->queueCount < ARRAYCOUNT(pool->queues) );
+    pool->queues[pool->queueCount++] = queue;
+}
+
+// NOTE Call after all queues have been initialized
+internal void
+LinuxInitWorkerPool( LinuxWorkerPool* pool, LinuxWorkerThreadContext* threadContexts, int threadCount,
+                     VirtualMemoryBacking* arenaBacking, bool hugePages )
+{
+    sem_init( &pool->semaphore, 0, 0 );
+
+    sz memorySize = threadCount * sizeof(LinuxWorkerMemory) + 64;
+    void* memory = mmap( 0, memorySize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0 );
+    ASSERT( memory != MAP_FAILED );
+    MemoryArena poolArena;
+    InitArena( &poolArena, (u8*)memory, memorySize );
+
+    pool->workerMemory = PUSH_ARRAY( &poolArena, LinuxWorkerMemory, threadCount, Aligned( 64 ) );
+    pool->workerCount = threadCount;
+    pool->yieldBudgetMillis = PLATFORM_DEFAULT_YIELD_BUDGET_MILLIS;
+
+    // Worker arenas only commit what they actually use (and give it back after big jobs)
+    u8* arenasBase = (u8*)LinuxReserveMemory( threadCount * PLATFORM_WORKER_ARENA_SIZE, hugePages );
+    ASSERT( arenasBase );
+
+    for( int i = 0; i < threadCount; ++i )
+    {
+        InitArena( &pool->workerMemory[i].arena, arenasBase + i * PLATFORM_WORKER_ARENA_SIZE, PLATFORM_WORKER_ARENA_SIZE,
+                   arenaBacking );
+        SetArenaTag( &pool->workerMemory[i].arena, MemoryTag::Jobs() );
+        threadContexts[i] = { i, pool };
+
+        // Worker thread index 0 is reserved for the main thread!
+        if( i > MAIN_THREAD_WORKER_INDEX )
+        {
+            pthread_attr_t attr;
+            pthread_attr_init( &attr );
+            pthread_attr_setstacksize( &attr, MEGABYTES(1) );
+            pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+
+            pthread_t thread;
+            int ret = pthread_create( &thread, &attr, LinuxWorkerThreadProc, &threadContexts[i] );
+            ASSERT( ret == 0 );
+
+            pthread_attr_destroy( &attr );
+        }
+    }
+}
+
+internal void
+LinuxWakeWorkers( PlatformJobQueue* queue, i32 jobCount )
+{
+    // NOTE The atomic add on completionTarget before calling this acts as a full barrier, so we either see
+    // a sleeping worker here, or that worker will see the new jobs when it checks again before sleeping
+    LinuxWorkerPool* pool = queue->pool;
+    i32 sleepingCount = (i32)AtomicLoad( &pool->sleepingWorkerCount );
+    i32 wakeCount = Min( jobCount, sleepingCount );
+
+    for( int i = 0; i < wakeCount; ++i )
+        sem_post( &pool->semaphore );
+}
+
+internal void
+LinuxPushJob( PlatformJobQueue* queue, PlatformJobQueueJob const& job )
+{
+    i32 workerThreadIndex = globalWorkerThreadIndex;
+    bool isPoolThread = workerThreadIndex != EXTERNAL_THREAD_WORKER_INDEX && workerThreadIndex < queue->workerCount;
+
+    while( true )
+    {
+        if( isPoolThread && queue->workerQueues[workerThreadIndex].Push( job ) )
+            break;
+        if( queue->sharedQueue.TryPush( job ) )
+            break;
+
+        // Back-pressure: everything is full, so help drain the queue (or just wait if we can't run jobs) until there's room
+        if( !isPoolThread || !LinuxDoNextQueuedJob( queue, workerThreadIndex ) )
+            _mm_pause();
+    }
+}
+
+internal
+PLATFORM_ADD_NEW_JOB(LinuxAddNewJob)
+{
+    LinuxPushJob( queue, { callback, userData, nullptr } );
+
+    AtomicAdd( &queue->completionTarget, 1 );
+    LinuxWakeWorkers( queue, 1 );
+}
+
+internal
+PLATFORM_ADD_GROUP_JOB(LinuxAddGroupJob)
+{
+    if( group )
+        AtomicAdd( &group->pendingCount, 1 );
+    LinuxPushJob( queue, { callback, userData, group } );
+
+    AtomicAdd( &queue->completionTarget, 1 );
+    LinuxWakeWorkers( queue, 1 );
+}
+
+internal
+PLATFORM_ADD_NEW_JOBS(LinuxAddNewJobs)
+{
+    if( group )
+        AtomicAdd( &group->pendingCount, (u32)jobCount );
+
+    u8* userData = (u8*)userDataArray;
+    for( int i = 0; i < jobCount; ++i )
+    {
+        LinuxPushJob( queue, { callback, userData, group } );
+        userData += userDataStride;
+    }
+
+    AtomicAdd( &queue->completionTarget, (u32)jobCount );
+    LinuxWakeWorkers( queue, jobCount );
+}
+
+internal
+PLATFORM_ADD_CONTINUATION(LinuxAddContinuation)
+{
+    ASSERT( dependency->continuationCount < PLATFORM_MAX_JOB_CONTINUATIONS );
+    dependency->continuations[dependency->continuationCount++] = { queue, callback, userData, group };
+
+    // Account for the job right away, so waiting on either group (or the whole queue) includes it
+    if( group )
+        AtomicAdd( &group->pendingCount, 1 );
+    AtomicAdd( &queue->completionTarget, 1 );
+}
+
+internal
+PLATFORM_WAIT_FOR_JOB_GROUP(LinuxWaitForJobGroup)
+{
+    i32 workerThreadIndex = globalWorkerThreadIndex;
+    bool isPoolThread = workerThreadIndex != EXTERNAL_THREAD_WORKER_INDEX && workerThreadIndex < queue->workerCount;
+
+    while( !IsDone( group ) )
+    {
+        if( !isPoolThread || !LinuxDoNextQueuedJob( queue, workerThreadIndex ) )
+            _mm_pause();
+    }
+}
+
+internal bool
+LinuxHasQueuedJobs( PlatformJobQueue* queue )
+{
+    if( queue->sharedQueue.Count() > 0 )
+        return true;
+
+    for( int i = 0; i < queue->workerCount; ++i )
+    {
+        if( queue->workerQueues[i].Count() > 0 )
+            return true;
+    }
+
+    return false;
+}
+
+internal
+PLATFORM_SHOULD_YIELD(LinuxShouldYield)
+{
+    // Yield whenever there's work waiting to be picked up in any queue with a higher priority
+    LinuxWorkerPool* pool = queue->pool;
+    bool isLowerPriority = false;
+    for( int i = 0; i < pool->queueCount && pool->queues[i] != queue; ++i )
+    {
+        if( LinuxHasQueuedJobs( pool->queues[i] ) )
+            return true;
+        isLowerPriority = true;
+    }
+
+    // .. or once the job has used up its slice of the frame, so it doesn't hog the worker for too long
+    i32 workerThreadIndex = globalWorkerThreadIndex;
+    if( isLowerPriority && workerThreadIndex != EXTERNAL_THREAD_WORKER_INDEX && workerThreadIndex < pool->workerCount )
+    {
+        f64 elapsedMillis = LinuxCurrentTimeMillis() - pool->workerMemory[workerThreadIndex].jobStartMillis;
+        if( elapsedMillis > pool->yieldBudgetMillis )
+            return true;
+    }
+
+    return false;
+}
+
+internal
+PLATFORM_GET_WORKER_ARENA(LinuxGetWorkerArena)
+{
+    LinuxWorkerPool* pool = &globalPlatformState.workerPool;
+    ASSERT( workerThreadIndex >= 0 && workerThreadIndex < pool->workerCount );
+
+    return &pool->workerMemory[workerThreadIndex].arena;
+}
+
+internal
+PLATFORM_COMPLETE_ALL_JOBS(LinuxCompleteAllJobs)
+{
+    // NOTE Counters are never reset, so other threads can keep adding jobs while we wait
+    while( (i32)(AtomicLoad( &queue->completionTarget ) - AtomicLoad( &queue->completionCount )) > 0 )
+    {
+        LinuxDoNextQueuedJob( queue, MAIN_THREAD_WORKER_INDEX );
+    }
+}
+
+
+// NOTE There's no renderer, so just hand out unique dummy handles so the game can tell textures apart
+internal
+PLATFORM_ALLOCATE_OR_UPDATE_TEXTURE(LinuxAllocateTexture)
+{
+    persistent volatile u64 nextTextureHandle = 1;
+
+    void* result = optionalHandle;
+    if( !result )
+        result = (void*)AtomicAdd( &nextTextureHandle, 1 );
+
+    return result;
+}
+
+internal
+PLATFORM_DEALLOCATE_TEXTURE(LinuxDeallocateTexture)
+{
+}
+
+
+internal void
+LinuxResolvePaths( LinuxState* state )
+{
+    if( getcwd( state->currentDirectory, ARRAYCOUNT(state->currentDirectory) ) )
+        LOG( state->currentDirectory );
+
+    ssize_t pathLen = readlink( "/proc/self/exe", state->exeFilePath, ARRAYCOUNT(state->exeFilePath) - 1 );
+    if( pathLen > 0 )
+        state->exeFilePath[pathLen] = 0;
+    LinuxGetParentPath( state->exeFilePath, state->binFolderPath );
+
+    {
+        bool result = false;
+
+        const char* supportedDataPaths[] =
+        {
+            "data",
+            "../data",
+        };
+
+        for( int i = 0; i < ARRAYCOUNT( supportedDataPaths ); ++i )
+        {
+            LinuxJoinPaths( state->binFolderPath, supportedDataPaths[i], state->dataFolderPath, true );
+            if( LinuxPathExists( state->dataFolderPath ) )
+            {
+                result = true;
+                break;
+            }
+        }
+
+        ASSERT( result );
+        if( !result )
+            LOG( ".FATAL: Could not find data folder!" );
+    }
+}
+
+internal LinuxBatchArgs
+LinuxParseArgs( int argC, char** argV, int coreCount )
+{
+    LinuxBatchArgs result = {};
+    result.threadCount = coreCount;
+    result.clusterCount = 8;
+    result.wfcSpecIndex = -1;
+    result.wfcTimeoutSeconds = 60.0;
+
+    for( int i = 1; i < argC; ++i )
+    {
+        String arg( argV[i] );
+        bool hasValue = i + 1 < argC;
+
+        if( arg.IsEqual( "-threads" ) && hasValue )
+            result.threadCount = atoi( argV[++i] );
+        else if( arg.IsEqual( "-clusters" ) && hasValue )
+            result.clusterCount = atoi( argV[++i] );
+        else if( arg.IsEqual( "-wfc" ) && hasValue )
+            result.wfcSpecIndex = atoi( argV[++i] );
+        else if( arg.IsEqual( "-wfctimeout" ) && hasValue )
+            result.wfcTimeoutSeconds = atof( argV[++i] );
+        else if( arg.IsEqual( "-clusterbudget" ) && hasValue )
+            result.clusterBudgetMB = atoi( argV[++i] );
+        else if( arg.IsEqual( "-hugepages" ) )
+            result.hugePages = true;
+        else
+        {
+            LOG( "Usage: %s [-threads N] [-clusters N] [-wfc specIndex] [-wfctimeout seconds] [-clusterbudget MB] [-hugepages]", argV[0] );
+            exit( 1 );
+        }
+    }
+
+    Clamp( &result.threadCount, 1, 32 );
+    return result;
+}
+
+internal void
+LinuxLogCounterTotals( GameMemory* gameMemory )
+{
+#if !RELEASE
+    DebugState* debugState = (DebugState*)gameMemory->debugStorage;
+
+    for( int i = 0; i < debugState->counterLogsCount; ++i )
+    {
+        DebugCounterLog const& log = debugState->counterLogs[i];
+        if( log.name && log.computeTotals && log.totalHits )
+        {
+            f64 totalMillis = log.totalCycles / debugState->avgCyclesPerMillisecond;
+            LOG( "    %-32s %8u hits  %12.3f ms total  %10.3f ms avg", log.name, log.totalHits,
+                 totalMillis, totalMillis / log.totalHits );
+        }
+    }
+#endif
+}
+
+internal void
+LinuxLogMemoryStats( GameMemory* gameMemory )
+{
+#if !RELEASE
+    DebugState* debugState = (DebugState*)gameMemory->debugStorage;
+
+    for( int t = 0; t < MemoryTag::Values::count; ++t )
+    {
+        MemoryTagStats const& stats = debugState->memoryStats[t];
+        if( stats.allocationCount )
+            LOG( "    %-16s %10.3f MB live  %10.3f MB peak  %10llu allocations", MemoryTag::Values::names[t],
+                 (f64)stats.liveBytes / MEGABYTES(1), (f64)stats.peakBytes / MEGABYTES(1), (u64)stats.allocationCount );
+    }
+#endif
+}
+
+internal void
+LinuxRunWorldGeneration( GameMemory* gameMemory, GameState* gameState, LinuxBatchArgs const& args )
+{
+    World* world = gameState->world;
+    GameInput input = {};
+
+    LOG( "Generating %d clusters..", args.clusterCount );
+
+    f64 totalMillis = 0;
+    for( int i = 0; i < args.clusterCount; ++i )
+    {
+        TemporaryMemory frameMemory = BeginTemporaryMemory( &gameState->transientArena );
+
+        u64 startCycles = Rdtsc();
+        f64 startMillis = LinuxCurrentTimeMillis();
+
+        // Move the origin one cluster at a time so every update needs to generate new ones
+        world->originClusterP = V3i( i, 0, 0 );
+        UpdateWorldGeneration( &input, world, &gameState->worldArena, &gameState->transientArena );
+        globalPlatform.CompleteAllJobs( globalPlatform.hiPriorityQueue );
+        // Collect the generated clusters now, instead of waiting for the next update
+        UpdateClusterCache( world );
+
+        f64 elapsedMillis = LinuxCurrentTimeMillis() - startMillis;
+        totalMillis += elapsedMillis;
+
+        Cluster* cluster = world->clusterTable.Find( world->originClusterP );
+        i32 meshCount = cluster ? cluster->meshStore.count : 0;
+        i32 vertexCount = 0;
+        for( int m = 0; m < meshCount; ++m )
+            vertexCount += cluster->meshStore[m]->vertices.count;
+
+        LOG( "Cluster %d: %d rooms, %d halls, %d meshes, %d vertices in %.3f ms",
+             i, cluster ? cluster->rooms.count : 0, cluster ? cluster->halls.count : 0, meshCount, vertexCount, elapsedMillis );
+
+#if !RELEASE
+        DebugFrameInfo frameInfo = {};
+        frameInfo.totalFrameCycles = Rdtsc() - startCycles;
+        frameInfo.totalFrameSeconds = (f32)(elapsedMillis / 1000.0);
+        DebugGameFrameEnd( frameInfo, gameMemory );
+#endif
+
+        EndTemporaryMemory( frameMemory );
+    }
+
+    LOG( "Generated %d clusters in %.3f ms (%.3f ms/cluster, %.2f clusters/s)", args.clusterCount, totalMillis,
+         totalMillis / args.clusterCount, args.clusterCount * 1000.0 / totalMillis );
+    LinuxLogCounterTotals( gameMemory );
+    LOG( "World arena: %llu MB used, %llu MB committed", (u64)gameState->worldArena.used / MEGABYTES(1),
+         (u64)gameState->worldArena.committed / MEGABYTES(1) );
+    LinuxLogMemoryStats( gameMemory );
+
+    ClusterCache const& cache = world->clusterCache;
+    LOG( "Cluster cache: %d resident (%.3f MB of %.3f MB), %u hits, %u misses, %u evictions", cache.residentCount,
+         (f64)cache.residentBytes / MEGABYTES(1), (f64)cache.budgetBytes / MEGABYTES(1), cache.hitCount, cache.missCount,
+         cache.evictionCount );
+
+#if !RELEASE
+    DCEdgeStats const& edgeStats = ((DebugState*)gameMemory->debugStorage)->dcEdgeStats;
+    LOG( "DC edges: %llu crossings found with %llu samples (%.2f samples per crossing)", (u64)edgeStats.crossingCount,
+         (u64)edgeStats.sampleCount, edgeStats.crossingCount ? (f64)edgeStats.sampleCount / edgeStats.crossingCount : 0.0 );
+#endif
+}
+
+internal void
+LinuxRunWFC( GameState* gameState, LinuxBatchArgs const& args )
+{
+    TemporaryMemory tmpMemory = BeginTemporaryMemory( &gameState->transientArena );
+    Array<WFC::Spec> specs = LoadWFCVars( "wfc.vars", &gameState->worldArena, tmpMemory );
+    EndTemporaryMemory( tmpMemory );
+
+    if( args.wfcSpecIndex >= specs.count )
+    {
+        LOG( "ERROR: Invalid WFC spec index %d (%d specs available)", args.wfcSpecIndex, specs.count );
+        return;
+    }
+
+    WFC::Spec const& spec = specs[args.wfcSpecIndex];
+    MemoryArena wfcArena = MakeSubArena( &gameState->worldArena, MEGABYTES(512), Tagged( MemoryTag::WFC() ) );
+
+    LOG( "Running WFC spec '%s'..", spec.name );
+    f64 startMillis = LinuxCurrentTimeMillis();
+    f64 timeoutMillis = args.wfcTimeoutSeconds * 1000.0;
+
+    WFC::GlobalState* globalState = WFC::StartWFCAsync( spec, { 0, 0 }, &wfcArena );
+    while( !globalState->done )
+    {
+        WFC::UpdateWFCAsync( globalState );
+
+        if( globalState->processedChunkCount == globalState->outputChunks.Count() )
+            break;
+        if( !globalState->cancellationRequested && LinuxCurrentTimeMillis() - startMillis > timeoutMillis )
+        {
+            LOG( "WFC timed out. Cancelling.." );
+            globalState->cancellationRequested = true;
+        }
+
+        // Lend a hand to the worker threads (the only way to make progress when we have none)
+        if( !LinuxDoNextQueuedJob( globalPlatform.loPriorityQueue, MAIN_THREAD_WORKER_INDEX ) )
+            usleep( 100 );
+    }
+
+    f64 elapsedMillis = LinuxCurrentTimeMillis() - startMillis;
+    LOG( "WFC processed %d of %d chunks in %.3f ms", globalState->processedChunkCount,
+         globalState->outputChunks.Count(), elapsedMillis );
+}
+
+
+int 
+main( int argC, char **argV )
+{
+    globalPlatform.Log = LinuxLog;
+    globalPlatform.DEBUGReadEntireFile = DEBUGLinuxReadEntireFile;
+    globalPlatform.DEBUGFreeFileMemory = DEBUGLinuxFreeFileMemory;
+    globalPlatform.DEBUGWriteEntireFile = DEBUGLinuxWriteEntireFile;
+    globalPlatform.DEBUGListAllAssets = LinuxListAllAssets;
+    globalPlatform.DEBUGJoinPaths = LinuxJoinPaths;
+    globalPlatform.DEBUGGetParentPath = LinuxGetParentPath;
+    globalPlatform.DEBUGCurrentTimeMillis = LinuxCurrentTimeMillis;
+    globalPlatform.AddNewJob = LinuxAddNewJob;
+    globalPlatform.AddGroupJob = LinuxAddGroupJob;
+    globalPlatform.AddNewJobs = LinuxAddNewJobs;
+    globalPlatform.AddContinuation = LinuxAddContinuation;
+    globalPlatform.WaitForJobGroup = LinuxWaitForJobGroup;
+    globalPlatform.ShouldYield = LinuxShouldYield;
+    globalPlatform.GetWorkerArena = LinuxGetWorkerArena;
+    globalPlatform.CompleteAllJobs = LinuxCompleteAllJobs;
+    globalPlatform.AllocateOrUpdateTexture = LinuxAllocateTexture;
+    globalPlatform.DeallocateTexture = LinuxDeallocateTexture;
+
+    int coreCount = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    LinuxBatchArgs args = LinuxParseArgs( argC, argV, coreCount );
+
+    globalPlatformState.pageSize = (sz)sysconf( _SC_PAGESIZE );
+    VirtualMemoryBacking* memoryBacking = &globalPlatformState.memoryBacking;
+    memoryBacking->Commit = LinuxCommitMemory;
+    memoryBacking->Decommit = LinuxDecommitMemory;
+    // Same as the huge page size, so we never split one
+    memoryBacking->commitBlockSize = MEGABYTES(2);
+    memoryBacking->decommitThreshold = MEGABYTES(64);
+
+    // FIXME Should be dynamic, but can't be bothered!
+    LinuxWorkerThreadContext threadContexts[32];
+    ASSERT( args.threadCount <= ARRAYCOUNT(threadContexts) );
+
+    globalWorkerThreadIndex = MAIN_THREAD_WORKER_INDEX;
+    LinuxInitJobQueue( &globalPlatformState.hiPriorityQueue, &globalPlatformState.workerPool, args.threadCount );
+    LinuxInitJobQueue( &globalPlatformState.loPriorityQueue, &globalPlatformState.workerPool, args.threadCount );
+    LinuxInitWorkerPool( &globalPlatformState.workerPool, threadContexts, args.threadCount, memoryBacking, args.hugePages );
+    globalPlatform.hiPriorityQueue = &globalPlatformState.hiPriorityQueue;
+    globalPlatform.loPriorityQueue = &globalPlatformState.loPriorityQueue;
+    globalPlatform.coreThreadsCount = args.threadCount;
+
+    LinuxResolvePaths( &globalPlatformState );
+
+    LOG( "Initializing headless Linux platform with %d threads", args.threadCount );
+    GameMemory gameMemory = {};
+    // NOTE These are only reserved. The game arenas commit pages as needed
+    gameMemory.permanentStorageSize = GIGABYTES(64);
+    gameMemory.transientStorageSize = GIGABYTES(16);
+#if !RELEASE
+    gameMemory.debugStorageSize = MEGABYTES(64);
+#endif
+    gameMemory.storageBacking = memoryBacking;
+    gameMemory.platformAPI = &globalPlatform;
+
+    globalPlatformState.gameMemorySize = gameMemory.permanentStorageSize + gameMemory.transientStorageSize;
+#if !RELEASE
+    globalPlatformState.gameMemorySize += gameMemory.debugStorageSize;
+#endif
+    globalPlatformState.gameMemoryBlock = LinuxReserveMemory( globalPlatformState.gameMemorySize, false );
+    if( !globalPlatformState.gameMemoryBlock )
+    {
+        LOG( ".FATAL: Couldn't allocate game memory!" );
+        return 1;
+    }
+
+    gameMemory.permanentStorage = globalPlatformState.gameMemoryBlock;
+    gameMemory.transientStorage = (u8*)gameMemory.permanentStorage + gameMemory.permanentStorageSize;
+#if !RELEASE
+    gameMemory.debugStorage = (u8*)gameMemory.transientStorage + gameMemory.transientStorageSize;
+#endif
+
+    // The world arena is where all the big voxel & mesh data lives
+    if( args.hugePages )
+        madvise( gameMemory.permanentStorage, gameMemory.permanentStorageSize, MADV_HUGEPAGE );
+
+    // Commit what's not managed by the arenas (anonymous mappings come zeroed)
+    bool committed = LinuxCommitMemory( gameMemory.permanentStorage, sizeof(GameState) )
+        && LinuxCommitMemory( gameMemory.transientStorage, sizeof(TransientState) );
+#if !RELEASE
+    committed = committed && LinuxCommitMemory( gameMemory.debugStorage, gameMemory.debugStorageSize );
+#endif
+    if( !committed )
+    {
+        LOG( ".FATAL: Couldn't commit game memory!" );
+        return 1;
+    }
+#if !RELEASE
+    DEBUGglobalMemoryStats = ((DebugState*)gameMemory.debugStorage)->memoryStats;
+    DEBUGglobalDCEdgeStats = &((DebugState*)gameMemory.debugStorage)->dcEdgeStats;
+#endif
+
+    // Same initialization as the game does on its first update
+    GameState* gameState = (GameState*)gameMemory.permanentStorage;
+    InitArena( &gameState->worldArena,
+               (u8 *)gameMemory.permanentStorage + sizeof(GameState),
+               gameMemory.permanentStorageSize - sizeof(GameState), gameMemory.storageBacking );
+    InitArena( &gameState->transientArena,
+               (u8 *)gameMemory.transientStorage + sizeof(TransientState),
+               gameMemory.transientStorageSize - sizeof(TransientState), gameMemory.storageBacking );
+    SetArenaTag( &gameState->worldArena, MemoryTag::World() );
+    SetArenaTag( &gameState->transientArena, MemoryTag::Scratch() );
+    auxArena = &gameState->worldArena;
+
+    gameState->world = PUSH_STRUCT( &gameState->worldArena, World );
+    sz clusterCacheBudget = args.clusterBudgetMB > 0 ? (sz)MEGABYTES( (u64)args.clusterBudgetMB ) : DefaultClusterCacheBudget;
+    InitWorld( gameState->world, &gameState->worldArena, &gameState->transientArena, clusterCacheBudget );
+    gameMemory.isInitialized = true;
+
+    if( args.clusterCount > 0 )
+        LinuxRunWorldGeneration( &gameMemory, gameState, args );
+
+    if( args.wfcSpecIndex >= 0 )
+        LinuxRunWFC( gameState, args );
+
+    return 0;
+}
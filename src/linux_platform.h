@@ -0,0 +1,118 @@
+/*
+The MIT License
+
+Copyright (c) 2017 Oscar Peñas Pariente <oscarpp80@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __LINUX_PLATFORM_H__
+#define __LINUX_PLATFORM_H__ 
+
+
+struct PlatformJobQueueJob
+{
+    PlatformJobQueueCallbackFunc* callback;
+    void* userData;
+    PlatformJobGroup* group;
+};
+
+struct LinuxWorkerPool;
+
+struct PlatformJobQueue
+{
+    // One deque per worker thread (index 0 is the main thread). Threads add jobs to their own deque
+    // and steal from everybody else's when they run out
+    WorkStealingDeque<PlatformJobQueueJob>* workerQueues;
+    i32 workerCount;
+    // Jobs added from threads outside the pool, plus overflow from any full deques
+    MPMCQueue<PlatformJobQueueJob> sharedQueue;
+
+    // Threads running jobs from this queue (shared with all other queues)
+    LinuxWorkerPool* pool;
+
+    volatile u32 completionCount;
+    volatile u32 completionTarget;
+};
+
+#define LINUX_MAX_JOB_QUEUES 2
+
+// Scratch memory for each worker. Padded to a full cache line so workers never touch each other's
+struct alignas(64) LinuxWorkerMemory
+{
+    MemoryArena arena;
+    // When the job currently running in this worker started
+    f64 jobStartMillis;
+};
+
+// All queues share the same worker threads, which always run jobs from higher priority queues first
+// and sleep on a common semaphore when there's nothing to do in any of them
+struct LinuxWorkerPool
+{
+    // In order of decreasing priority
+    PlatformJobQueue* queues[LINUX_MAX_JOB_QUEUES];
+    i32 queueCount;
+
+    sem_t semaphore;
+    volatile u32 sleepingWorkerCount;
+
+    LinuxWorkerMemory* workerMemory;
+    i32 workerCount;
+
+    // Longest a job from a lower priority queue gets to run before it's asked to yield, even if there's no other work pending
+    f64 yieldBudgetMillis;
+};
+
+struct LinuxWorkerThreadContext
+{
+    i32 threadIndex;
+    LinuxWorkerPool* pool;
+};
+
+struct LinuxState
+{
+    char currentDirectory[PLATFORM_PATH_MAX];
+    char exeFilePath[PLATFORM_PATH_MAX];
+    char binFolderPath[PLATFORM_PATH_MAX];
+    char dataFolderPath[PLATFORM_PATH_MAX];
+
+    void *gameMemoryBlock;
+    u64 gameMemorySize;
+
+    sz pageSize;
+    VirtualMemoryBacking memoryBacking;
+
+    PlatformJobQueue hiPriorityQueue;
+    PlatformJobQueue loPriorityQueue;
+    LinuxWorkerPool workerPool;
+};
+
+// Options for a headless (batch) run
+struct LinuxBatchArgs
+{
+    i32 threadCount;
+    i32 clusterCount;
+    i32 wfcSpecIndex;
+    f64 wfcTimeoutSeconds;
+    // Overrides the default cluster cache budget when non-zero
+    i32 clusterBudgetMB;
+    // Ask for transparent huge pages for the world & worker arenas
+    bool hugePages;
+};
+
+#endif /* __LINUX_PLATFORM_H__ */
@@ -107,6 +107,12 @@ RandomSeed()
     srand( (u32)time( nullptr ) );
 }
 
+inline void
+RandomSeed( u32 seed )
+{
+    srand( seed );
+}
+
 inline f32
 RandomNormalizedF32()
 {
@@ -196,6 +202,53 @@ RandomRangeF64( f64 min, f64 max )
     return result;
 }
 
+// Repeatable random numbers with their own state (PCG32, see http://www.pcg-random.org/),
+// so each generation task can own one and not depend on what any other thread is doing with rand()
+struct RandomStream
+{
+    u64 state;
+    u64 increment;
+};
+
+inline u32
+RandomU32( RandomStream* stream )
+{
+    u64 oldState = stream->state;
+    stream->state = oldState * 6364136223846793005ull + stream->increment;
+
+    u32 xorShifted = (u32)(((oldState >> 18u) ^ oldState) >> 27u);
+    u32 rotation = (u32)(oldState >> 59u);
+    return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+inline RandomStream
+RandomStreamFromSeed( u64 seed, u64 sequence = 0 )
+{
+    RandomStream result = { 0, (sequence << 1u) | 1u };
+    RandomU32( &result );
+    result.state += seed;
+    RandomU32( &result );
+    return result;
+}
+
+// Includes 0 & 1, same as the rand() based version
+inline f32
+RandomNormalizedF32( RandomStream* stream )
+{
+    f32 result = (f32)(RandomU32( stream ) >> 8) / (f32)0xFFFFFF;
+    return result;
+}
+
+// Includes min & max
+inline i32
+RandomRangeI32( RandomStream* stream, i32 min, i32 max )
+{
+    ASSERT( min < max );
+    f32 t = RandomNormalizedF32( stream );
+    i32 result = (i32)(min + t * (max - min));
+    return result;
+}
+
 internal int LogTable256[256] = 
 {
 #define LT(n) n, n, n, n, n, n, n, n, n, n, n, n, n, n, n, n
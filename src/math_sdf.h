@@ -187,4 +187,328 @@ inline f32 SDFCone( v3 const& p, f32 a, f32 b )
     return (p.x * p.x + p.y * p.y) / a - Sqr( p.z - b );
 }
 
+// Versions returning the gradient together with the value, so normals don't need any extra sampling
+// (the broken ones above are left out)
+
+struct SDFValue
+{
+    f32 d;
+    v3 gradient;
+};
+
+inline SDFValue SDFUnion( SDFValue const& d1, SDFValue const& d2 )
+{
+    return d1.d < d2.d ? d1 : d2;
+}
+
+inline SDFValue SDFIntersection( SDFValue const& d1, SDFValue const& d2 )
+{
+    return d1.d > d2.d ? d1 : d2;
+}
+
+inline SDFValue SDFSubstraction( SDFValue const& d1, SDFValue const& d2 )
+{
+    SDFValue neg = { -d2.d, -d2.gradient };
+    return d1.d > neg.d ? d1 : neg;
+}
+
+inline SDFValue SDFOnion( SDFValue const& d, f32 thickness )
+{
+    SDFValue result = { Abs( d.d ) - thickness, d.d < 0.f ? -d.gradient : d.gradient };
+    return result;
+}
+
+inline SDFValue SDFBoxGradient( v3 const& p, v3 const& hdim, f32 r = 0.f )
+{
+    const v3 d = Abs( p ) - hdim;
+    const v3 s = { p.x < 0.f ? -1.f : 1.f, p.y < 0.f ? -1.f : 1.f, p.z < 0.f ? -1.f : 1.f };
+
+    SDFValue result = { SDFBox( p, hdim, r ) };
+    if( d.x > 0.f || d.y > 0.f || d.z > 0.f )
+    {
+        // Outside: towards the closest point on the surface
+        v3 q = { Max( d.x, 0.f ), Max( d.y, 0.f ), Max( d.z, 0.f ) };
+        result.gradient = Hadamard( q, s ) / LengthSlow( q );
+    }
+    else
+    {
+        // Inside: along the axis of the closest face
+        if( d.x > d.y && d.x > d.z )
+            result.gradient = { s.x, 0.f, 0.f };
+        else if( d.y > d.z )
+            result.gradient = { 0.f, s.y, 0.f };
+        else
+            result.gradient = { 0.f, 0.f, s.z };
+    }
+    return result;
+}
+
+inline SDFValue SDFCylinderGradient( v3 const& p, f32 r )
+{
+    SDFValue result = { SDFCylinder( p, r ), { 0.f, 2.f * p.y, 2.f * p.z } };
+    return result;
+}
+
+inline SDFValue SDFTorusGradient( v3 const& p, f32 r, f32 t )
+{
+    const f32 lxy = Length( p.xy );
+    const v2 q = V2( lxy - r, p.z );
+    const f32 lq = Length( q );
+
+    SDFValue result = { lq - t };
+    // The gradient is undefined along the Z axis and on the core circle, so don't divide by zero there
+    if( lq > 0.f )
+    {
+        if( lxy > 0.f )
+            result.gradient = V3( q.x * p.x / lxy, q.x * p.y / lxy, p.z ) / lq;
+        else
+            result.gradient = V3( 0.f, 0.f, p.z / lq );
+    }
+    return result;
+}
+
+inline SDFValue SDFSphereGradient( v3 const& p, f32 r )
+{
+    SDFValue result = { SDFSphere( p, r ), NormalizedSlow( p ) };
+    return result;
+}
+
+inline SDFValue SDFHollowCubeGradient( v3 const& p )
+{
+    f32 pp = 15000.f;
+
+    f32 x2 = p.x * p.x;
+    f32 y2 = p.y * p.y;
+    f32 z2 = p.z * p.z;
+
+    f32 xy = x2 + y2 - pp;
+    f32 xz = x2 + z2 - pp;
+    f32 zy = z2 + y2 - pp;
+
+    SDFValue result = { SDFHollowCube( p ), { 4.f * p.x * (xy + xz), 4.f * p.y * (xy + zy), 4.f * p.z * (xz + zy) } };
+    return result;
+}
+
+inline SDFValue SDFDevilGradient( v3 const& p )
+{
+    f32 a = 15.f;
+    f32 b = 3600.f;
+    f32 c = 2500.f;
+
+    f32 x2 = p.x * p.x;
+    f32 y2 = p.y * p.y;
+    f32 z2 = p.z * p.z;
+
+    SDFValue result = { SDFDevil( p ) };
+    result.gradient = { p.x * (4.f * x2 + 2.f * a * z2 - 2.f * b),
+                        p.y * (-4.f * y2 + 2.f * c),
+                        p.z * (2.f * a * x2 + 4.f * z2) };
+    return result;
+}
+
+inline SDFValue SDFQuarticCylinderGradient( v3 const& p )
+{
+    f32 a = 0.1f;
+    f32 b = 0.5f;
+
+    f32 x2 = p.x * p.x;
+    f32 y2 = p.y * p.y;
+    f32 z2 = p.z * p.z;
+
+    SDFValue result = { SDFQuarticCylinder( p ) };
+    result.gradient = { 2.f * p.x * (y2 + a), 2.f * p.y * (x2 + z2), 2.f * p.z * (y2 + b) };
+    return result;
+}
+
+inline SDFValue SDFTangleCubeGradient( v3 const& p )
+{
+    f32 a = 5000.f;
+
+    SDFValue result = { SDFTangleCube( p ) };
+    result.gradient = { p.x * (4.f * p.x * p.x - 2.f * a), p.y * (4.f * p.y * p.y - 2.f * a), p.z * (4.f * p.z * p.z - 2.f * a) };
+    return result;
+}
+
+inline SDFValue SDFGenus2Gradient( v3 const& p )
+{
+    f32 a = 200.f;
+    f32 b = 30.f;
+    f32 c = 900.f;
+    f32 d = 1000.f;
+    f32 e = 10.f;
+
+    f32 x2 = p.x * p.x;
+    f32 y2 = p.y * p.y;
+    f32 z2 = p.z * p.z;
+
+    f32 u = y2 - b * x2;
+    f32 w = d - z2;
+
+    SDFValue result = { SDFGenus2( p ) };
+    result.gradient = { -2.f * a * b * p.x * p.y * w + 4.f * p.x * (x2 + y2),
+                        a * (u + 2.f * y2) * w + 4.f * p.y * (x2 + y2),
+                        -2.f * a * p.y * u * p.z - 2.f * c * p.z * w + 2.f * p.z * (c * z2 - e) };
+    return result;
+}
+
+inline SDFValue SDFConeGradient( v3 const& p, f32 a, f32 b )
+{
+    SDFValue result = { SDFCone( p, a, b ), { 2.f * p.x / a, 2.f * p.y / a, -2.f * (p.z - b) } };
+    return result;
+}
+
+
+// Wide versions (one point per lane)
+// NOTE These must return exactly the same values as the scalar ones, so keep the order of operations in sync!
+
+inline f32x4 SDFUnion( f32x4 const& d1, f32x4 const& d2 )
+{
+    return Min( d1, d2 );
+}
+
+inline f32x4 SDFIntersection( f32x4 const& d1, f32x4 const& d2 )
+{
+    return Max( d1, d2 );
+}
+
+inline f32x4 SDFSubstraction( f32x4 const& d1, f32x4 const& d2 )
+{
+    return Max( d1, -d2  );
+}
+
+inline f32x4 SDFOnion( f32x4 const& d, f32 thickness )
+{
+    return Abs( d ) - thickness;
+}
+
+inline f32x4 SDFBox( v3x4 const& p, v3 const& hdim, f32 r = 0.f )
+{
+    const v3x4 d = Abs( p ) - hdim;
+    return LengthSlow( { Max( d.x, 0.f ), Max( d.y, 0.f) , Max( d.z, 0.f ) } )
+        + Min( Max( d.x, Max( d.y, d.z ) ), 0.f )
+        - r;
+}
+
+inline f32x4 SDFCylinder( v3x4 const& p, f32 r )
+{
+    return p.y * p.y + p.z * p.z - r * r;
+}
+
+inline f32x4 SDFTorus( v3x4 const& p, f32 r, f32 t )
+{
+    const f32x4 qx = Sqrt( p.x * p.x + p.y * p.y ) - r;
+    return Sqrt( qx * qx + p.z * p.z ) - t;
+}
+
+inline f32x4 SDFHollowCube( v3x4 const& p )
+{
+    f32 pp = 15000.f;
+    f32 r4 = 100000000.f;
+
+    f32x4 x2 = p.x * p.x;
+    f32x4 y2 = p.y * p.y;
+    f32x4 z2 = p.z * p.z;
+
+    return Sqr( x2 + y2 - pp ) + Sqr( x2 + z2 - pp ) + Sqr( z2 + y2 - pp ) - r4;
+}
+
+inline f32x4 SDFDevil( v3x4 const& p )
+{
+    f32 a = 15.f;
+    f32 b = 3600.f;
+    f32 c = 2500.f;
+
+    f32x4 x2 = p.x * p.x;
+    f32x4 y2 = p.y * p.y;
+    f32x4 z2 = p.z * p.z;
+
+    return x2 * x2 + a * x2 * z2 - b * x2 - y2 * y2 + c * y2 + z2 * z2;
+}
+
+inline f32x4 SDFQuarticCylinder( v3x4 const& p )
+{
+    f32 a = 0.1f;
+    f32 b = 0.5f;
+    f32 c = 2000.f;
+
+    f32x4 x2 = p.x * p.x;
+    f32x4 y2 = p.y * p.y;
+    f32x4 z2 = p.z * p.z;
+
+    return y2 * x2 + y2 * z2 + a * x2 + b * z2 - c;
+}
+
+inline f32x4 SDFTangleCube( v3x4 const& p )
+{
+    f32 a = 5000.f;
+    f32 b = 12499999.f;
+
+    f32x4 x2 = p.x * p.x;
+    f32x4 y2 = p.y * p.y;
+    f32x4 z2 = p.z * p.z;
+
+    return x2 * x2 - a * x2 + y2 * y2 - a * y2 + z2 * z2 - a * z2 + b;
+}
+
+inline f32x4 SDFGenus2( v3x4 const& p )
+{
+    f32 a = 200.f;
+    f32 b = 30.f;
+    f32 c = 900.f;
+    f32 d = 1000.f;
+    f32 e = 10.f;
+
+    f32x4 x2 = p.x * p.x;
+    f32x4 y2 = p.y * p.y;
+    f32x4 z2 = p.z * p.z;
+
+    return a * p.y * (y2 - b * x2) * (d - z2) + Sqr( x2 + y2 ) - (c * z2 - e) * (d - z2);
+}
+
+// Interval versions, giving conservative bounds for all values inside a region
+// (only for actual distance fields, as the algebraic surfaces above are unbounded for all practical purposes)
+
+inline interval SDFUnion( interval const& d1, interval const& d2 )
+{
+    return Min( d1, d2 );
+}
+
+inline interval SDFIntersection( interval const& d1, interval const& d2 )
+{
+    return Max( d1, d2 );
+}
+
+inline interval SDFSubstraction( interval const& d1, interval const& d2 )
+{
+    return Max( d1, -d2 );
+}
+
+inline interval SDFOnion( interval const& d, f32 thickness )
+{
+    return Abs( d ) - thickness;
+}
+
+inline interval SDFBox( aabb const& region, v3 const& hdim, f32 r = 0.f )
+{
+    const interval zero = Interval( 0.f );
+    interval dx = Abs( IntervalX( region ) ) - hdim.x;
+    interval dy = Abs( IntervalY( region ) ) - hdim.y;
+    interval dz = Abs( IntervalZ( region ) ) - hdim.z;
+
+    return Sqrt( Sqr( Max( dx, zero ) ) + Sqr( Max( dy, zero ) ) + Sqr( Max( dz, zero ) ) )
+        + Min( Max( dx, Max( dy, dz ) ), zero )
+        - r;
+}
+
+inline interval SDFCylinder( aabb const& region, f32 r )
+{
+    return Sqr( IntervalY( region ) ) + Sqr( IntervalZ( region ) ) - r * r;
+}
+
+inline interval SDFTorus( aabb const& region, f32 r, f32 t )
+{
+    interval q = Sqrt( Sqr( IntervalX( region ) ) + Sqr( IntervalY( region ) ) ) - r;
+    return Sqrt( Sqr( q ) + Sqr( IntervalZ( region ) ) ) - t;
+}
+
 #endif /* __MATH_SDF_H__ */
@@ -2026,6 +2026,138 @@ inline bool AABBInFrustum( v3 aabb_min, v3 aabb_max, const v4* frustum )
 #endif
 
 
+// Interval
+// Conservative range of values some function can take over a whole region
+
+struct interval
+{
+    f32 min;
+    f32 max;
+};
+
+inline interval
+Interval( f32 min, f32 max )
+{
+    ASSERT( max >= min );
+    interval result = { min, max };
+    return result;
+}
+
+inline interval
+Interval( f32 value )
+{
+    interval result = { value, value };
+    return result;
+}
+
+inline interval
+operator +( interval const& a, interval const& b )
+{
+    interval result = { a.min + b.min, a.max + b.max };
+    return result;
+}
+
+inline interval
+operator -( interval const& a, f32 s )
+{
+    interval result = { a.min - s, a.max - s };
+    return result;
+}
+
+inline interval
+operator -( interval const& a )
+{
+    interval result = { -a.max, -a.min };
+    return result;
+}
+
+inline interval
+Min( interval const& a, interval const& b )
+{
+    interval result = { Min( a.min, b.min ), Min( a.max, b.max ) };
+    return result;
+}
+
+inline interval
+Max( interval const& a, interval const& b )
+{
+    interval result = { Max( a.min, b.min ), Max( a.max, b.max ) };
+    return result;
+}
+
+inline interval
+Abs( interval const& a )
+{
+    interval result;
+    if( a.min >= 0.f )
+        result = a;
+    else if( a.max <= 0.f )
+        result = -a;
+    else
+        result = { 0.f, Max( -a.min, a.max ) };
+    return result;
+}
+
+inline interval
+Sqr( interval const& a )
+{
+    interval abs = Abs( a );
+    interval result = { abs.min * abs.min, abs.max * abs.max };
+    return result;
+}
+
+inline interval
+Sqrt( interval const& a )
+{
+    ASSERT( a.min >= 0.f );
+    interval result = { Sqrt( a.min ), Sqrt( a.max ) };
+    return result;
+}
+
+// Smallest interval containing both
+inline interval
+Hull( interval const& a, interval const& b )
+{
+    interval result = { Min( a.min, b.min ), Max( a.max, b.max ) };
+    return result;
+}
+
+inline bool
+Contains( interval const& a, f32 value )
+{
+    return a.min <= value && value <= a.max;
+}
+
+inline interval
+IntervalX( aabb const& b )
+{
+    return Interval( b.center.x - b.halfSize.x, b.center.x + b.halfSize.x );
+}
+
+inline interval
+IntervalY( aabb const& b )
+{
+    return Interval( b.center.y - b.halfSize.y, b.center.y + b.halfSize.y );
+}
+
+inline interval
+IntervalZ( aabb const& b )
+{
+    return Interval( b.center.z - b.halfSize.z, b.center.z + b.halfSize.z );
+}
+
+// Bounds of the transformed box
+inline aabb
+Transform( m4 const& m, aabb const& b )
+{
+    aabb result;
+    result.center = Transform( m, b.center );
+    for( int r = 0; r < 3; ++r )
+        result.halfSize.e[r] = Abs( m.e[r][0] ) * b.halfSize.x + Abs( m.e[r][1] ) * b.halfSize.y + Abs( m.e[r][2] ) * b.halfSize.z;
+    return result;
+}
+
+
 // Ray
 
 struct ray
@@ -2102,4 +2234,243 @@ Intersects( const ray& r, tri& t, v3* pI = nullptr, f32 absoluteEpsilon = 0 )
     return result;
 }
 
+// Wide (SIMD) lanes
+// NOTE SSE only for now, as it's always available on x64 without extra compiler flags.
+// Going to AVX should only require changing these types & ops, as all client code works in terms of LaneWidth.
+
+const int LaneWidth = 4;
+
+struct f32x4
+{
+    __m128 v;
+};
+
+// Lane masks use all bits set for 'true' lanes, just like the SSE comparisons return
+typedef f32x4 maskx4;
+
+INLINE f32x4
+F32x4( f32 s )
+{
+    f32x4 result = { _mm_set1_ps( s ) };
+    return result;
+}
+
+INLINE f32x4
+F32x4( __m128 v )
+{
+    f32x4 result = { v };
+    return result;
+}
+
+INLINE f32x4
+LoadF32x4( f32 const* p )
+{
+    f32x4 result = { _mm_loadu_ps( p ) };
+    return result;
+}
+
+INLINE void
+StoreF32x4( f32* p, f32x4 const& v )
+{
+    _mm_storeu_ps( p, v.v );
+}
+
+INLINE f32x4
+operator +( f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_add_ps( a.v, b.v ) );
+}
+
+INLINE f32x4
+operator -( f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_sub_ps( a.v, b.v ) );
+}
+
+INLINE f32x4
+operator *( f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_mul_ps( a.v, b.v ) );
+}
+
+INLINE f32x4
+operator /( f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_div_ps( a.v, b.v ) );
+}
+
+INLINE f32x4
+operator +( f32x4 const& a, f32 s )
+{
+    return F32x4( _mm_add_ps( a.v, _mm_set1_ps( s ) ) );
+}
+
+INLINE f32x4
+operator -( f32x4 const& a, f32 s )
+{
+    return F32x4( _mm_sub_ps( a.v, _mm_set1_ps( s ) ) );
+}
+
+INLINE f32x4
+operator -( f32 s, f32x4 const& a )
+{
+    return F32x4( _mm_sub_ps( _mm_set1_ps( s ), a.v ) );
+}
+
+INLINE f32x4
+operator *( f32x4 const& a, f32 s )
+{
+    return F32x4( _mm_mul_ps( a.v, _mm_set1_ps( s ) ) );
+}
+
+INLINE f32x4
+operator *( f32 s, f32x4 const& a )
+{
+    return F32x4( _mm_mul_ps( _mm_set1_ps( s ), a.v ) );
+}
+
+INLINE f32x4
+operator -( f32x4 const& a )
+{
+    return F32x4( _mm_xor_ps( a.v, _mm_set1_ps( -0.f ) ) );
+}
+
+INLINE maskx4
+operator <( f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_cmplt_ps( a.v, b.v ) );
+}
+
+INLINE maskx4
+operator <=( f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_cmple_ps( a.v, b.v ) );
+}
+
+INLINE maskx4
+operator &( maskx4 const& a, maskx4 const& b )
+{
+    return F32x4( _mm_and_ps( a.v, b.v ) );
+}
+
+// Same semantics as the scalar versions (return b when not comparable)
+INLINE f32x4
+Min( f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_min_ps( a.v, b.v ) );
+}
+
+INLINE f32x4
+Max( f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_max_ps( a.v, b.v ) );
+}
+
+INLINE f32x4
+Min( f32x4 const& a, f32 s )
+{
+    return F32x4( _mm_min_ps( a.v, _mm_set1_ps( s ) ) );
+}
+
+INLINE f32x4
+Max( f32x4 const& a, f32 s )
+{
+    return F32x4( _mm_max_ps( a.v, _mm_set1_ps( s ) ) );
+}
+
+INLINE f32x4
+Abs( f32x4 const& a )
+{
+    return F32x4( _mm_andnot_ps( _mm_set1_ps( -0.f ), a.v ) );
+}
+
+INLINE f32x4
+Sqrt( f32x4 const& a )
+{
+    return F32x4( _mm_sqrt_ps( a.v ) );
+}
+
+INLINE f32x4
+Sqr( f32x4 const& a )
+{
+    return F32x4( _mm_mul_ps( a.v, a.v ) );
+}
+
+// Pick 'a' in lanes where mask is set, 'b' otherwise
+INLINE f32x4
+Select( maskx4 const& mask, f32x4 const& a, f32x4 const& b )
+{
+    return F32x4( _mm_or_ps( _mm_and_ps( mask.v, a.v ), _mm_andnot_ps( mask.v, b.v ) ) );
+}
+
+INLINE bool
+AnyTrue( maskx4 const& mask )
+{
+    return _mm_movemask_ps( mask.v ) != 0;
+}
+
+// Structure-of-arrays version of v3, one point per lane
+struct v3x4
+{
+    f32x4 x, y, z;
+};
+
+INLINE v3x4
+V3x4( v3 const& v )
+{
+    v3x4 result = { F32x4( v.x ), F32x4( v.y ), F32x4( v.z ) };
+    return result;
+}
+
+INLINE v3x4
+LoadV3x4( f32 const* xs, f32 const* ys, f32 const* zs )
+{
+    v3x4 result = { LoadF32x4( xs ), LoadF32x4( ys ), LoadF32x4( zs ) };
+    return result;
+}
+
+INLINE v3x4
+operator +( v3x4 const& a, v3 const& b )
+{
+    v3x4 result = { a.x + b.x, a.y + b.y, a.z + b.z };
+    return result;
+}
+
+INLINE v3x4
+operator -( v3x4 const& a, v3 const& b )
+{
+    v3x4 result = { a.x - b.x, a.y - b.y, a.z - b.z };
+    return result;
+}
+
+INLINE v3x4
+Abs( v3x4 const& v )
+{
+    v3x4 result = { Abs( v.x ), Abs( v.y ), Abs( v.z ) };
+    return result;
+}
+
+INLINE f32x4
+LengthSlow( v3x4 const& v )
+{
+    return Sqrt( v.x * v.x + v.y * v.y + v.z * v.z );
+}
+
+INLINE v3x4
+Transform( const m4 &m, v3x4 const& v )
+{
+    v3x4 r;
+    r.x = v.x*m.e[0][0] + v.y*m.e[0][1] + v.z*m.e[0][2] + m.e[0][3];
+    r.y = v.x*m.e[1][0] + v.y*m.e[1][1] + v.z*m.e[1][2] + m.e[1][3];
+    r.z = v.x*m.e[2][0] + v.y*m.e[2][1] + v.z*m.e[2][2] + m.e[2][3];
+    return r;
+}
+
+INLINE maskx4
+ContainsOrTouches( aabb const& b, v3x4 const& p )
+{
+    v3x4 dist = Abs( p - b.center );
+    return (dist.x <= F32x4( b.halfSize.x )) & (dist.y <= F32x4( b.halfSize.y )) & (dist.z <= F32x4( b.halfSize.z ));
+}
+
 #endif /* __MATH_TYPES_H__ */
@@ -31,7 +31,68 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #endif
 
 
-// TODO ASAP Add a tag per allocation (even the same arena can contain different stuff)
+/////     MEMORY TAGS     /////
+// Every arena & pool allocation is attributed to a tag, so we know where all the bytes go (non-release builds only).
+// Arenas have a default tag which allocations can override (see Tagged() below). Sub arenas count as a single
+// allocation of their whole size in their parent, while pools only count the blocks actually in use.
+
+#define VALUES(x) \
+    x(Untagged) \
+    x(World) \
+    x(Clusters) \
+    x(ClusterVoxels) \
+    x(Meshes) \
+    x(WFC) \
+    x(UI) \
+    x(Editor) \
+    x(Jobs) \
+    x(Scratch) \
+
+STRUCT_ENUM(MemoryTag, VALUES)
+#undef VALUES
+
+struct MemoryTagStats
+{
+    volatile u64 liveBytes;
+    volatile u64 peakBytes;
+    // Total, not live
+    volatile u64 allocationCount;
+};
+
+#if !RELEASE
+// NOTE Lives in the debug storage so it's shared by the platform and the game, but each module needs to point to it
+// Nothing is tracked while this is null
+extern MemoryTagStats* DEBUGglobalMemoryStats;
+
+inline void
+DEBUGTrackAllocation( u32 tag, sz size )
+{
+    if( DEBUGglobalMemoryStats )
+    {
+        MemoryTagStats* stats = DEBUGglobalMemoryStats + tag;
+        u64 liveBytes = AtomicAdd( &stats->liveBytes, (u64)size ) + size;
+        AtomicAdd( &stats->allocationCount, 1ull );
+
+        u64 peakBytes = stats->peakBytes;
+        while( liveBytes > peakBytes )
+        {
+            u64 prevPeakBytes = AtomicCompareExchange( &stats->peakBytes, liveBytes, peakBytes );
+            if( prevPeakBytes == peakBytes )
+                break;
+            peakBytes = prevPeakBytes;
+        }
+    }
+}
+
+inline void
+DEBUGTrackFree( u32 tag, sz size )
+{
+    if( DEBUGglobalMemoryStats )
+        AtomicAdd( &DEBUGglobalMemoryStats[tag].liveBytes, (u64)-(i64)size );
+}
+#endif
+
+
 #define PUSH_STRUCT(arena, type, ...) (type *)_PushSize( arena, sizeof(type), ## __VA_ARGS__ )
 #define PUSH_ARRAY(arena, type, count, ...) (type *)_PushSize( arena, (count)*sizeof(type), ## __VA_ARGS__ )
 #define PUSH_SIZE(arena, size, ...) _PushSize( arena, size, ## __VA_ARGS__ )
@@ -42,14 +103,43 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ///// STATIC MEMORY ARENA
 // Linear memory arena of a fixed initial size
 // Can be partitioned into sub arenas and supports "temporary blocks" (which can be nested)
+// Arenas can optionally be backed by virtual memory, so that only a (huge) address range is reserved up front,
+// and pages are committed as needed, then decommitted again when usage drops well below the high-water mark.
+
+// NOTE Platforms must round the given range outwards (commit) or inwards (decommit) to page boundaries
+#define VIRTUAL_MEMORY_COMMIT(name) bool name( void* address, sz size )
+typedef VIRTUAL_MEMORY_COMMIT(VirtualMemoryCommitFunc);
+#define VIRTUAL_MEMORY_DECOMMIT(name) void name( void* address, sz size )
+typedef VIRTUAL_MEMORY_DECOMMIT(VirtualMemoryDecommitFunc);
+
+struct VirtualMemoryBacking
+{
+    VirtualMemoryCommitFunc* Commit;
+    VirtualMemoryDecommitFunc* Decommit;
+    // Granularity of commits & decommits (must be a multiple of the page size)
+    sz commitBlockSize;
+    // How much committed memory to keep around above the current usage when shrinking
+    sz decommitThreshold;
+};
 
 struct MemoryArena
 {
     u8 *base;
     sz size;
     sz used;
+    // Always equal to size for non-growable arenas
+    sz committed;
+    VirtualMemoryBacking* backing;
 
     u32 tempCount;
+
+#if !RELEASE
+    // Used when allocations don't specify a tag
+    u32 tag;
+    // Sub arenas are already accounted for in their parent
+    bool untracked;
+    sz taggedUsed[MemoryTag::Values::count];
+#endif
 };
 
 enum MemoryFlags
@@ -57,32 +147,95 @@ enum MemoryFlags
     MemoryFlags_None = 0,
     MemoryFlags_ClearToZero = 0x1,                  // Zeroed upon allocation
     MemoryFlags_TemporaryMemory = 0x2,              // No guaranteed persistence beyond allocation scope
+    MemoryFlags_Untracked = 0x4,                    // Not counted in the tag stats (i.e. pool backing memory)
 };
 
 struct MemoryParams
 {
     u32 flags;
     u32 alignment;
+    // MemoryTag index (Untagged means use the arena's default)
+    u32 tag;
 };
 
+// If a backing is given, 'size' is just the reserved address range, and nothing in it is assumed to be committed yet
 inline void
-InitArena( MemoryArena *arena, u8 *base, sz size )
+InitArena( MemoryArena *arena, u8 *base, sz size, VirtualMemoryBacking* backing = nullptr )
 {
     arena->base = base;
     arena->size = size;
     arena->used = 0;
+    arena->committed = backing ? 0 : size;
+    arena->backing = backing;
     arena->tempCount = 0;
+
+#if !RELEASE
+    arena->tag = MemoryTag::Untagged().index;
+    arena->untracked = false;
+    PZERO( arena->taggedUsed, sizeof(arena->taggedUsed) );
+#endif
+}
+
+inline void
+SetArenaTag( MemoryArena* arena, MemoryTag const& tag )
+{
+#if !RELEASE
+    arena->tag = tag.index;
+#endif
+}
+
+inline void
+CommitArenaUpTo( MemoryArena* arena, sz newUsed )
+{
+    VirtualMemoryBacking* backing = arena->backing;
+    ASSERT( backing );
+
+    // Keep commits aligned to the block size in absolute terms, so decommits never split a block
+    u8* commitEnd = (u8*)Align( arena->base + newUsed, backing->commitBlockSize );
+    sz newCommitted = Min( Sz( commitEnd - arena->base ), arena->size );
+
+    bool ok = backing->Commit( arena->base + arena->committed, newCommitted - arena->committed );
+    ASSERTM( ok, "Out of memory committing arena pages" );
+    arena->committed = newCommitted;
+}
+
+inline void
+DecommitArenaUnused( MemoryArena* arena )
+{
+    VirtualMemoryBacking* backing = arena->backing;
+    if( backing && arena->committed > arena->used + backing->decommitThreshold )
+    {
+        u8* decommitStart = (u8*)Align( arena->base + arena->used + backing->decommitThreshold, backing->commitBlockSize );
+        sz newCommitted = Sz( decommitStart - arena->base );
+
+        if( newCommitted < arena->committed )
+        {
+            backing->Decommit( decommitStart, arena->committed - newCommitted );
+            arena->committed = newCommitted;
+        }
+    }
 }
 
 inline void
 ClearArena( MemoryArena* arena, bool clearToZero = true )
 {
+#if !RELEASE
+    for( int t = 0; t < MemoryTag::Values::count; ++t )
+    {
+        if( arena->taggedUsed[t] )
+            DEBUGTrackFree( t, arena->taggedUsed[t] );
+        arena->taggedUsed[t] = 0;
+    }
+#endif
+
     arena->used = 0;
     // TODO We should properly track this and invalidate existing TemporaryMemory blocks
     arena->tempCount = 0;
 
+    DecommitArenaUnused( arena );
+    // Decommitted pages always come back zeroed
     if( clearToZero )
-        PZERO( arena->base, arena->size );
+        PZERO( arena->base, arena->committed );
 }
 
 inline sz
@@ -130,10 +283,26 @@ Temporary()
     return result;
 }
 
+// Use the result of any of the above as the second argument to combine them
+inline MemoryParams
+Tagged( MemoryTag const& tag, MemoryParams params = DefaultMemoryParams() )
+{
+    MemoryParams result = params;
+    result.tag = tag.index;
+    return result;
+}
+
+inline MemoryParams
+Untracked( MemoryParams params = DefaultMemoryParams() )
+{
+    MemoryParams result = params;
+    result.flags |= MemoryFlags_Untracked;
+    return result;
+}
+
 inline void *
 _PushSize( MemoryArena *arena, sz size, MemoryParams params = DefaultMemoryParams() )
 {
-    ASSERT( arena->used + size <= arena->size );
     if( !(params.flags & MemoryFlags_TemporaryMemory) )
         // Need to pass temp memory flag if the arena has an ongoing temp memory block
         ASSERT( arena->tempCount == 0 );
@@ -148,7 +317,21 @@ _PushSize( MemoryArena *arena, sz size, MemoryParams params = DefaultMemoryParam
         waste = Sz( (u8*)result - (u8*)free );
     }
 
-    arena->used += size + waste;
+    sz newUsed = arena->used + size + waste;
+    ASSERT( newUsed <= arena->size );
+    if( newUsed > arena->committed )
+        CommitArenaUpTo( arena, newUsed );
+
+#if !RELEASE
+    if( !arena->untracked && !(params.flags & MemoryFlags_Untracked) && DEBUGglobalMemoryStats )
+    {
+        u32 tag = params.tag ? params.tag : arena->tag;
+        arena->taggedUsed[tag] += newUsed - arena->used;
+        DEBUGTrackAllocation( tag, newUsed - arena->used );
+    }
+#endif
+
+    arena->used = newUsed;
 
     if( params.flags & MemoryFlags_ClearToZero )
         PZERO( result, size );
@@ -159,9 +342,16 @@ _PushSize( MemoryArena *arena, sz size, MemoryParams params = DefaultMemoryParam
 inline MemoryArena
 MakeSubArena( MemoryArena* arena, sz size, MemoryParams params = DefaultMemoryParams() )
 {
+    // NOTE Sub arenas are always fully committed
     MemoryArena result = {};
     result.base = (u8*)PUSH_SIZE( arena, size, params );
     result.size = size;
+    result.committed = size;
+
+#if !RELEASE
+    result.tag = params.tag ? params.tag : arena->tag;
+    result.untracked = true;
+#endif
 
     return result;
 }
@@ -170,6 +360,10 @@ struct TemporaryMemory
 {
     MemoryArena *arena;
     sz usedRecord;
+
+#if !RELEASE
+    sz taggedUsedRecord[MemoryTag::Values::count];
+#endif
 };
 
 inline TemporaryMemory
@@ -179,6 +373,9 @@ BeginTemporaryMemory( MemoryArena *arena )
 
     result.arena = arena;
     result.usedRecord = arena->used;
+#if !RELEASE
+    PCOPY( arena->taggedUsed, result.taggedUsedRecord, sizeof(arena->taggedUsed) );
+#endif
 
     ++arena->tempCount;
 
@@ -193,8 +390,19 @@ EndTemporaryMemory( TemporaryMemory& tempMem )
     ASSERT( arena->used >= tempMem.usedRecord );
     arena->used = tempMem.usedRecord;
 
+#if !RELEASE
+    for( int t = 0; t < MemoryTag::Values::count; ++t )
+    {
+        if( arena->taggedUsed[t] != tempMem.taggedUsedRecord[t] )
+            DEBUGTrackFree( t, arena->taggedUsed[t] - tempMem.taggedUsedRecord[t] );
+        arena->taggedUsed[t] = tempMem.taggedUsedRecord[t];
+    }
+#endif
+
     ASSERT( arena->tempCount > 0 );
     --arena->tempCount;
+
+    DecommitArenaUnused( arena );
 }
 
 inline void
@@ -207,117 +415,299 @@ CheckTemporaryBlocks( MemoryArena *arena )
 
 ///// STATIC MEMORY POOL
 // General memory pool of a fixed initial size, can allocate any object type or size
-// Merges free contiguous blocks and searches linearly
-
+// Two-level segregated fit (TLSF): free blocks are binned by size class (first level is the power of two, second level
+// splits that linearly), and a bitmap per level lets us find a free block big enough in constant time.
+// Freed blocks are immediately merged with their free physical neighbours.
+
+#define MEMORY_POOL_ALIGNMENT_LOG2 4
+#define MEMORY_POOL_ALIGNMENT (1 << MEMORY_POOL_ALIGNMENT_LOG2)
+// Number of second level bins for each power of two
+#define MEMORY_POOL_SL_COUNT_LOG2 5
+#define MEMORY_POOL_SL_COUNT (1 << MEMORY_POOL_SL_COUNT_LOG2)
+// Sizes below this are all binned in the first first-level class, linearly
+#define MEMORY_POOL_FL_SHIFT (MEMORY_POOL_SL_COUNT_LOG2 + MEMORY_POOL_ALIGNMENT_LOG2)
+#define MEMORY_POOL_SMALL_BLOCK_SIZE (1 << MEMORY_POOL_FL_SHIFT)
+// Supports blocks up to 1 TB
+#define MEMORY_POOL_FL_MAX_LOG2 40
+#define MEMORY_POOL_FL_COUNT (MEMORY_POOL_FL_MAX_LOG2 - MEMORY_POOL_FL_SHIFT + 1)
 
 enum MemoryBlockFlags : u32
 {
     None = 0,
     Used = 0x01,
+    // Last block in the pool's memory (there's nothing physically after it)
+    Last = 0x02,
 };
 
-struct MemoryBlock
+struct alignas(MEMORY_POOL_ALIGNMENT) MemoryBlock
 {
-    MemoryBlock* prev;
-    MemoryBlock* next;
+    MemoryBlock* prevPhysical;
+    // Only valid while in a free list
+    MemoryBlock* prevFree;
+    MemoryBlock* nextFree;
 
+    // Not including this header
     sz size;
     u32 flags;
+#if !RELEASE
+    // Of the allocation using this block (if any)
+    u32 tag;
+    sz usedSize;
+#endif
+};
+
+struct MemoryPool
+{
+    MemoryBlock* freeLists[MEMORY_POOL_FL_COUNT][MEMORY_POOL_SL_COUNT];
+    u32 flBitmap;
+    u32 slBitmaps[MEMORY_POOL_FL_COUNT];
+
+    sz size;
+    sz freeSize;
+    i32 usedBlockCount;
+
+    // Pools handing out memory to other pools shouldn't count it twice
+    bool untracked;
 };
 
+// Smallest size we can split off a block
+#define MEMORY_POOL_MIN_BLOCK_SIZE (sizeof(MemoryBlock) + MEMORY_POOL_ALIGNMENT)
+
 inline MemoryBlock*
-InsertBlock( MemoryBlock* prev, sz size, void* memory )
+NextPhysicalBlock( MemoryBlock* block )
 {
-    // TODO 'size' includes the MemoryBlock struct itself for now
-    // Are we sure we wanna do this??
-    ASSERT( size > sizeof(MemoryBlock) );
-    MemoryBlock* block = (MemoryBlock*)memory;
-    // TODO Are we sure this shouldn't be the other way around??
-    block->size = size - sizeof(MemoryBlock);
-    block->flags = MemoryBlockFlags::None;
-    block->prev = prev;
-    block->next = prev->next;
-    block->prev->next = block;
-    block->next->prev = block;
+    ASSERT( !(block->flags & MemoryBlockFlags::Last) );
+    return (MemoryBlock*)((u8*)(block + 1) + block->size);
+}
 
-    return block;
+// Bins containing blocks of size [size, size + binSize)
+inline void
+MapBlockSize( sz size, u32* fl, u32* sl )
+{
+    if( size < MEMORY_POOL_SMALL_BLOCK_SIZE )
+    {
+        *fl = 0;
+        *sl = (u32)size / (MEMORY_POOL_SMALL_BLOCK_SIZE / MEMORY_POOL_SL_COUNT);
+    }
+    else
+    {
+        u32 msb = FindMostSignificantSetBit( size );
+        *fl = msb - (MEMORY_POOL_FL_SHIFT - 1);
+        *sl = (u32)(size >> (msb - MEMORY_POOL_SL_COUNT_LOG2)) ^ MEMORY_POOL_SL_COUNT;
+    }
+    // NOTE fl can be out of range for big sizes, so callers need to check it
 }
 
-inline MemoryBlock*
-FindBlockForSize( MemoryBlock* sentinel, sz size )
+inline void
+InsertFreeBlock( MemoryPool* pool, MemoryBlock* block )
+{
+    u32 fl, sl;
+    MapBlockSize( block->size, &fl, &sl );
+    ASSERT( fl < MEMORY_POOL_FL_COUNT );
+
+    MemoryBlock* head = pool->freeLists[fl][sl];
+    block->prevFree = nullptr;
+    block->nextFree = head;
+    if( head )
+        head->prevFree = block;
+    pool->freeLists[fl][sl] = block;
+
+    pool->flBitmap |= (1u << fl);
+    pool->slBitmaps[fl] |= (1u << sl);
+    pool->freeSize += block->size;
+}
+
+inline void
+RemoveFreeBlock( MemoryPool* pool, MemoryBlock* block )
 {
-    MemoryBlock* result = nullptr;
+    u32 fl, sl;
+    MapBlockSize( block->size, &fl, &sl );
+    ASSERT( fl < MEMORY_POOL_FL_COUNT );
 
-    // TODO Best match block! (find smallest that fits)
-    for( MemoryBlock* block = sentinel->next; block != sentinel; block = block->next )
+    if( block->prevFree )
+        block->prevFree->nextFree = block->nextFree;
+    else
     {
-        if( block->size >= size && !(block->flags & MemoryBlockFlags::Used) )
+        ASSERT( pool->freeLists[fl][sl] == block );
+        pool->freeLists[fl][sl] = block->nextFree;
+
+        if( !block->nextFree )
         {
-            result = block;
-            break;
+            pool->slBitmaps[fl] &= ~(1u << sl);
+            if( !pool->slBitmaps[fl] )
+                pool->flBitmap &= ~(1u << fl);
         }
     }
+    if( block->nextFree )
+        block->nextFree->prevFree = block->prevFree;
 
-    return result;
+    pool->freeSize -= block->size;
+}
+
+// Regions don't need to be contiguous with each other
+inline MemoryBlock*
+AddPoolRegion( MemoryPool* pool, void* memory, sz size )
+{
+    ASSERT( Align( memory, MEMORY_POOL_ALIGNMENT ) == memory );
+    size &= ~(sz)(MEMORY_POOL_ALIGNMENT - 1);
+    ASSERT( size > MEMORY_POOL_MIN_BLOCK_SIZE );
+
+    // Insert a single free block with the whole memory chunk
+    MemoryBlock* block = (MemoryBlock*)memory;
+    block->prevPhysical = nullptr;
+    block->size = size - sizeof(MemoryBlock);
+    block->flags = MemoryBlockFlags::Last;
+    InsertFreeBlock( pool, block );
+
+    pool->size += size;
+    return block;
+}
+
+// The opposite of the above. The region must be completely free
+inline void
+RemovePoolRegion( MemoryPool* pool, MemoryBlock* block )
+{
+    ASSERT( !block->prevPhysical && (block->flags & MemoryBlockFlags::Last) && !(block->flags & MemoryBlockFlags::Used) );
+    RemoveFreeBlock( pool, block );
+    pool->size -= sizeof(MemoryBlock) + block->size;
+}
+
+inline void
+InitMemoryPool( MemoryPool* pool, MemoryArena* arena, sz size, bool untracked = false )
+{
+    *pool = {};
+    pool->untracked = untracked;
+
+    // NOTE Blocks are tracked individually as they're used
+    // Not cleared either, as blocks are recycled anyway (so a big pool doesn't touch any pages until they're used)
+    MemoryParams params = Untracked( Aligned( MEMORY_POOL_ALIGNMENT ) );
+    params.flags &= ~MemoryFlags_ClearToZero;
+    void* memory = PUSH_SIZE( arena, size, params );
+    AddPoolRegion( pool, memory, size );
 }
 
+// Returns null when there's no free block big enough
 inline void*
-UseBlock( MemoryBlock* block, sz size, sz splitThreshold )
+AllocateFromPool( MemoryPool* pool, sz size, MemoryTag const& tag = MemoryTag::Untagged() )
 {
-    ASSERT( size <= block->size );
+    size = Align( Max( size, (sz)MEMORY_POOL_ALIGNMENT ), MEMORY_POOL_ALIGNMENT );
 
-    block->flags |= MemoryBlockFlags::Used;
-    void* result = (block + 1);
+    // Round up to the next bin, so that any block found there is guaranteed to fit
+    sz searchSize = size;
+    if( size >= MEMORY_POOL_SMALL_BLOCK_SIZE )
+        searchSize += ((sz)1 << (FindMostSignificantSetBit( size ) - MEMORY_POOL_SL_COUNT_LOG2)) - 1;
 
-    sz remainingSize = block->size - size;
-    if( remainingSize > splitThreshold )
+    u32 fl, sl;
+    MapBlockSize( searchSize, &fl, &sl );
+    if( fl >= MEMORY_POOL_FL_COUNT )
+        return nullptr;
+
+    u32 slBitmap = pool->slBitmaps[fl] & (~0u << sl);
+    if( !slBitmap )
     {
-        block->size -= remainingSize;
-        InsertBlock( block, remainingSize, (u8*)result + size );
+        u32 flBitmap = fl + 1 < 32 ? pool->flBitmap & (~0u << (fl + 1)) : 0;
+        if( !flBitmap )
+            return nullptr;
+
+        fl = FindLeastSignificantSetBit( flBitmap );
+        slBitmap = pool->slBitmaps[fl];
     }
-    else
+    sl = FindLeastSignificantSetBit( slBitmap );
+
+    MemoryBlock* block = pool->freeLists[fl][sl];
+    ASSERT( block && block->size >= size );
+    RemoveFreeBlock( pool, block );
+
+    // Split off the remaining space as a new free block if it's worth it
+    sz remainingSize = block->size - size;
+    if( remainingSize >= MEMORY_POOL_MIN_BLOCK_SIZE )
     {
-        // TODO Record the unused portion so that it can be merged with neighbours
+        block->size = size;
+
+        MemoryBlock* remaining = (MemoryBlock*)((u8*)(block + 1) + size);
+        remaining->prevPhysical = block;
+        remaining->size = remainingSize - sizeof(MemoryBlock);
+        remaining->flags = block->flags & MemoryBlockFlags::Last;
+        if( !(remaining->flags & MemoryBlockFlags::Last) )
+            NextPhysicalBlock( remaining )->prevPhysical = remaining;
+        block->flags &= ~MemoryBlockFlags::Last;
+
+        InsertFreeBlock( pool, remaining );
     }
 
-    return result;
+    block->flags |= MemoryBlockFlags::Used;
+    pool->usedBlockCount++;
+
+#if !RELEASE
+    block->tag = tag.index;
+    block->usedSize = pool->untracked ? 0 : block->size;
+    if( block->usedSize )
+        DEBUGTrackAllocation( block->tag, block->usedSize );
+#endif
+
+    return block + 1;
 }
 
-inline bool
-MergeIfPossible( MemoryBlock* first, MemoryBlock* second, MemoryBlock* sentinel )
+// Merges the second block into the first one. Both need to be free and out of the free lists
+inline void
+MergeBlocks( MemoryBlock* first, MemoryBlock* second )
 {
-    bool result = false;
+    ASSERT( NextPhysicalBlock( first ) == second );
 
-    if( first != sentinel && second != sentinel &&
-        !(first->flags & MemoryBlockFlags::Used) &&
-        !(second->flags & MemoryBlockFlags::Used) )
-    {
-        // This check only needed so we can support discontiguous memory pools if needed
-        u8* expectedOffset = (u8*)first + sizeof(MemoryBlock) + first->size;
-        if( (u8*)second == expectedOffset )
-        {
-            second->next->prev = second->prev;
-            second->prev->next = second->next;
+    first->size += sizeof(MemoryBlock) + second->size;
+    first->flags |= second->flags & MemoryBlockFlags::Last;
+    if( !(first->flags & MemoryBlockFlags::Last) )
+        NextPhysicalBlock( first )->prevPhysical = first;
+}
 
-            first->size += sizeof(MemoryBlock) + second->size;
+// Returns the resulting free block after merging
+inline MemoryBlock*
+ReleaseToPool( MemoryPool* pool, void* memory )
+{
+    MemoryBlock* block = (MemoryBlock*)memory - 1;
+    ASSERT( block->flags & MemoryBlockFlags::Used );
+    block->flags &= ~MemoryBlockFlags::Used;
+    pool->usedBlockCount--;
+#if !RELEASE
+    if( block->usedSize )
+        DEBUGTrackFree( block->tag, block->usedSize );
+#endif
 
-            result = true;
+    if( !(block->flags & MemoryBlockFlags::Last) )
+    {
+        MemoryBlock* next = NextPhysicalBlock( block );
+        if( !(next->flags & MemoryBlockFlags::Used) )
+        {
+            RemoveFreeBlock( pool, next );
+            MergeBlocks( block, next );
         }
     }
+    MemoryBlock* prev = block->prevPhysical;
+    if( prev && !(prev->flags & MemoryBlockFlags::Used) )
+    {
+        RemoveFreeBlock( pool, prev );
+        MergeBlocks( prev, block );
+        block = prev;
+    }
 
-    return result;
+    InsertFreeBlock( pool, block );
+    return block;
 }
 
-// TODO Abstract the sentinel inside a 'MemoryPool' struct and put a pointer to that in the block
-// so that we don't need to pass the sentinel, and we can remove the 'ownerPool' idea from the meshes
-inline void
-ReleaseBlockAt( void* memory, MemoryBlock* sentinel )
+// Size of the biggest allocation that would currently succeed (roughly)
+inline sz
+LargestFreeBlockSize( MemoryPool const& pool )
 {
-    MemoryBlock* block = (MemoryBlock*)memory - 1;
-    block->flags &= ~MemoryBlockFlags::Used;
+    sz result = 0;
+    if( pool.flBitmap )
+    {
+        u32 fl = FindMostSignificantSetBit( pool.flBitmap );
+        u32 sl = FindMostSignificantSetBit( pool.slBitmaps[fl] );
 
-    MergeIfPossible( block, block->next, sentinel );
-    MergeIfPossible( block->prev, block, sentinel );
+        for( MemoryBlock* block = pool.freeLists[fl][sl]; block; block = block->nextFree )
+            result = Max( result, block->size );
+    }
+    return result;
 }
 
 #endif /* __MEMORY_H__ */
@@ -69,7 +69,177 @@ CreateMeshFromFQSBuffers( Array<FQSVertex> const& vertices, Array<FQSTriangle> c
     return result;
 }
 
-IsoSurfaceSamplingCache InitSurfaceSamplingCache( MemoryArena* arena, v2i const& cellsPerAxis )
+IsoSurfaceBatch InitIsoSurfaceBatch( MemoryArena* arena, int capacity, MemoryParams params /*= DefaultMemoryParams()*/ )
+{
+    IsoSurfaceBatch result = {};
+    result.capacity = capacity;
+
+    int paddedCapacity = (int)Align( capacity, LaneWidth );
+    result.x = PUSH_ARRAY( arena, f32, paddedCapacity, params );
+    result.y = PUSH_ARRAY( arena, f32, paddedCapacity, params );
+    result.z = PUSH_ARRAY( arena, f32, paddedCapacity, params );
+    result.results = PUSH_ARRAY( arena, f32, paddedCapacity, params );
+
+    return result;
+}
+
+INLINE void
+AddBatchPoint( IsoSurfaceBatch* batch, v3 const& p )
+{
+    ASSERT( batch->count < batch->capacity );
+
+    batch->x[batch->count] = p.x;
+    batch->y[batch->count] = p.y;
+    batch->z[batch->count] = p.z;
+    batch->count++;
+}
+
+void SampleBatch( IsoSurfaceBatchFunc* sampleBatchFunc, IsoSurfaceBatch* batch, SamplingData const* samplingData )
+{
+    ASSERT( batch->count > 0 );
+
+    // Replicate the last point in the unused lanes so they always contain sane values
+    int last = batch->count - 1;
+    int paddedCount = (int)Align( batch->count, LaneWidth );
+    for( int i = batch->count; i < paddedCount; ++i )
+    {
+        batch->x[i] = batch->x[last];
+        batch->y[i] = batch->y[last];
+        batch->z[i] = batch->z[last];
+    }
+
+    sampleBatchFunc( batch, samplingData );
+}
+
+// Size (in samples per side) of the biggest blocks we try to cull, and of the smallest ones we subdivide them into
+const int MaxCullBlockSamples = 32;
+const int MinCullBlockSamples = 4;
+
+// Quadtree pass over a block of samples in a layer: samples in blocks that can't be anywhere near the surface get a
+// value with the right sign, and samples that still need to be taken are left at zero (which a fill never is).
+// Each block is grown by one cell in all directions before testing it, so no edge touching a filled sample can cross
+// the surface, and filled values are only ever used for their sign.
+internal void
+CullLayerBlock( f32* layerSamples, int samplesPerRow, v2i const& blockMin, v2i const& blockSize, v3 const& firstSampleP,
+                f32 cellSizeMeters, IsoSurfaceRangeFunc* rangeFunc, SamplingData const* samplingData )
+{
+    v3 minP = firstSampleP + V3( (f32)blockMin.x - 1.f, (f32)blockMin.y - 1.f, -1.f ) * cellSizeMeters;
+    v3 maxP = firstSampleP + V3( (f32)(blockMin.x + blockSize.x), (f32)(blockMin.y + blockSize.y), 1.f ) * cellSizeMeters;
+    interval range = rangeFunc( AABBMinMax( minP, maxP ), samplingData );
+
+    // Leave some margin for rounding differences with the actual samples
+    const f32 epsilon = cellSizeMeters * 0.01f;
+    f32 fill = 0.f;
+    if( range.min > epsilon )
+        fill = range.min;
+    else if( range.max < -epsilon )
+        fill = range.max;
+
+    if( fill != 0.f || (blockSize.x <= MinCullBlockSamples && blockSize.y <= MinCullBlockSamples) )
+    {
+        for( int j = blockMin.y; j < blockMin.y + blockSize.y; ++j )
+        {
+            f32* sample = layerSamples + j * samplesPerRow + blockMin.x;
+            for( int i = 0; i < blockSize.x; ++i )
+                *sample++ = fill;
+        }
+        return;
+    }
+
+    v2i childSize = { blockSize.x > MinCullBlockSamples ? blockSize.x / 2 : blockSize.x,
+                      blockSize.y > MinCullBlockSamples ? blockSize.y / 2 : blockSize.y };
+    for( int y = 0; y < blockSize.y; y += childSize.y )
+        for( int x = 0; x < blockSize.x; x += childSize.x )
+        {
+            v2i size = { Min( childSize.x, blockSize.x - x ), Min( childSize.y, blockSize.y - y ) };
+            CullLayerBlock( layerSamples, samplesPerRow, blockMin + V2i( x, y ), size, firstSampleP, cellSizeMeters,
+                            rangeFunc, samplingData );
+        }
+}
+
+// Find which samples in a layer actually need to be taken, so sampling and contouring scale with the surface area
+// instead of the volume
+internal void
+CullLayerSamples( f32* layerSamples, v2i const& samplesPerAxis, v3 const& firstSampleP, f32 cellSizeMeters,
+                  IsoSurfaceRangeFunc* rangeFunc, SamplingData const* samplingData )
+{
+    TIMED_FUNC;
+
+    for( int y = 0; y < samplesPerAxis.y; y += MaxCullBlockSamples )
+        for( int x = 0; x < samplesPerAxis.x; x += MaxCullBlockSamples )
+        {
+            v2i size = { Min( MaxCullBlockSamples, samplesPerAxis.x - x ), Min( MaxCullBlockSamples, samplesPerAxis.y - y ) };
+            CullLayerBlock( layerSamples, samplesPerAxis.x, V2i( x, y ), size, firstSampleP, cellSizeMeters,
+                            rangeFunc, samplingData );
+        }
+}
+
+// Sample all points in the batch, which are expected to be those in the row that weren't culled (if culling),
+// and store the results at their place in the row
+internal void
+SampleRow( f32* rowSamples, int sampleCount, bool culled, IsoSurfaceBatchFunc* sampleBatchFunc, IsoSurfaceBatch* batch,
+           SamplingData const* samplingData )
+{
+    if( batch->count == 0 )
+        return;
+    SampleBatch( sampleBatchFunc, batch, samplingData );
+
+    if( !culled )
+        PCOPY( batch->results, rowSamples, sampleCount * sizeof(f32) );
+    else
+    {
+        f32 const* result = batch->results;
+        for( int i = 0; i < sampleCount; ++i )
+        {
+            if( rowSamples[i] == 0.f )
+                rowSamples[i] = *result++;
+        }
+    }
+}
+
+// Slabs contoured in parallel need their own copy, as sampling changes it
+internal SamplingData*
+CopySamplingData( SamplingData const* samplingData, MemoryArena* arena, MemoryParams params )
+{
+    sz size = 0;
+    switch( samplingData->type )
+    {
+        case SamplingDataType::ClusterData:     size = sizeof(ClusterSamplingData); break;
+        case SamplingDataType::SimpleSurface:   size = sizeof(SimpleSurfaceData); break;
+        case SamplingDataType::SDFProgramData:  size = sizeof(SDFProgramSamplingData); break;
+        INVALID_DEFAULT_CASE
+    }
+
+    SamplingData* result = (SamplingData*)PUSH_SIZE( arena, size, params );
+    PCOPY( samplingData, result, size );
+    return result;
+}
+
+// Slabs contoured in parallel need to keep their output until all of them are done, so they can be stitched in order.
+// They contour into their scratch memory, then copy just what they produced to a shared arena.
+struct SlabOutputArena
+{
+    MemoryArena* arena;
+    TicketMutex mutex;
+};
+
+internal void
+CopySlabOutput( BucketArray<TexturedVertex> const& vertices, BucketArray<i32> const& indices, SlabOutputArena* output,
+                Array<TexturedVertex>* outVertices, Array<i32>* outIndices )
+{
+    MemoryParams params = Temporary();
+    params.flags &= ~MemoryFlags_ClearToZero;
+
+    BeginTicketMutex( &output->mutex );
+    INIT( outVertices ) Array<TexturedVertex>( output->arena, vertices.count, params );
+    INIT( outIndices ) Array<i32>( output->arena, indices.count, params );
+    EndTicketMutex( &output->mutex );
+
+    vertices.CopyTo( outVertices );
+    indices.CopyTo( outIndices );
+}
+
+IsoSurfaceSamplingCache InitSurfaceSamplingCache( MemoryArena* arena, v2i const& cellsPerAxis, MemoryParams params /*= DefaultMemoryParams()*/ )
 {
     IsoSurfaceSamplingCache result;
     result.cellsPerAxis = cellsPerAxis;
@@ -78,12 +248,17 @@ IsoSurfaceSamplingCache InitSurfaceSamplingCache( MemoryArena* arena, v2i const&
     // which simplifies the algorithm by eliminating "edge" cases ¬¬
     v2i stepsPerAxis = cellsPerAxis + V2iOne;
     int layerCellCount = stepsPerAxis.x * stepsPerAxis.y;
-
-    result.bottomLayerSamples = PUSH_ARRAY( arena, f32, layerCellCount );
-    result.topLayerSamples = PUSH_ARRAY( arena, f32, layerCellCount );
-    result.bottomLayerVertexIndices = PUSH_ARRAY( arena, i32, layerCellCount * 2 );
-    result.middleLayerVertexIndices = PUSH_ARRAY( arena, i32, layerCellCount );
-    result.topLayerVertexIndices = PUSH_ARRAY( arena, i32, layerCellCount * 2 );
+    int rowCapacity = (int)Align( cellsPerAxis.x, LaneWidth );
+
+    // Case indices are computed a whole lane at a time, so the last one in the layer can read a bit past the end
+    result.bottomLayerSamples = PUSH_ARRAY( arena, f32, layerCellCount + LaneWidth, params );
+    result.topLayerSamples = PUSH_ARRAY( arena, f32, layerCellCount + LaneWidth, params );
+    result.bottomLayerVertexIndices = PUSH_ARRAY( arena, i32, layerCellCount * 2, params );
+    result.middleLayerVertexIndices = PUSH_ARRAY( arena, i32, layerCellCount, params );
+    result.topLayerVertexIndices = PUSH_ARRAY( arena, i32, layerCellCount * 2, params );
+    result.rowBatch = InitIsoSurfaceBatch( arena, stepsPerAxis.x, params );
+    result.rowCaseIndices = PUSH_ARRAY( arena, i32, rowCapacity, params );
+    result.rowActiveCells = PUSH_ARRAY( arena, i32, rowCapacity, params );
 
     return result;
 }
@@ -114,22 +289,60 @@ void SwapTopAndBottomLayers( IsoSurfaceSamplingCache* samplingCache )
 }
 
 
-void InitMeshPool( MeshPool* pool, MemoryArena* arena, sz size )
+// Size of the regions each MeshPool takes from the heap at once (unless a single mesh needs more)
+#define MESH_POOL_REGION_SIZE MEGABYTES(32)
+
+void InitMeshHeap( MeshHeap* heap, MemoryArena* arena, sz size )
+{
+    // Meshes are tracked by the pools using the memory
+    InitMemoryPool( &heap->memoryPool, arena, size, true );
+    heap->mutex = {};
+}
+
+void InitMeshPool( MeshPool* pool, MeshHeap* heap, MemoryArena* arena )
 {
     // TODO Measure whether it's faster to just have a really big contiguous array for these
     INIT( &pool->scratchVertices ) BucketArray<TexturedVertex>( arena, 1024 );
     INIT( &pool->scratchIndices ) BucketArray<i32>( arena, 1024 );
 
-    // Initialize empty sentinel
-    pool->memorySentinel.prev = &pool->memorySentinel;
-    pool->memorySentinel.next = &pool->memorySentinel;
-    pool->memorySentinel.size = 0;
-    pool->memorySentinel.flags = MemoryBlockFlags::None;
+    // Regions are only taken from the heap as needed
+    pool->heap = heap;
+    pool->memoryPool = {};
+    pool->regionCount = 0;
+    pool->meshCount = 0;
+    pool->remoteFrees = nullptr;
+}
 
-    // Insert empty block with the whole memory chunk
-    InsertBlock( &pool->memorySentinel, size, PUSH_SIZE( arena, size ) );
+internal void
+ReleaseMeshMemory( MeshPool* pool, Mesh* mesh )
+{
+    MemoryBlock* freeBlock = ReleaseToPool( &pool->memoryPool, mesh );
+    pool->meshCount--;
 
-    pool->meshCount = 0;
+    // Give completely free regions back to the heap so other threads can use them (but always keep one around)
+    if( !freeBlock->prevPhysical && (freeBlock->flags & MemoryBlockFlags::Last) && pool->regionCount > 1 )
+    {
+        RemovePoolRegion( &pool->memoryPool, freeBlock );
+        pool->regionCount--;
+
+        BeginTicketMutex( &pool->heap->mutex );
+        ReleaseToPool( &pool->heap->memoryPool, freeBlock );
+        EndTicketMutex( &pool->heap->mutex );
+    }
+}
+
+void ReclaimRemoteFrees( MeshPool* pool )
+{
+    if( !pool->remoteFrees )
+        return;
+
+    Mesh* mesh = (Mesh*)AtomicExchange( (volatile u64*)&pool->remoteFrees, 0ull );
+    while( mesh )
+    {
+        Mesh* next = *(Mesh**)mesh;
+        ReleaseMeshMemory( pool, mesh );
+        mesh = next;
+    }
 }
 
 void ClearScratchBuffers( MeshPool* pool )
@@ -138,21 +351,36 @@ void ClearScratchBuffers( MeshPool* pool )
     pool->scratchIndices.Clear();
 }
 
+// Returns null (and logs an error) when the mesh heap has no room left for it
 Mesh* AllocateMesh( MeshPool* pool, int vertexCount, int indexCount )
 {
     sz vertexSize = sizeof(TexturedVertex) * vertexCount;
     sz indexSize = sizeof(i32) * indexCount;
     sz totalMeshSize = sizeof(Mesh) + vertexSize + indexSize;
 
-    Mesh* result = nullptr;
-    // FIXME This is wrong. Not accounting for the size of the MemoryBlock struct (which we shouldn't have to do anyway!)
-    MemoryBlock* block = FindBlockForSize( &pool->memorySentinel, totalMeshSize );
-    if( block )
+    ReclaimRemoteFrees( pool );
+
+    Mesh* result = (Mesh*)AllocateFromPool( &pool->memoryPool, totalMeshSize, MemoryTag::Meshes() );
+    if( !result )
     {
-        // TODO Tune this based on the smallest mesh size we will typically have
-        const sz blockSplitThreshold = 4096;
-        result = (Mesh*)UseBlock( block, totalMeshSize, blockSplitThreshold );
+        // Take a new region from the heap, big enough for this mesh even after rounding up to its size class
+        sz regionSize = Max( (sz)MESH_POOL_REGION_SIZE, totalMeshSize + totalMeshSize / 8 + 2 * sizeof(MemoryBlock) );
+
+        BeginTicketMutex( &pool->heap->mutex );
+        void* region = AllocateFromPool( &pool->heap->memoryPool, regionSize );
+        EndTicketMutex( &pool->heap->mutex );
+
+        if( region )
+        {
+            AddPoolRegion( &pool->memoryPool, region, regionSize );
+            pool->regionCount++;
+
+            result = (Mesh*)AllocateFromPool( &pool->memoryPool, totalMeshSize, MemoryTag::Meshes() );
+        }
+    }
 
+    if( result )
+    {
         u8* vertexData = (u8*)result + sizeof(Mesh);
         u8* indexData = vertexData + vertexSize;
 
@@ -167,7 +395,7 @@ Mesh* AllocateMesh( MeshPool* pool, int vertexCount, int indexCount )
     {
         // TODO Here we could evict meshes in a loop based on LRU
         // until we free the amount we need
-        INVALID_CODE_PATH
+        LOG( "ERROR :: Mesh heap is full (no room for a mesh with %d vertices, %d indices)", vertexCount, indexCount );
     }
 
     return result;
@@ -177,6 +405,8 @@ Mesh* AllocateMeshFromScratchBuffers( MeshPool* pool )
 {
     Mesh* result = AllocateMesh( pool, pool->scratchVertices.count,
                                  pool->scratchIndices.count );
+    if( !result )
+        return nullptr;
 
     pool->scratchVertices.CopyTo( &result->vertices );
     pool->scratchIndices.CopyTo( &result->indices );
@@ -184,12 +414,26 @@ Mesh* AllocateMeshFromScratchBuffers( MeshPool* pool )
     return result;
 }
 
-void ReleaseMesh( Mesh** mesh )
+// Meshes released by a thread other than the one that allocated them are just queued for their owner to reclaim
+void ReleaseMesh( Mesh** mesh, MeshPool* callerPool )
 {
-    // TODO Move the sentinel in MeshPool to a 'parent' MemoryPool and add a reference to that
-    // in the MemoryBlock so we can remove the ownerPool thing!
-    ReleaseBlockAt( *mesh, &(*mesh)->ownerPool->memorySentinel );
-    (*mesh)->ownerPool->meshCount--;
+    MeshPool* ownerPool = (*mesh)->ownerPool;
+
+    if( ownerPool == callerPool )
+        ReleaseMeshMemory( ownerPool, *mesh );
+    else
+    {
+        // Reuse the (now dead) mesh memory as the link
+        Mesh** next = (Mesh**)*mesh;
+        u64 head;
+        do
+        {
+            head = (u64)ownerPool->remoteFrees;
+            *next = (Mesh*)head;
+        }
+        while( AtomicCompareExchange( (volatile u64*)&ownerPool->remoteFrees, (u64)*mesh, head ) != head );
+    }
+
     *mesh = nullptr;
 }
 
@@ -197,6 +441,13 @@ void ReleaseMesh( Mesh** mesh )
 
 ///// QUADRATIC ERROR FUNCTIONS /////
 
+// NOTE GCC/Clang expose vector lanes through the subscript operator directly
+#if _MSC_VER
+#define M128_F32(v) (v).m128_f32
+#else
+#define M128_F32(v) (v)
+#endif
+
 union Mat4x4
 {
     float	m[4][4];
@@ -231,9 +482,9 @@ static INLINE __m128 vec4_mul_m4x4(const __m128& a, const Mat4x4& B)
 
 static void givens_coeffs_sym(__m128& c_result, __m128& s_result, const Mat4x4& vtav, const int a, const int b)
 {
-	__m128 simd_pp = _mm_set_ps( 0.f, vtav.row[a].m128_f32[a], vtav.row[a].m128_f32[a], vtav.row[a].m128_f32[a] );
-	__m128 simd_pq = _mm_set_ps( 0.f, vtav.row[a].m128_f32[b], vtav.row[a].m128_f32[b], vtav.row[a].m128_f32[b] );
-	__m128 simd_qq = _mm_set_ps( 0.f, vtav.row[b].m128_f32[b], vtav.row[b].m128_f32[b], vtav.row[b].m128_f32[b] );
+	__m128 simd_pp = _mm_set_ps( 0.f, M128_F32(vtav.row[a])[a], M128_F32(vtav.row[a])[a], M128_F32(vtav.row[a])[a] );
+	__m128 simd_pq = _mm_set_ps( 0.f, M128_F32(vtav.row[a])[b], M128_F32(vtav.row[a])[b], M128_F32(vtav.row[a])[b] );
+	__m128 simd_qq = _mm_set_ps( 0.f, M128_F32(vtav.row[b])[b], M128_F32(vtav.row[b])[b], M128_F32(vtav.row[b])[b] );
 
 	static const __m128 zeros = _mm_set1_ps(0.f);
 	static const __m128 ones  = _mm_set1_ps(1.f);
@@ -280,9 +531,9 @@ static void givens_coeffs_sym(__m128& c_result, __m128& s_result, const Mat4x4&
 
 static void rotateq_xy(Mat4x4& vtav, const __m128& c, const __m128& s, const int a, const int b)
 {
-	__m128 u = _mm_set_ps( 0.f, vtav.row[a].m128_f32[a], vtav.row[a].m128_f32[a], vtav.row[a].m128_f32[a] );
-	__m128 v = _mm_set_ps( 0.f, vtav.row[b].m128_f32[b], vtav.row[b].m128_f32[b], vtav.row[b].m128_f32[b] );
-	__m128 A = _mm_set_ps( 0.f, vtav.row[a].m128_f32[b], vtav.row[a].m128_f32[b], vtav.row[a].m128_f32[b] );
+	__m128 u = _mm_set_ps( 0.f, M128_F32(vtav.row[a])[a], M128_F32(vtav.row[a])[a], M128_F32(vtav.row[a])[a] );
+	__m128 v = _mm_set_ps( 0.f, M128_F32(vtav.row[b])[b], M128_F32(vtav.row[b])[b], M128_F32(vtav.row[b])[b] );
+	__m128 A = _mm_set_ps( 0.f, M128_F32(vtav.row[a])[b], M128_F32(vtav.row[a])[b], M128_F32(vtav.row[a])[b] );
 
 	static const __m128 twos = _mm_set1_ps(2.f);
 
@@ -306,14 +557,14 @@ static void rotateq_xy(Mat4x4& vtav, const __m128& c, const __m128& s, const int
 	__m128 y2 = _mm_mul_ps(cc, v);
 	__m128 y  = _mm_add_ps(y1, y2);
 
-	vtav.row[a].m128_f32[a] = x.m128_f32[0];
-	vtav.row[b].m128_f32[b] = y.m128_f32[0];
+	M128_F32(vtav.row[a])[a] = M128_F32(x)[0];
+	M128_F32(vtav.row[b])[b] = M128_F32(y)[0];
 }
 
 static void rotate_xy(Mat4x4& vtav, Mat4x4& v, float c, float s, const int a, const int b) 
 {
-    __m128 simd_u = _mm_set_ps( vtav.row[0].m128_f32[3-b], v.row[2].m128_f32[a], v.row[1].m128_f32[a], v.row[0].m128_f32[a] );
-	__m128 simd_v = _mm_set_ps( vtav.row[1-a].m128_f32[2], v.row[2].m128_f32[b], v.row[1].m128_f32[b], v.row[0].m128_f32[b] );
+    __m128 simd_u = _mm_set_ps( M128_F32(vtav.row[0])[3-b], M128_F32(v.row[2])[a], M128_F32(v.row[1])[a], M128_F32(v.row[0])[a] );
+	__m128 simd_v = _mm_set_ps( M128_F32(vtav.row[1-a])[2], M128_F32(v.row[2])[b], M128_F32(v.row[1])[b], M128_F32(v.row[0])[b] );
 
 	__m128 simd_c = _mm_load1_ps(&c);
 	__m128 simd_s = _mm_load1_ps(&s);
@@ -326,17 +577,17 @@ static void rotate_xy(Mat4x4& vtav, Mat4x4& v, float c, float s, const int a, co
 	__m128 y1 = _mm_mul_ps(simd_c, simd_v);
 	__m128 y = _mm_add_ps(y0, y1);
 
-	v.row[0].m128_f32[a] = x.m128_f32[0];
-	v.row[1].m128_f32[a] = x.m128_f32[1];
-	v.row[2].m128_f32[a] = x.m128_f32[2];
-	vtav.row[0].m128_f32[3-b] = x.m128_f32[3];
+	M128_F32(v.row[0])[a] = M128_F32(x)[0];
+	M128_F32(v.row[1])[a] = M128_F32(x)[1];
+	M128_F32(v.row[2])[a] = M128_F32(x)[2];
+	M128_F32(vtav.row[0])[3-b] = M128_F32(x)[3];
 
-	v.row[0].m128_f32[b] = y.m128_f32[0];
-	v.row[1].m128_f32[b] = y.m128_f32[1];
-	v.row[2].m128_f32[b] = y.m128_f32[2];
-	vtav.row[1-a].m128_f32[2] = y.m128_f32[3];
+	M128_F32(v.row[0])[b] = M128_F32(y)[0];
+	M128_F32(v.row[1])[b] = M128_F32(y)[1];
+	M128_F32(v.row[2])[b] = M128_F32(y)[2];
+	M128_F32(vtav.row[1-a])[2] = M128_F32(y)[3];
 
-	vtav.row[a].m128_f32[b] = 0.f;
+	M128_F32(vtav.row[a])[b] = 0.f;
 }
 
 
@@ -372,7 +623,7 @@ __m128 QEFMinimizePlanesClassic( const __m128* positions, const __m128* normals,
 		pointaccum = _mm_add_ps( pointaccum, p );
 	}
 
-	__declspec(align(16)) float x[4];
+	alignas(16) float x[4];
 	_mm_store_ps( x, ATb );
 	_mm_set_ps( 0.f, x[2], x[1], x[0] );
 
@@ -395,32 +646,32 @@ __m128 QEFMinimizePlanesClassic( const __m128* positions, const __m128* normals,
 	{
 		__m128 c, s;
 
-		if( ATA.row[0].m128_f32[1] != 0.f )
+		if( M128_F32(ATA.row[0])[1] != 0.f )
 		{
 			givens_coeffs_sym( c, s, ATA, 0, 1 );
 			rotateq_xy( ATA, c, s, 0, 1 );
-			rotate_xy( ATA, V, c.m128_f32[1], s.m128_f32[1], 0, 1 );
-			ATA.row[0].m128_f32[1] = 0.f;
+			rotate_xy( ATA, V, M128_F32(c)[1], M128_F32(s)[1], 0, 1 );
+			M128_F32(ATA.row[0])[1] = 0.f;
 		}
 
-		if( ATA.row[0].m128_f32[2] != 0.f )
+		if( M128_F32(ATA.row[0])[2] != 0.f )
 		{
 			givens_coeffs_sym( c, s, ATA, 0, 2 );
 			rotateq_xy( ATA, c, s, 0, 2 );
-			rotate_xy( ATA, V, c.m128_f32[1], s.m128_f32[1], 0, 2 );
-			ATA.row[0].m128_f32[2] = 0.f;
+			rotate_xy( ATA, V, M128_F32(c)[1], M128_F32(s)[1], 0, 2 );
+			M128_F32(ATA.row[0])[2] = 0.f;
 		}
 
-		if( ATA.row[1].m128_f32[2] != 0.f )
+		if( M128_F32(ATA.row[1])[2] != 0.f )
 		{
 			givens_coeffs_sym( c, s, ATA, 1, 2 );
 			rotateq_xy( ATA, c, s, 1, 2 );
-			rotate_xy( ATA, V, c.m128_f32[2], s.m128_f32[2], 1, 2 );
-			ATA.row[1].m128_f32[2] = 0.f;
+			rotate_xy( ATA, V, M128_F32(c)[2], M128_F32(s)[2], 1, 2 );
+			M128_F32(ATA.row[1])[2] = 0.f;
 		}
 	}
 
-	__m128 sigma = _mm_set_ps( 0.f, ATA.row[2].m128_f32[2], ATA.row[1].m128_f32[1], ATA.row[0].m128_f32[0] );
+	__m128 sigma = _mm_set_ps( 0.f, M128_F32(ATA.row[2])[2], M128_F32(ATA.row[1])[1], M128_F32(ATA.row[0])[0] );
 
 	// A = UEV^T; U = A / (E*V^T)
 	static const __m128 ones = _mm_set1_ps( 1.f );
@@ -439,17 +690,17 @@ __m128 QEFMinimizePlanesClassic( const __m128* positions, const __m128* normals,
 	m.row[2] = _mm_mul_ps( V.row[2], invdet );
 
 	Mat4x4 Vinv = {};
-	Vinv.row[0].m128_f32[0] = vec4_dot( m.row[0], V.row[0] );
-	Vinv.row[0].m128_f32[1] = vec4_dot( m.row[1], V.row[0] );
-	Vinv.row[0].m128_f32[2] = vec4_dot( m.row[2], V.row[0] );
+	M128_F32(Vinv.row[0])[0] = vec4_dot( m.row[0], V.row[0] );
+	M128_F32(Vinv.row[0])[1] = vec4_dot( m.row[1], V.row[0] );
+	M128_F32(Vinv.row[0])[2] = vec4_dot( m.row[2], V.row[0] );
 
-	Vinv.row[1].m128_f32[0] = vec4_dot( m.row[0], V.row[1] );
-	Vinv.row[1].m128_f32[1] = vec4_dot( m.row[1], V.row[1] );
-	Vinv.row[1].m128_f32[2] = vec4_dot( m.row[2], V.row[1] );
+	M128_F32(Vinv.row[1])[0] = vec4_dot( m.row[0], V.row[1] );
+	M128_F32(Vinv.row[1])[1] = vec4_dot( m.row[1], V.row[1] );
+	M128_F32(Vinv.row[1])[2] = vec4_dot( m.row[2], V.row[1] );
 
-	Vinv.row[2].m128_f32[0] = vec4_dot( m.row[0], V.row[2] );
-	Vinv.row[2].m128_f32[1] = vec4_dot( m.row[1], V.row[2] );
-	Vinv.row[2].m128_f32[2] = vec4_dot( m.row[2], V.row[2] );
+	M128_F32(Vinv.row[2])[0] = vec4_dot( m.row[0], V.row[2] );
+	M128_F32(Vinv.row[2])[1] = vec4_dot( m.row[1], V.row[2] );
+	M128_F32(Vinv.row[2])[2] = vec4_dot( m.row[2], V.row[2] );
 
 	__m128 result = vec4_mul_m4x4( p, Vinv );
 
@@ -486,9 +737,9 @@ v3 QEFMinimizePlanesClassic( v3 const* positions, v3 const* normals, int count,
 
 	v3 result =
 	{
-		solved.m128_f32[0],
-		solved.m128_f32[1],
-		solved.m128_f32[2],
+		M128_F32(solved)[0],
+		M128_F32(solved)[1],
+		M128_F32(solved)[2],
 	};
 	return result;
 }
@@ -681,38 +932,15 @@ namespace
     extern int triangleTable[][16];
 }
 
-void MarchCube( const v3& cellCornerWorldP, const v2i& gridCellP, v2i const& cellsPerAxis, f32 cellSizeMeters,
-                IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices,
-                const bool interpolate /*= true*/ )
+// Emits the triangles for a cell crossing the surface, given its case index and 8 corner samples
+internal void
+MarchActiveCube( int caseIndex, f32 const* cornerSamples, const v3& cellCornerWorldP, const v2i& gridCellP, v2i const& cellsPerAxis,
+                 f32 cellSizeMeters, IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices,
+                 BucketArray<i32>* indices, const bool interpolate )
 {
-    TIMED_FUNC;
-
     // Cache layers contain one sample per _edge_
     v2i layerStepsPerAxis = cellsPerAxis + V2iOne;
 
-    // Construct case mask from 8 corner samples
-    int caseIndex = 0;
-    f32 cornerSamples[8];
-    for( int i = 0; i < 8; ++i )
-    {
-        v3i cornerOffset = cornerOffsets[i];
-        v3i layerP = V3i( gridCellP ) + cornerOffset;
-        int layerOffset = layerP.y * layerStepsPerAxis.x + layerP.x;
-
-        f32 sample = cornerOffset.z
-            ? samplingCache->topLayerSamples[layerOffset]
-            : samplingCache->bottomLayerSamples[layerOffset];
-
-        if( sample >= 0 )
-            caseIndex |= 1 << i;
-
-        cornerSamples[i] = sample;
-    }
-
-    // Early out if entirely inside or outside
-    if( caseIndex == 0 || caseIndex == 0xFF )
-        return;
-
     i32* vertexCaches[3] =
     {
         samplingCache->bottomLayerVertexIndices,
@@ -792,80 +1020,344 @@ void MarchCube( const v3& cellCornerWorldP, const v2i& gridCellP, v2i const& cel
     }
 }
 
-void
-MarchVolumeFast( WorldCoords const& worldP, v3 const& volumeSideMeters, f32 cellSizeMeters, IsoSurfaceFunc* sampleFunc,
-                 SamplingData const* samplingData, IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices,
-                 BucketArray<i32>* indices, const bool interpolate /*= true*/ )
+void MarchCube( const v3& cellCornerWorldP, const v2i& gridCellP, v2i const& cellsPerAxis, f32 cellSizeMeters,
+                IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices,
+                const bool interpolate /*= true*/ )
 {
     TIMED_FUNC;
 
-    vertices->Clear();
-    indices->Clear();
+    // Cache layers contain one sample per _edge_
+    v2i layerStepsPerAxis = cellsPerAxis + V2iOne;
 
-    // TODO Should do ceil
-    v2i cellsPerSliceAxis = V2i( volumeSideMeters.xy / cellSizeMeters );
-    int sliceCount = (int)(volumeSideMeters.z / cellSizeMeters);
-    ASSERT( samplingCache->cellsPerAxis.x >= cellsPerSliceAxis.x && samplingCache->cellsPerAxis.y >= cellsPerSliceAxis.y );
-    v3 halfSideMeters = volumeSideMeters / 2;
-    v3 cornerOffset = -halfSideMeters;
+    // Construct case mask from 8 corner samples
+    int caseIndex = 0;
+    f32 cornerSamples[8];
+    for( int i = 0; i < 8; ++i )
+    {
+        v3i cornerOffset = cornerOffsets[i];
+        v3i layerP = V3i( gridCellP ) + cornerOffset;
+        int layerOffset = layerP.y * layerStepsPerAxis.x + layerP.x;
 
-    v3 vXDelta = V3( cellSizeMeters, 0.f, 0.f );
-    v3 vYDelta = V3( 0.f, cellSizeMeters, 0.f );
+        f32 sample = cornerOffset.z
+            ? samplingCache->topLayerSamples[layerOffset]
+            : samplingCache->bottomLayerSamples[layerOffset];
 
-    v2i gridLinesPerAxis = cellsPerSliceAxis + V2iOne;
-    bool firstSlice = true;
+        if( sample >= 0 )
+            caseIndex |= 1 << i;
 
-    WorldCoords p = worldP;
+        cornerSamples[i] = sample;
+    }
 
-    // Iterate slices, we consider both the bottom and the top samples of the cubes on each pass
-    for( int k = 0; k < sliceCount; ++k )
-    {
-        f32* bottomSamples = samplingCache->bottomLayerSamples;
-        f32* topSamples = samplingCache->topLayerSamples;
+    // Early out if entirely inside or outside
+    if( caseIndex == 0 || caseIndex == 0xFF )
+        return;
 
-        // Pre-sample top and bottom corners of cubes for each slice (actually only the top for all slices except the first one)
-        // so we only sample one corner per cube instead of 8
-        for( int n = 0; n < 2; ++n )
+    MarchActiveCube( caseIndex, cornerSamples, cellCornerWorldP, gridCellP, cellsPerAxis, cellSizeMeters, samplingCache,
+                     vertices, indices, interpolate );
+}
+
+// Corner bit for a lane of cells, set wherever the sample at that corner is >= 0 (same as in MarchCube)
+INLINE __m128i
+CaseIndexBitX4( f32 const* cornerSamples, int bit )
+{
+    __m128 set = _mm_cmpge_ps( _mm_loadu_ps( cornerSamples ), _mm_setzero_ps() );
+    return _mm_and_si128( _mm_castps_si128( set ), _mm_set1_epi32( bit ) );
+}
+
+// Compute the case index for all cells in a row a lane at a time, and compact the ones that actually cross the surface
+// into a list, so only those are ever visited. Returns the number of active cells.
+internal int
+FindActiveCellsInRow( f32 const* bottomRow, f32 const* topRow, int samplesPerRow, int cellCount,
+                      i32* caseIndices, i32* activeCells )
+{
+    f32 const* bottomNextRow = bottomRow + samplesPerRow;
+    f32 const* topNextRow = topRow + samplesPerRow;
+    __m128i allOut = _mm_setzero_si128();
+    __m128i allIn = _mm_set1_epi32( 0xFF );
+
+    int activeCount = 0;
+    for( int i = 0; i < cellCount; i += LaneWidth )
+    {
+        // Same corner order as cornerOffsets
+        __m128i caseIndex = CaseIndexBitX4( bottomRow + i, 0x01 );
+        caseIndex = _mm_or_si128( caseIndex, CaseIndexBitX4( bottomRow + i + 1, 0x02 ) );
+        caseIndex = _mm_or_si128( caseIndex, CaseIndexBitX4( bottomNextRow + i + 1, 0x04 ) );
+        caseIndex = _mm_or_si128( caseIndex, CaseIndexBitX4( bottomNextRow + i, 0x08 ) );
+        caseIndex = _mm_or_si128( caseIndex, CaseIndexBitX4( topRow + i, 0x10 ) );
+        caseIndex = _mm_or_si128( caseIndex, CaseIndexBitX4( topRow + i + 1, 0x20 ) );
+        caseIndex = _mm_or_si128( caseIndex, CaseIndexBitX4( topNextRow + i + 1, 0x40 ) );
+        caseIndex = _mm_or_si128( caseIndex, CaseIndexBitX4( topNextRow + i, 0x80 ) );
+        _mm_storeu_si128( (__m128i*)(caseIndices + i), caseIndex );
+
+        __m128i empty = _mm_or_si128( _mm_cmpeq_epi32( caseIndex, allOut ), _mm_cmpeq_epi32( caseIndex, allIn ) );
+        u32 activeMask = ~(u32)_mm_movemask_ps( _mm_castsi128_ps( empty ) ) & 0xF;
+        // Ignore lanes past the end of the row
+        if( cellCount - i < LaneWidth )
+            activeMask &= (1u << (cellCount - i)) - 1;
+
+        while( activeMask )
         {
-            if( n == 0 && !firstSlice )
-                continue;
+            activeCells[activeCount++] = i + FindLeastSignificantSetBit( activeMask );
+            activeMask &= activeMask - 1;
+        }
+    }
 
-            f32* sampledLayer = n ? topSamples : bottomSamples;
+    return activeCount;
+}
 
-            p.relativeP = worldP.relativeP + cornerOffset + V3i( 0, 0, k + n ) * cellSizeMeters;
+struct MCVolumeContext
+{
+    WorldCoords worldP;
+    v3 cornerOffset;
+    v2i cellsPerSliceAxis;
+    f32 cellSizeMeters;
+
+    IsoSurfaceBatchFunc* sampleBatchFunc;
+    IsoSurfaceRangeFunc* rangeFunc;
+    bool interpolate;
+};
 
-            f32* sample = sampledLayer;
-            // Iterate grid lines when sampling each layer, since we need to have samples at the extremes too
-            for( int j = 0; j < gridLinesPerAxis.y; ++j )
-            {
-                v3 pAtRowStart = p.relativeP;
-                for( int i = 0; i < gridLinesPerAxis.x; ++i )
-                {
-                    *sample++ = sampleFunc( p, samplingData );
-                    p.relativeP += vXDelta;
-                }
-                p.relativeP = pAtRowStart + vYDelta;
-            }
+internal void
+SampleMCLayer( MCVolumeContext const& context, i32 layer, f32* sampledLayer, IsoSurfaceBatch* rowBatch,
+               SamplingData const* samplingData )
+{
+    v2i gridLinesPerAxis = context.cellsPerSliceAxis + V2iOne;
+    v3 vXDelta = V3( context.cellSizeMeters, 0.f, 0.f );
+    v3 vYDelta = V3( 0.f, context.cellSizeMeters, 0.f );
+
+    WorldCoords p = context.worldP;
+    p.relativeP = context.worldP.relativeP + context.cornerOffset + V3i( 0, 0, layer ) * context.cellSizeMeters;
+    if( context.rangeFunc )
+        CullLayerSamples( sampledLayer, gridLinesPerAxis, p.relativeP, context.cellSizeMeters, context.rangeFunc, samplingData );
+
+    f32* sample = sampledLayer;
+    // Iterate grid lines when sampling each layer, since we need to have samples at the extremes too
+    for( int j = 0; j < gridLinesPerAxis.y; ++j )
+    {
+        v3 pAtRowStart = p.relativeP;
+        rowBatch->count = 0;
+        for( int i = 0; i < gridLinesPerAxis.x; ++i )
+        {
+            if( !context.rangeFunc || sample[i] == 0.f )
+                AddBatchPoint( rowBatch, p.relativeP );
+            p.relativeP += vXDelta;
         }
+        p.relativeP = pAtRowStart + vYDelta;
+
+        SampleRow( sample, gridLinesPerAxis.x, context.rangeFunc != nullptr, context.sampleBatchFunc, rowBatch, samplingData );
+        sample += gridLinesPerAxis.x;
+    }
+}
+
+// March all cells in slices [startSlice, endSlice).
+// When starting past the first slice, all vertices in the bottom layer are assumed to belong to the previous slab, so their cache
+// entries are set to -2 minus their offset in the cache, to be remapped when stitching.
+// If given, the vertex cache for the top layer of the last slice is copied to lastLayerVertexIndices.
+internal void
+MarchVolumeSlices( MCVolumeContext const& context, i32 startSlice, i32 endSlice, SamplingData const* samplingData,
+                   IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices,
+                   i32* lastLayerVertexIndices )
+{
+    v2i const& cellsPerSliceAxis = context.cellsPerSliceAxis;
+    ASSERT( samplingCache->cellsPerAxis.x >= cellsPerSliceAxis.x && samplingCache->cellsPerAxis.y >= cellsPerSliceAxis.y );
+
+    v2i gridLinesPerAxis = cellsPerSliceAxis + V2iOne;
+    int layerVertexCacheCount = gridLinesPerAxis.x * gridLinesPerAxis.y * 2;
+    f32 cellSizeMeters = context.cellSizeMeters;
+    v3 vYDelta = V3( 0.f, cellSizeMeters, 0.f );
+
+    // Iterate slices, we consider both the bottom and the top samples of the cubes on each pass
+    for( int k = startSlice; k < endSlice; ++k )
+    {
+        bool firstSlice = k == startSlice;
+
+        // Pre-sample top and bottom corners of cubes for each slice (actually only the top for all slices except the first one)
+        // so we only sample one corner per cube instead of 8
+        if( firstSlice )
+            SampleMCLayer( context, k, samplingCache->bottomLayerSamples, &samplingCache->rowBatch, samplingData );
+        SampleMCLayer( context, k + 1, samplingCache->topLayerSamples, &samplingCache->rowBatch, samplingData );
 
         // Keep a cache of already calculated vertices to eliminate duplication
         ClearVertexCaches( samplingCache, firstSlice );
+        if( firstSlice && startSlice > 0 )
+        {
+            for( int i = 0; i < layerVertexCacheCount; ++i )
+                samplingCache->bottomLayerVertexIndices[i] = -2 - i;
+        }
 
-        p.relativeP = worldP.relativeP + cornerOffset + V3i( 0, 0, k ) * cellSizeMeters;
+        f32 const* bottomSamples = samplingCache->bottomLayerSamples;
+        f32 const* topSamples = samplingCache->topLayerSamples;
+
+        WorldCoords p = context.worldP;
+        p.relativeP = context.worldP.relativeP + context.cornerOffset + V3i( 0, 0, k ) * cellSizeMeters;
         for( int j = 0; j < cellsPerSliceAxis.y; ++j )
         {
-            v3 pAtRowStart = p.relativeP;
-            for( int i = 0; i < cellsPerSliceAxis.x; ++i )
+            int rowOffset = j * gridLinesPerAxis.x;
+            int activeCount = FindActiveCellsInRow( bottomSamples + rowOffset, topSamples + rowOffset, gridLinesPerAxis.x,
+                                                    cellsPerSliceAxis.x, samplingCache->rowCaseIndices, samplingCache->rowActiveCells );
+
+            // Step along the row exactly as it was sampled, so vertices come out at the same positions as always
+            v3 cellP = p.relativeP;
+            int cellX = 0;
+            for( int n = 0; n < activeCount; ++n )
             {
-                MarchCube( p.relativeP, V2i( i, j ), cellsPerSliceAxis, cellSizeMeters, samplingCache, vertices, indices, interpolate );
-                p.relativeP += vXDelta;
+                int i = samplingCache->rowActiveCells[n];
+                for( ; cellX < i; ++cellX )
+                    cellP.x += cellSizeMeters;
+
+                f32 const* b = bottomSamples + rowOffset + i;
+                f32 const* t = topSamples + rowOffset + i;
+                int s = gridLinesPerAxis.x;
+                f32 cornerSamples[8] = { b[0], b[1], b[s + 1], b[s], t[0], t[1], t[s + 1], t[s] };
+
+                MarchActiveCube( samplingCache->rowCaseIndices[i], cornerSamples, cellP, V2i( i, j ), cellsPerSliceAxis,
+                                 cellSizeMeters, samplingCache, vertices, indices, context.interpolate );
             }
-            p.relativeP = pAtRowStart + vYDelta;
+            p.relativeP += vYDelta;
         }
 
-        firstSlice = false;
         SwapTopAndBottomLayers( samplingCache );
     }
+
+    // Last top layer is the bottom one after swapping
+    if( lastLayerVertexIndices )
+        PCOPY( samplingCache->bottomLayerVertexIndices, lastLayerVertexIndices, layerVertexCacheCount * sizeof(i32) );
+}
+
+// Output of each slab in a parallel MarchVolumeFast, kept until it's stitched to the others
+struct MCSlab
+{
+    // Each slab needs its own copy, as sampling changes it
+    SamplingData* samplingData;
+
+    Array<TexturedVertex> vertices;
+    Array<i32> indices;
+    i32* lastLayerVertexIndices;
+};
+
+struct MCParallelData
+{
+    MCVolumeContext context;
+    MCSlab* slabs;
+    SlabOutputArena output;
+
+    BucketArray<TexturedVertex>* vertices;
+    BucketArray<i32>* indices;
+};
+
+// Slabs should be thick enough that sampling their bottom layer again doesn't matter much
+const i32 MCMinSlabSlices = 8;
+
+internal
+PARALLEL_FOR_3D_FUNC(MCVolumeSlabJob)
+{
+    MCParallelData* data = (MCParallelData*)userData;
+    MCSlab* slab = &data->slabs[brickIndex];
+
+    IsoSurfaceSamplingCache samplingCache = InitSurfaceSamplingCache( scratchArena, data->context.cellsPerSliceAxis, Temporary() );
+    BucketArray<TexturedVertex> slabVertices( scratchArena, 1024, Temporary() );
+    BucketArray<i32> slabIndices( scratchArena, 1024, Temporary() );
+    MarchVolumeSlices( data->context, start.z, end.z, slab->samplingData, &samplingCache, &slabVertices, &slabIndices,
+                       slab->lastLayerVertexIndices );
+
+    // Scratch memory is gone after this
+    CopySlabOutput( slabVertices, slabIndices, &data->output, &slab->vertices, &slab->indices );
+}
+
+// Runs in slab order, so by the time we get to a slab, all vertices in the previous one have their final indices
+internal
+PARALLEL_REDUCE_FUNC(StitchMCSlab)
+{
+    MCParallelData* data = (MCParallelData*)userData;
+    MCSlab* slab = &data->slabs[batchIndex];
+    i32 const* seamVertexIndices = batchIndex > 0 ? data->slabs[batchIndex - 1].lastLayerVertexIndices : nullptr;
+
+    i32 vertexBase = data->vertices->count;
+    for( int i = 0; i < slab->vertices.count; ++i )
+        data->vertices->Push( slab->vertices[i] );
+
+    for( int i = 0; i < slab->indices.count; ++i )
+    {
+        i32 index = slab->indices[i];
+        if( index >= 0 )
+            index += vertexBase;
+        else
+        {
+            // Vertex in our bottom layer, which was created by the previous slab
+            ASSERT( seamVertexIndices );
+            index = seamVertexIndices[-2 - index];
+            ASSERT( index >= 0 );
+        }
+        data->indices->Push( index );
+    }
+
+    v2i gridLinesPerAxis = data->context.cellsPerSliceAxis + V2iOne;
+    i32 layerVertexCacheCount = gridLinesPerAxis.x * gridLinesPerAxis.y * 2;
+    for( int i = 0; i < layerVertexCacheCount; ++i )
+    {
+        if( slab->lastLayerVertexIndices[i] >= 0 )
+            slab->lastLayerVertexIndices[i] += vertexBase;
+    }
+}
+
+void
+MarchVolumeFast( WorldCoords const& worldP, v3 const& volumeSideMeters, f32 cellSizeMeters, IsoSurfaceBatchFunc* sampleBatchFunc,
+                 IsoSurfaceRangeFunc* rangeFunc, SamplingData const* samplingData, IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices,
+                 BucketArray<i32>* indices, MemoryArena* tmpArena, const bool interpolate /*= true*/,
+                 PlatformJobQueue* jobQueue /*= nullptr*/ )
+{
+    TIMED_FUNC;
+
+    vertices->Clear();
+    indices->Clear();
+
+    MCVolumeContext context = {};
+    context.worldP = worldP;
+    context.cornerOffset = -volumeSideMeters / 2;
+    // TODO Should do ceil
+    context.cellsPerSliceAxis = V2i( volumeSideMeters.xy / cellSizeMeters );
+    context.cellSizeMeters = cellSizeMeters;
+    context.sampleBatchFunc = sampleBatchFunc;
+    context.rangeFunc = rangeFunc;
+    context.interpolate = interpolate;
+
+    i32 sliceCount = (i32)(volumeSideMeters.z / cellSizeMeters);
+    i32 slabSlices = sliceCount;
+    if( jobQueue )
+    {
+        // A couple slabs per core, so they balance out a bit
+        i32 targetSlabCount = globalPlatform.coreThreadsCount * 2;
+        slabSlices = Max( MCMinSlabSlices, (sliceCount + targetSlabCount - 1) / targetSlabCount );
+    }
+
+    if( slabSlices >= sliceCount )
+    {
+        MarchVolumeSlices( context, 0, sliceCount, samplingData, samplingCache, vertices, indices, nullptr );
+        return;
+    }
+
+    MCParallelData data = {};
+    data.context = context;
+    data.vertices = vertices;
+    data.indices = indices;
+    data.output.arena = tmpArena;
+
+    v2i gridLinesPerAxis = context.cellsPerSliceAxis + V2iOne;
+    i32 layerGridLineCount = gridLinesPerAxis.x * gridLinesPerAxis.y;
+    i32 slabCount = ParallelForBatchCount( sliceCount, slabSlices );
+    data.slabs = PUSH_ARRAY( tmpArena, MCSlab, slabCount, Temporary() );
+    for( int s = 0; s < slabCount; ++s )
+    {
+        MCSlab& slab = data.slabs[s];
+        slab.samplingData = CopySamplingData( samplingData, tmpArena, Temporary() );
+        slab.lastLayerVertexIndices = PUSH_ARRAY( tmpArena, i32, layerGridLineCount * 2, Temporary() );
+    }
+
+    // Same as in DCVolume, the ParallelFor bookkeeping can't share tmpArena with the slab output
+    MemoryArena jobArena = MakeSubArena( tmpArena, ParallelForTmpArenaSize( slabCount ), Temporary() );
+    v2i const& cellsPerSliceAxis = context.cellsPerSliceAxis;
+    ParallelFor3D( jobQueue, V3iZero, V3i( cellsPerSliceAxis.x, cellsPerSliceAxis.y, sliceCount ),
+                   V3i( cellsPerSliceAxis.x, cellsPerSliceAxis.y, slabSlices ), MCVolumeSlabJob, &data, &jobArena, StitchMCSlab );
 }
 
 
@@ -889,16 +1381,128 @@ struct CellData
     i32 vertexIndex;
 };
 
+// NOTE DCVolume walks the cells in X-Y-Z order and only ever looks back one cell in each axis, so the linear layout
+// already gets the best locality (see TestGridLayoutBenchmark). Change the layout here to compare other policies.
+typedef Grid3D<CellData, LinearGridLayout> DCCellGrid;
 
 
-internal void ComputeEdgeCrossings( int i, int j, int k, v3 const& cellP, f32 cellSizeMeters, WorldCoords worldP, IsoSurfaceFunc* sampleFunc,
-                                    SamplingData* samplingData, v3 edgePoints[12], v3 edgeNormals[12], int* pointCount,
-                                    const v3i dcCornerOffsets[8], const EdgeLocator dcEdgeLocators[12],
-                                    f32 cornerSamples[8], Grid3D<CellData> *cellData, bool approximateEdgeIntersection )
+
+// Finds where the surface crosses the edge from pA to pB (with samples sA & sB at each end), and its normal at that point
+internal void FindEdgeCrossing( v3 const& pA, v3 const& pB, f32 sA, f32 sB, WorldCoords worldP, IsoSurfaceFunc* sampleFunc,
+                                IsoSurfaceBatchFunc* sampleBatchFunc, IsoSurfaceGradientFunc* gradientFunc, IsoSurfaceBatch* normalBatch,
+                                SamplingData* samplingData, bool approximateEdgeIntersection, DCEdgeStats* edgeStats,
+                                v3* edgeP, v3* edgeN )
 {
     static const f32 delta = 0.01f;
     static const f32 deltaInv = 1.f / (2.f * delta);
 
+    edgeStats->crossingCount++;
+
+    static const f32 epsilon = 0.01f;
+    //if( sB == F32MAX || AlmostEqual( sA, 0.f, epsilon ) )
+        //edgeP = pA;
+    //else if( sA == F32MAX || AlmostEqual( sB, 0.f, epsilon ) )
+        //edgeP = pB;
+    //else
+    {
+        if( approximateEdgeIntersection )
+        {
+            // Just interpolate along the edge
+            f32 t = sA / (sA - sB);
+            Clamp01( t );
+            *edgeP = Lerp( pA, pB, t );
+        }
+        else
+        {
+            // Illinois variant of regula falsi: sample at the linear estimate between both ends of the bracket,
+            // and halve the value kept at one end whenever that end survives twice in a row, so convergence
+            // never stalls approaching the root from one side only
+            static const int maxSearchSteps = 100;
+            int searchSteps = maxSearchSteps;
+            f32 tA = 0.f, tB = 1.f;
+            f32 fA = sA, fB = sB;
+            int lastKept = 0;
+            v3 lastP = V3Undefined;
+
+            while( --searchSteps )
+            {
+                f32 t = tA + (tB - tA) * fA / (fA - fB);
+                // Huge values at one end (or an exhausted bracket) make the estimate useless, so just bisect
+                if( !(t > tA && t < tB) )
+                    t = (tA + tB) * 0.5f;
+
+                worldP.relativeP = Lerp( pA, pB, t );
+                if( worldP.relativeP == lastP )
+                {
+                    // Float precision is limited
+                    *edgeP = lastP;
+                    break;
+                }
+                lastP = worldP.relativeP;
+
+                f32 edgeSample = sampleFunc( worldP, samplingData );
+                edgeStats->sampleCount++;
+
+                if( AlmostEqual( edgeSample, 0.f, epsilon ) )
+                {
+                    *edgeP = lastP;
+                    break;
+                }
+                else if( Sign( edgeSample ) == Sign( sA ) )
+                {
+                    tA = t;
+                    fA = edgeSample;
+                    if( lastKept == 1 )
+                        fB *= 0.5f;
+                    lastKept = 1;
+                }
+                else
+                {
+                    tB = t;
+                    fB = edgeSample;
+                    if( lastKept == -1 )
+                        fA *= 0.5f;
+                    lastKept = -1;
+                }
+            }
+            ASSERT( searchSteps > 0 );
+        }
+    }
+    ASSERT( *edgeP != V3Undefined );
+
+    v3 normal;
+    if( gradientFunc )
+    {
+        // Just use the gradient at the intersection point
+        worldP.relativeP = *edgeP;
+        gradientFunc( worldP, samplingData, &normal );
+    }
+    else
+    {
+        // Find normal vector by sampling near the intersection point we found
+        v3 const& p = *edgeP;
+        normalBatch->count = 0;
+        AddBatchPoint( normalBatch, { p.x + delta, p.y, p.z } );
+        AddBatchPoint( normalBatch, { p.x - delta, p.y, p.z } );
+        AddBatchPoint( normalBatch, { p.x, p.y + delta, p.z } );
+        AddBatchPoint( normalBatch, { p.x, p.y - delta, p.z } );
+        AddBatchPoint( normalBatch, { p.x, p.y, p.z + delta } );
+        AddBatchPoint( normalBatch, { p.x, p.y, p.z - delta } );
+        SampleBatch( sampleBatchFunc, normalBatch, samplingData );
+
+        f32 const* n = normalBatch->results;
+        normal = V3( n[0] - n[1], n[2] - n[3], n[4] - n[5] ) * deltaInv;
+    }
+    NormalizeFast( normal );
+    *edgeN = normal;
+}
+
+internal void ComputeEdgeCrossings( DCCellGrid::Cursor const& cell, v3 const& cellP, f32 cellSizeMeters, WorldCoords worldP, IsoSurfaceFunc* sampleFunc,
+                                    IsoSurfaceBatchFunc* sampleBatchFunc, IsoSurfaceGradientFunc* gradientFunc, IsoSurfaceBatch* normalBatch,
+                                    SamplingData* samplingData, v3 edgePoints[12], v3 edgeNormals[12], int* pointCount,
+                                    const v3i dcCornerOffsets[8], const EdgeLocator dcEdgeLocators[12],
+                                    f32 cornerSamples[8], bool approximateEdgeIntersection, DCEdgeStats* edgeStats )
+{
     for( int e = 0; e < 12; ++e )
     {
         EdgeLocator const& locator = dcEdgeLocators[e];
@@ -912,7 +1516,7 @@ internal void ComputeEdgeCrossings( int i, int j, int k, v3 const& cellP, f32 ce
         if( Sign( sA ) != Sign( sB ) )
         {
             int neighbourIndex = locator.neighbourIndex;
-            v3i neighbourCoords = V3i( i, j, k ) + dcCornerOffsets[neighbourIndex];
+            v3i neighbourCoords = cell.p + dcCornerOffsets[neighbourIndex];
             bool atOuterEdge = neighbourCoords.z < 0 || neighbourCoords.y < 0 || neighbourCoords.x < 0;
 
             if( atOuterEdge || indexB == 7 || indexA == 7 )
@@ -921,96 +1525,29 @@ internal void ComputeEdgeCrossings( int i, int j, int k, v3 const& cellP, f32 ce
                 v3 pA = cellP + V3( dcCornerOffsets[indexA] ) * cellSizeMeters;
                 v3 pB = cellP + V3( dcCornerOffsets[indexB] ) * cellSizeMeters;
                 v3 edgeP = V3Undefined;
-
-                static const f32 epsilon = 0.01f;
-                //if( sB == F32MAX || AlmostEqual( sA, 0.f, epsilon ) )
-                    //edgeP = pA;
-                //else if( sA == F32MAX || AlmostEqual( sB, 0.f, epsilon ) )
-                    //edgeP = pB;
-                //else
-                {
-                    if( approximateEdgeIntersection )
-                    {
-                        // Just interpolate along the edge
-                        f32 t = sA / (sA - sB);
-                        Clamp01( t );
-                        edgeP = Lerp( pA, pB, t );
-                    }
-                    else
-                    {
-                        // Do a binary search along the edge
-                        static const int maxSearchSteps = 100;
-                        int searchSteps = maxSearchSteps;
-                        f32 edgeSample = 0.f;
-                        v3 lastP = V3Undefined;
-
-                        while( --searchSteps )
-                        {
-                            worldP.relativeP = (pA + pB) * 0.5f;
-                            if( worldP.relativeP == lastP )
-                            {
-                                // Float precision is limited
-                                edgeP = lastP;
-                                break;
-                            }
-                            lastP = worldP.relativeP;
-                                
-                            edgeSample = sampleFunc( worldP, samplingData );
-
-                            if( AlmostEqual( edgeSample, 0.f, epsilon ) )
-                            {
-                                edgeP = lastP;
-                                break;
-                            }
-                            else
-                            {
-                                if( Sign( edgeSample ) == Sign( sA ) )
-                                    pA = lastP;
-                                else
-                                    pB = lastP;
-                            }
-                        }
-                        ASSERT( searchSteps > 0 );
-                    }
-                }
+                v3 normal;
+                FindEdgeCrossing( pA, pB, sA, sB, worldP, sampleFunc, sampleBatchFunc, gradientFunc, normalBatch, samplingData,
+                                  approximateEdgeIntersection, edgeStats, &edgeP, &normal );
 
                 edgePoints[*pointCount] = edgeP;
+                edgeNormals[*pointCount] = normal;
                 if( !atOuterEdge )
-                    (*cellData)( i, j, k ).edgeCrossingsP[locator.storeIndex] = edgeP;
+                {
+                    cell.Cell().edgeCrossingsP[locator.storeIndex] = edgeP;
+                    cell.Cell().edgeCrossingsN[locator.storeIndex] = normal;
+                }
 
-                ASSERT( edgeP != V3Undefined );
                 if( *pointCount )
                     ASSERT( DistanceFast( edgePoints[*pointCount-1], edgePoints[*pointCount] ) < 3.f * VoxelSizeMeters );
-
-                // Find normal vector by sampling near the intersection point we found
-                worldP.relativeP = { edgeP.x + delta, edgeP.y, edgeP.z };
-                f32 xPSample = sampleFunc( worldP, samplingData );
-                worldP.relativeP = { edgeP.x - delta, edgeP.y, edgeP.z };
-                f32 xNSample = sampleFunc( worldP, samplingData );
-
-                worldP.relativeP = { edgeP.x, edgeP.y + delta, edgeP.z };
-                f32 yPSample = sampleFunc( worldP, samplingData );
-                worldP.relativeP = { edgeP.x, edgeP.y - delta, edgeP.z };
-                f32 yNSample = sampleFunc( worldP, samplingData );
-
-                worldP.relativeP = { edgeP.x, edgeP.y, edgeP.z + delta };
-                f32 zPSample = sampleFunc( worldP, samplingData );
-                worldP.relativeP = { edgeP.x, edgeP.y, edgeP.z - delta };
-                f32 zNSample = sampleFunc( worldP, samplingData );
-
-                v3 normal = V3( xPSample - xNSample, yPSample - yNSample, zPSample - zNSample ) * deltaInv;
-                NormalizeFast( normal );
-                edgeNormals[*pointCount] = normal;
-                if( !atOuterEdge )
-                    (*cellData)( i, j, k ).edgeCrossingsN[locator.storeIndex] = normal;
             }
             else
             {
                 // This has already been calculated and stored in a neighbour cell so go get it
                 ASSERT( neighbourIndex != 7 );
 
-                edgePoints[*pointCount] = (*cellData)( neighbourCoords ).edgeCrossingsP[locator.storeIndex];
-                edgeNormals[*pointCount] = (*cellData)( neighbourCoords ).edgeCrossingsN[locator.storeIndex];
+                CellData const& neighbour = cell.Neighbour( dcCornerOffsets[neighbourIndex] );
+                edgePoints[*pointCount] = neighbour.edgeCrossingsP[locator.storeIndex];
+                edgeNormals[*pointCount] = neighbour.edgeCrossingsN[locator.storeIndex];
 
                 if( *pointCount )
                     ASSERT( DistanceFast( edgePoints[*pointCount-1], edgePoints[*pointCount] ) < 3.f * VoxelSizeMeters );
@@ -1019,7 +1556,6 @@ internal void ComputeEdgeCrossings( int i, int j, int k, v3 const& cellP, f32 ce
             (*pointCount)++;
         }
     }
-
 }
 
 // FIXME Enabling this (which disables /Og -global optimizations-) causes some vertices that are clamped with full optimizations to be
@@ -1127,18 +1663,33 @@ internal void ComputeCellPointAndNormal( v3 edgePoints[12], v3 edgeNormals[12],
 #pragma optimize( "", on )
 
 
+// Everything needed to contour any range of layers of a volume
+struct DCVolumeContext
+{
+    WorldCoords worldP;
+    v3 minGridP;
+    v3i cellsPerAxis;
+    f32 cellSizeMeters;
+
+    IsoSurfaceFunc* sampleFunc;
+    IsoSurfaceBatchFunc* sampleBatchFunc;
+    IsoSurfaceGradientFunc* gradientFunc;
+    IsoSurfaceRangeFunc* rangeFunc;
+    DCSettings settings;
+};
+
 // TODO Clean up asserts
 // TODO Clean up asserts
 // TODO Clean up asserts
-void
-DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMeters, IsoSurfaceFunc* sampleFunc, SamplingData* samplingData,
-          BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices, MemoryArena* arena, MemoryArena* tmpArena, DCSettings const& settings )
+// Contours cell layers [startLayer, endLayer) of the volume
+// Cells only ever look back one cell in each axis, so any slab of layers can be done on its own as long as it can look back
+// one more layer. Slabs not starting at the first layer sample that previous layer too, but only compute what their first layer
+// needs from it (samples and the edge crossings stored in it). Quads using vertices from that 'seam' layer are output with
+// negative indices (-1 - index of the cell in its layer), to be remapped once the previous slab is done (see StitchDCSlab).
+internal void
+DCVolumeLayers( DCVolumeContext const& context, i32 startLayer, i32 endLayer, SamplingData* samplingData,
+                BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices, i32* lastLayerVertexIndices, MemoryArena* tmpArena )
 {
-    struct MergingData
-    {
-        i32 count;
-    };
-
     // TODO Pack these LUTs so they use less cache
     // ALSO align properly!
 
@@ -1171,25 +1722,36 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
         { 2, 6, 6, 2 },     // Z
     };
 
-    vertices->Clear();
-    indices->Clear();
-
-    // One extra layer of cells in X,Y,Z (around the min grid corner) to store the edges and samples at the border
-    v3i cellsPerAxis = V3iRound( volumeSizeMeters / cellSizeMeters ) + V3iOne;
-    Grid3D<CellData> cellData( tmpArena, cellsPerAxis, Temporary() );
-
-    v3i groupsPerAxis = V3iRound( volumeSizeMeters / cellSizeMeters / 2.f ) + V3iOne;
-    Grid3D<MergingData> mergeData( tmpArena, groupsPerAxis, Temporary() );
-
-    v3 halfSizeMeters = volumeSizeMeters / 2;
-    v3 minGridP = worldP.relativeP - halfSizeMeters;
-    WorldCoords p = worldP;
-
-    Cluster* debugCluster = nullptr;
+    v3i const& cellsPerAxis = context.cellsPerAxis;
+    f32 cellSizeMeters = context.cellSizeMeters;
+    v3 const& minGridP = context.minGridP;
+    IsoSurfaceFunc* sampleFunc = context.sampleFunc;
+    IsoSurfaceBatchFunc* sampleBatchFunc = context.sampleBatchFunc;
+    IsoSurfaceGradientFunc* gradientFunc = context.gradientFunc;
+    IsoSurfaceRangeFunc* rangeFunc = context.rangeFunc;
+    DCSettings const& settings = context.settings;
+
+    // Our grid only covers the layers we touch, including the seam layer
+    i32 firstLayer = startLayer > 0 ? startLayer - 1 : 0;
+    DCCellGrid cellData( tmpArena, V3i( cellsPerAxis.x, cellsPerAxis.y, endLayer - firstLayer ),
+                         Tagged( MemoryTag::Scratch(), Temporary() ) );
+
+    // Samples for a whole row of cells are taken in one go
+    IsoSurfaceBatch rowBatch = InitIsoSurfaceBatch( tmpArena, cellsPerAxis.x, Temporary() );
+    // Samples for the current layer, so we can find which ones to skip before sampling them
+    f32* layerSamples = PUSH_ARRAY( tmpArena, f32, cellsPerAxis.x * cellsPerAxis.y, Temporary() );
+    // 2 samples per axis for each edge normal
+    IsoSurfaceBatch normalBatch = InitIsoSurfaceBatch( tmpArena, 6, Temporary() );
+    // Accumulated locally, then added to the global stats once we're done
+    DCEdgeStats edgeStats = {};
+
+    WorldCoords p = context.worldP;
+
+    BucketArray<DebugVolume>* debugVolumes = nullptr;
     if( samplingData->type == SamplingDataType::ClusterData )
     {
         ClusterSamplingData* clusterData = (ClusterSamplingData*)samplingData;
-        debugCluster = clusterData->debugCluster;
+        debugVolumes = clusterData->debugVolumes;
     }
 
     const v3 debugSampleSize = V3( 0.03f );
@@ -1204,24 +1766,92 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
     //   but store their corresponding sample and compute their minimizing point so non-edge neighbours can use that
     // - Once we're past this extra 'dummy' layer, compute the quads that cross each edge containing the 'min' corner of each cell,
     //   as we know all vertices on adjacent cells in each edge have already been computed
-    for( int k = 0; k < cellsPerAxis.z; ++k )
+    for( int layer = firstLayer; layer < endLayer; ++layer )
     {
+        // Index into our own grid
+        int k = layer - firstLayer;
+
+        samplingData->zeroThickness = thicknessSetting;
+        if( rangeFunc )
+            CullLayerSamples( layerSamples, cellsPerAxis.xy, minGridP + V3( 0, 0, layer ) * cellSizeMeters + V3( cellSizeMeters ),
+                              cellSizeMeters, rangeFunc, samplingData );
+
         for( int j = 0; j < cellsPerAxis.y; ++j )
         {
+            samplingData->zeroThickness = thicknessSetting;
+
+            f32* rowSamples = layerSamples + j * cellsPerAxis.x;
+            rowBatch.count = 0;
             for( int i = 0; i < cellsPerAxis.x; ++i )
+            {
+                if( !rangeFunc || rowSamples[i] == 0.f )
+                    AddBatchPoint( &rowBatch, minGridP + V3( i, j, layer ) * cellSizeMeters + V3( cellSizeMeters ) );
+            }
+            SampleRow( rowSamples, cellsPerAxis.x, rangeFunc != nullptr, sampleBatchFunc, &rowBatch, samplingData );
+
+            if( layer < startLayer )
+            {
+                // Seam layer, so just keep the samples and the crossings along the top X & Y edges of each cell
+                DCCellGrid::Cursor cursor = cellData.CursorAt( 0, j, k );
+                for( int i = 0; i < cellsPerAxis.x; ++i, cursor.NextX() )
+                {
+                    samplingData->zeroThickness = thicknessSetting;
+
+                    v3 minCellP = minGridP + V3( i, j, layer ) * cellSizeMeters;
+                    v3 cellP = minCellP + V3( cellSizeMeters );
+                    CellData& cell = cursor.Cell();
+                    cell.sampledValue = rowSamples[i] + 0.f;
+                    cell.vertexIndex = -1 - (j * cellsPerAxis.x + i);
+
+                    // Same as below, but we only need corners 5, 6 & 7
+                    f32 cornerSamples[8] = {};
+                    for( int s = 5; s < 8; ++s )
+                    {
+                        v3i cellGridP = V3i( i, j, k ) + dcCornerOffsets[s];
+                        if( cellGridP.x < 0 || cellGridP.y < 0 )
+                        {
+                            p.relativeP = cellP + V3( dcCornerOffsets[s] ) * cellSizeMeters;
+                            cornerSamples[s] = sampleFunc( p, samplingData ) + 0.f;
+                        }
+                        else
+                            cornerSamples[s] = cursor.Neighbour( dcCornerOffsets[s] ).sampledValue;
+                    }
+
+                    // Edges 5 & 6 are the ones stored in this cell (Y & X)
+                    for( int e = 5; e < 7; ++e )
+                    {
+                        EdgeLocator const& locator = dcEdgeLocators[e];
+                        f32 sA = cornerSamples[ locator.cornerA ];
+                        f32 sB = cornerSamples[ locator.cornerB ];
+
+                        if( Sign( sA ) != Sign( sB ) )
+                        {
+                            v3 pA = cellP + V3( dcCornerOffsets[locator.cornerA] ) * cellSizeMeters;
+                            v3 pB = cellP + V3( dcCornerOffsets[locator.cornerB] ) * cellSizeMeters;
+                            FindEdgeCrossing( pA, pB, sA, sB, p, sampleFunc, sampleBatchFunc, gradientFunc, &normalBatch, samplingData,
+                                              settings.approximateEdgeIntersection, &edgeStats,
+                                              &cell.edgeCrossingsP[locator.storeIndex], &cell.edgeCrossingsN[locator.storeIndex] );
+                        }
+                    }
+                }
+                continue;
+            }
+
+            DCCellGrid::Cursor cursor = cellData.CursorAt( 0, j, k );
+            for( int i = 0; i < cellsPerAxis.x; ++i, cursor.NextX() )
             {
                 samplingData->zeroThickness = thicknessSetting;
 
 #if 1
                 // Cell at { 0, 0, 0 } gets the sample at world position minGridP + { 1, 1, 1 } * cellSize
-                v3 minCellP = minGridP + V3( i, j, k ) * cellSizeMeters;
+                v3 minCellP = minGridP + V3( i, j, layer ) * cellSizeMeters;
                 v3 cellBoundsMin = minCellP;
                 v3 cellBoundsMax = minCellP + V3( cellSizeMeters );
                 v3 cellP = cellBoundsMax;
 #else
                 // Cell at { 0, 0, 0 } gets the sample at world position minGridP
                 // (so it can generate a minimizing vertex which is outside the sampled bounds)
-                v3 cellP = minGridP + V3( i, j, k ) * cellSizeMeters;
+                v3 cellP = minGridP + V3( i, j, layer ) * cellSizeMeters;
                 v3 cellBoundsMax = cellP;
                 v3 cellBoundsMin = cellP - V3( cellSizeMeters );
 #endif
@@ -1239,19 +1869,18 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
                     f32 sample = F32INF;
                     if( s == 7 )
                     {
-                        // Sample our own
+                        // Sample our own (already done for the whole row)
                         // Account for -0 by just adding +0 to the value
-                        p.relativeP = cellP;
-                        sample = sampleFunc( p, samplingData ) + 0.f;
-                        cellData( i, j, k ).sampledValue = sample;
+                        sample = rowSamples[i] + 0.f;
+                        cursor.Cell().sampledValue = sample;
 
                         // TODO Use instancing and just draw three crossing axis lines at each point to make this viable
 #if 0 //!RELEASE
-                        if( debugCluster && (i == 0 || j == 0 || k == 0 || i == cellsPerAxis.x-1 || j == cellsPerAxis.y-1 || k == cellsPerAxis.z-1) )
+                        if( debugVolumes && (i == 0 || j == 0 || k == 0 || i == cellsPerAxis.x-1 || j == cellsPerAxis.y-1 || k == cellsPerAxis.z-1) )
                         {
                             v4 color = sample >= 0.f ? outColor : inColor;
                             color.a = Clamp01( 1.f - Abs( sample ) / 5.f );
-                            debugCluster->debugVolumes.Push( { { cellP, debugSampleSize }, color } );
+                            debugVolumes->Push( { { cellP, debugSampleSize }, color } );
                         }
 #endif
 
@@ -1267,7 +1896,7 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
                             sample = sampleFunc( p, samplingData ) + 0.f;
                         }
                         else
-                            sample = cellData( cellGridP ).sampledValue;
+                            sample = cursor.Neighbour( dcCornerOffsets[s] ).sampledValue;
                     }
 
                     if( Sign( sample ) )
@@ -1285,8 +1914,10 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
 
                 // We only process 3 edges per cell (those containing the corner stored in each cell)
                 // Find edge intersections for those, get them from neighbours for the rest
-                ComputeEdgeCrossings( i, j, k, cellP, cellSizeMeters, p, sampleFunc, samplingData, edgePoints, edgeNormals, &pointCount,
-                                      dcCornerOffsets, dcEdgeLocators, cornerSamples, &cellData, settings.approximateEdgeIntersection );
+                ComputeEdgeCrossings( cursor, cellP, cellSizeMeters, p, sampleFunc, sampleBatchFunc, gradientFunc, &normalBatch, samplingData,
+                                      edgePoints, edgeNormals, &pointCount,
+                                      dcCornerOffsets, dcEdgeLocators, cornerSamples, settings.approximateEdgeIntersection,
+                                      &edgeStats );
                 ASSERT( pointCount );
 
                 v3 cellVertex = V3Undefined;
@@ -1313,9 +1944,7 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
                 // TODO Generalize this into a 'tagger' function callback?
                 v.tag = inside ? VertexTag::Inner : VertexTag::Outer;
                 vertices->Push( v );
-                cellData( i, j, k ).vertexIndex = vertexIndex;
-
-                mergeData( i >> 1, j >> 1, k >> 1 ).count++;
+                cursor.Cell().vertexIndex = vertexIndex;
 
 
                 // Now we look 'backwards' and create at most 3 quads corresponding to the edges that include the 'min' corner instead,
@@ -1345,22 +1974,22 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
                             if( sA < sB )
                             {
                                 indices->Push( vertexIndex );
-                                indices->Push( cellData( i, j-1, k ).vertexIndex );
-                                indices->Push( cellData( i, j, k-1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, 0, -1 ).vertexIndex );
 
-                                indices->Push( cellData( i, j, k-1 ).vertexIndex );
-                                indices->Push( cellData( i, j-1, k ).vertexIndex );
-                                indices->Push( cellData( i, j-1, k-1 ).vertexIndex ); 
+                                indices->Push( cursor.Neighbour( 0, 0, -1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, -1 ).vertexIndex ); 
                             }
                             else
                             {
                                 indices->Push( vertexIndex );
-                                indices->Push( cellData( i, j, k-1 ).vertexIndex );
-                                indices->Push( cellData( i, j-1, k ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, 0, -1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, 0 ).vertexIndex );
 
-                                indices->Push( cellData( i, j-1, k ).vertexIndex );
-                                indices->Push( cellData( i, j, k-1 ).vertexIndex );
-                                indices->Push( cellData( i, j-1, k-1 ).vertexIndex ); 
+                                indices->Push( cursor.Neighbour( 0, -1, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, 0, -1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, -1 ).vertexIndex ); 
                             }
                         } break;
                         case 1:     // Normal aligned to +/- Y
@@ -1371,22 +2000,22 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
                             if( sA < sB )
                             {
                                 indices->Push( vertexIndex );
-                                indices->Push( cellData( i, j, k-1 ).vertexIndex );
-                                indices->Push( cellData( i-1, j, k ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, 0, -1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, 0 ).vertexIndex );
 
-                                indices->Push( cellData( i-1, j, k ).vertexIndex );
-                                indices->Push( cellData( i, j, k-1 ).vertexIndex );
-                                indices->Push( cellData( i-1, j, k-1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, 0, -1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, -1 ).vertexIndex );
                             }
                             else
                             {
                                 indices->Push( vertexIndex );
-                                indices->Push( cellData( i-1, j, k ).vertexIndex );
-                                indices->Push( cellData( i, j, k-1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, 0, -1 ).vertexIndex );
 
-                                indices->Push( cellData( i, j, k-1 ).vertexIndex );
-                                indices->Push( cellData( i-1, j, k ).vertexIndex );
-                                indices->Push( cellData( i-1, j, k-1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, 0, -1 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, -1 ).vertexIndex );
                             }
                         } break;
                         case 2:     // Normal aligned to +/- Z
@@ -1397,22 +2026,22 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
                             if( sA < sB )
                             {
                                 indices->Push( vertexIndex );
-                                indices->Push( cellData( i-1, j, k ).vertexIndex );
-                                indices->Push( cellData( i, j-1, k ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, 0 ).vertexIndex );
 
-                                indices->Push( cellData( i, j-1, k ).vertexIndex );
-                                indices->Push( cellData( i-1, j, k ).vertexIndex );
-                                indices->Push( cellData( i-1, j-1, k).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, -1, 0 ).vertexIndex );
                             }
                             else
                             {
                                 indices->Push( vertexIndex );
-                                indices->Push( cellData( i, j-1, k ).vertexIndex );
-                                indices->Push( cellData( i-1, j, k ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, 0 ).vertexIndex );
 
-                                indices->Push( cellData( i-1, j, k ).vertexIndex );
-                                indices->Push( cellData( i, j-1, k ).vertexIndex );
-                                indices->Push( cellData( i-1, j-1, k).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, 0, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( 0, -1, 0 ).vertexIndex );
+                                indices->Push( cursor.Neighbour( -1, -1, 0 ).vertexIndex );
                             }
                         } break;
                         }
@@ -1421,6 +2050,156 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
             }
         }
     }
+
+    if( lastLayerVertexIndices )
+    {
+        // So the next slab can find the vertices in its seam layer
+        i32 lastK = endLayer - 1 - firstLayer;
+        for( int j = 0; j < cellsPerAxis.y; ++j )
+            for( int i = 0; i < cellsPerAxis.x; ++i )
+                lastLayerVertexIndices[j * cellsPerAxis.x + i] = cellData( i, j, lastK ).vertexIndex;
+    }
+
+#if !RELEASE
+    if( DEBUGglobalDCEdgeStats )
+    {
+        AtomicAdd( &DEBUGglobalDCEdgeStats->crossingCount, edgeStats.crossingCount );
+        AtomicAdd( &DEBUGglobalDCEdgeStats->sampleCount, edgeStats.sampleCount );
+    }
+#endif
+}
+
+
+
+
+// Output of each slab in a parallel DCVolume, kept until it's stitched to the others
+struct DCSlab
+{
+    // Each slab needs its own copy, as sampling changes it
+    SamplingData* samplingData;
+
+    Array<TexturedVertex> vertices;
+    Array<i32> indices;
+    i32* lastLayerVertexIndices;
+};
+
+struct DCParallelData
+{
+    DCVolumeContext context;
+    DCSlab* slabs;
+    SlabOutputArena output;
+
+    BucketArray<TexturedVertex>* vertices;
+    BucketArray<i32>* indices;
+};
+
+// Slabs should be thick enough that the extra seam layer they sample doesn't matter much
+const i32 DCMinSlabLayers = 8;
+
+internal
+PARALLEL_FOR_3D_FUNC(DCVolumeSlabJob)
+{
+    DCParallelData* data = (DCParallelData*)userData;
+    DCSlab* slab = &data->slabs[brickIndex];
+
+    BucketArray<TexturedVertex> slabVertices( scratchArena, 1024, Temporary() );
+    BucketArray<i32> slabIndices( scratchArena, 1024, Temporary() );
+    DCVolumeLayers( data->context, start.z, end.z, slab->samplingData, &slabVertices, &slabIndices, slab->lastLayerVertexIndices,
+                    scratchArena );
+
+    // Scratch memory is gone after this
+    CopySlabOutput( slabVertices, slabIndices, &data->output, &slab->vertices, &slab->indices );
+}
+
+// Runs in slab order, so by the time we get to a slab, all vertices in the previous one have their final indices
+internal
+PARALLEL_REDUCE_FUNC(StitchDCSlab)
+{
+    DCParallelData* data = (DCParallelData*)userData;
+    DCSlab* slab = &data->slabs[batchIndex];
+    i32 const* seamVertexIndices = batchIndex > 0 ? data->slabs[batchIndex - 1].lastLayerVertexIndices : nullptr;
+
+    i32 vertexBase = data->vertices->count;
+    for( int i = 0; i < slab->vertices.count; ++i )
+        data->vertices->Push( slab->vertices[i] );
+
+    for( int i = 0; i < slab->indices.count; ++i )
+    {
+        i32 index = slab->indices[i];
+        if( index >= 0 )
+            index += vertexBase;
+        else
+        {
+            // Vertex in our seam layer, which belongs to the previous slab
+            ASSERT( seamVertexIndices );
+            index = seamVertexIndices[-1 - index];
+        }
+        data->indices->Push( index );
+    }
+
+    i32 layerCellCount = data->context.cellsPerAxis.x * data->context.cellsPerAxis.y;
+    for( int i = 0; i < layerCellCount; ++i )
+        slab->lastLayerVertexIndices[i] += vertexBase;
+}
+
+void
+DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMeters, IsoSurfaceFunc* sampleFunc,
+          IsoSurfaceBatchFunc* sampleBatchFunc, IsoSurfaceGradientFunc* gradientFunc, IsoSurfaceRangeFunc* rangeFunc,
+          SamplingData* samplingData,
+          BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices, MemoryArena* arena, MemoryArena* tmpArena, DCSettings const& settings,
+          PlatformJobQueue* jobQueue /*= nullptr*/ )
+{
+    vertices->Clear();
+    indices->Clear();
+
+    DCVolumeContext context = {};
+    context.worldP = worldP;
+    context.minGridP = worldP.relativeP - volumeSizeMeters / 2;
+    // One extra layer of cells in X,Y,Z (around the min grid corner) to store the edges and samples at the border
+    context.cellsPerAxis = V3iRound( volumeSizeMeters / cellSizeMeters ) + V3iOne;
+    context.cellSizeMeters = cellSizeMeters;
+    context.sampleFunc = sampleFunc;
+    context.sampleBatchFunc = sampleBatchFunc;
+    context.gradientFunc = gradientFunc;
+    context.rangeFunc = rangeFunc;
+    context.settings = settings;
+
+    v3i const& cellsPerAxis = context.cellsPerAxis;
+    i32 slabLayers = cellsPerAxis.z;
+    if( jobQueue )
+    {
+        // A couple slabs per core, so they balance out a bit
+        i32 targetSlabCount = globalPlatform.coreThreadsCount * 2;
+        slabLayers = Max( DCMinSlabLayers, (cellsPerAxis.z + targetSlabCount - 1) / targetSlabCount );
+    }
+
+    if( slabLayers >= cellsPerAxis.z )
+    {
+        DCVolumeLayers( context, 0, cellsPerAxis.z, samplingData, vertices, indices, nullptr, tmpArena );
+        return;
+    }
+
+    DCParallelData data = {};
+    data.context = context;
+    data.vertices = vertices;
+    data.indices = indices;
+    data.output.arena = tmpArena;
+
+    i32 slabCount = ParallelForBatchCount( cellsPerAxis.z, slabLayers );
+    i32 layerCellCount = cellsPerAxis.x * cellsPerAxis.y;
+    data.slabs = PUSH_ARRAY( tmpArena, DCSlab, slabCount, Temporary() );
+    for( int s = 0; s < slabCount; ++s )
+    {
+        DCSlab& slab = data.slabs[s];
+        slab.samplingData = CopySamplingData( samplingData, tmpArena, Temporary() );
+        slab.lastLayerVertexIndices = PUSH_ARRAY( tmpArena, i32, layerCellCount, Temporary() );
+    }
+
+    // Slab output goes to tmpArena while the jobs run, so the ParallelFor bookkeeping needs an arena of its own
+    // (its temporary block would discard that output otherwise)
+    MemoryArena jobArena = MakeSubArena( tmpArena, ParallelForTmpArenaSize( slabCount ), Temporary() );
+    ParallelFor3D( jobQueue, V3iZero, cellsPerAxis, V3i( cellsPerAxis.x, cellsPerAxis.y, slabLayers ),
+                   DCVolumeSlabJob, &data, &jobArena, StitchDCSlab );
 }
 
 
@@ -1429,13 +2208,13 @@ DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMet
 // in the same spirit as http://www.andrewwillmott.com/papers/rsmam/RSMAM-Final.pdf but simpler
 // NOTE Given cell size should be at most double the size at which the volume was sampled (assuming one vertex per cell)
 // This is because we currently merge at most 8 vertices per cell!
+// The result is allocated from the given mesh pool (null if there's no room for it)
 // FIXME FIX BUGS
 // - Disappearing vertices / tris
 // - Crazy elongated tris popping up
 // - Tris changing winding direction due to extreme vertex displacement
-void FastDecimate( BucketArray<TexturedVertex> const& vertices, BucketArray<i32> const& indices, v3 const& volumeCenterP,
-                   v3 const& volumeSizeMeters, f32 cellSizeMeters, VertexTag filterTag, MemoryArena* arena, MemoryArena* tmpArena,
-                   Array<TexturedVertex>* outVertices, Array<i32>* outIndices )
+Mesh* FastDecimate( BucketArray<TexturedVertex> const& vertices, BucketArray<i32> const& indices, v3 const& volumeCenterP,
+                    v3 const& volumeSizeMeters, f32 cellSizeMeters, VertexTag filterTag, MeshPool* meshPool, MemoryArena* tmpArena )
 {
     struct Vert
     {
@@ -1454,7 +2233,7 @@ void FastDecimate( BucketArray<TexturedVertex> const& vertices, BucketArray<i32>
 
 
     v3i cellsPerAxis = V3iRound( volumeSizeMeters / cellSizeMeters ) + V3iOne;
-    Grid3D<ClusteringData> cellData( tmpArena, cellsPerAxis, Temporary() );
+    Grid3D<ClusteringData> cellData( tmpArena, cellsPerAxis, Tagged( MemoryTag::Scratch(), Temporary() ) );
     v3 halfSizeMeters = volumeSizeMeters * 0.5f;
     v3 minVolumeP = volumeCenterP - halfSizeMeters;
 
@@ -1551,16 +2330,17 @@ void FastDecimate( BucketArray<TexturedVertex> const& vertices, BucketArray<i32>
         Grid3D<ClusteringData> parentCellData = {};
 
         v3i parentCellsPerAxis = cellsPerAxis / 2 + V3iOne;
-        INIT( &parentCellData ) Grid3D<ClusteringData>( tmpArena, parentCellsPerAxis, Temporary() );
+        INIT( &parentCellData ) Grid3D<ClusteringData>( tmpArena, parentCellsPerAxis, Tagged( MemoryTag::Scratch(), Temporary() ) );
 
         clustered = 0;
         for( int k = 0; k < cellsPerAxis.z; ++k )
         {
             for( int j = 0; j < cellsPerAxis.y; ++j )
             {
-                for( int i = 0; i < cellsPerAxis.x; ++i )
+                Grid3D<ClusteringData>::Cursor cursor = cellData.CursorAt( 0, j, k );
+                for( int i = 0; i < cellsPerAxis.x; ++i, cursor.NextX() )
                 {
-                    ClusteringData& cell = cellData( i, j ,k );
+                    ClusteringData& cell = cursor.Cell();
                     if( !cell.excluded && cell.count > 1 )
                     {
                         // TODO We could be much more aggresive clustering by finding new safe heuristics that we can add here
@@ -1704,14 +2484,22 @@ void FastDecimate( BucketArray<TexturedVertex> const& vertices, BucketArray<i32>
     vertexArray.count = dst;
 
 
-    INIT( outVertices ) Array<TexturedVertex>( arena, vertexArray.count, NoClear() );
+    // Nothing left with the requested tag
+    if( !triangles.count )
+        return nullptr;
+
+    Mesh* result = AllocateMesh( meshPool, vertexArray.count, triangles.count * 3 );
+    if( !result )
+        return nullptr;
+
+    Array<TexturedVertex>* outVertices = &result->vertices;
     outVertices->ResizeToCapacity();
     for( int i = 0; i < vertexArray.count; ++i )
     {
         outVertices->data[i] = *vertexArray[i].attrs;
     }
 
-    INIT( outIndices ) Array<i32>( arena, triangles.count * 3, NoClear() );
+    Array<i32>* outIndices = &result->indices;
     outIndices->ResizeToCapacity();
     for( int i = 0; i < triangles.count; ++i )
     {
@@ -1720,6 +2508,8 @@ void FastDecimate( BucketArray<TexturedVertex> const& vertices, BucketArray<i32>
         outIndices->data[i*3 + 1] = tri.indices[1];
         outIndices->data[i*3 + 2] = tri.indices[2];
     }
+
+    return result;
 }
 
 
@@ -1864,6 +2654,152 @@ ISO_SURFACE_FUNC( SimpleSurfaceFunc )
     return result;
 }
 
+ISO_SURFACE_GRADIENT_FUNC( SimpleSurfaceGradientFunc )
+{
+    ASSERT( samplingData->type == SamplingDataType::SimpleSurface );
+
+    SimpleSurfaceData* data = (SimpleSurfaceData*)samplingData;
+    int surfaceIndex = data->surfaceType;
+
+    // NOTE Don't care about translation
+    v3 const& invWorldP = Transform( data->invWorldTransform, worldP.relativeP );
+
+    SDFValue result = { F32INF, V3Zero };
+    switch( surfaceIndex )
+    {
+        case SimpleSurface::Torus().index:
+            result = SDFTorusGradient( invWorldP, 70, 30 );
+            break;
+        case SimpleSurface::HollowCube().index:
+            result = SDFHollowCubeGradient( invWorldP );
+            break;
+        case SimpleSurface::Devil().index:
+            result = SDFDevilGradient( invWorldP );
+            break;
+        case SimpleSurface::QuarticCylinder().index:
+            result = SDFQuarticCylinderGradient( invWorldP );
+            break;
+        case SimpleSurface::TangleCube().index:
+            result = SDFTangleCubeGradient( invWorldP );
+            break;
+        case SimpleSurface::Genus2().index:
+            result = SDFGenus2Gradient( invWorldP );
+            break;
+
+        case SimpleSurface::MechanicalPart().index:
+        {
+            SDFValue b = SDFBoxGradient( invWorldP, { 50, 50, 50 } );
+            SDFValue c = SDFCylinderGradient( invWorldP, 40 );
+            result = SDFUnion( b, c );
+
+            v3 yRotP = { invWorldP.z, invWorldP.y, invWorldP.x };
+            SDFValue c1 = SDFCylinderGradient( yRotP, 30 );
+            c1.gradient = { c1.gradient.z, c1.gradient.y, c1.gradient.x };
+            result = SDFSubstraction( result, c1 );
+            v3 zRotP = { -invWorldP.y, invWorldP.x, invWorldP.z };
+            SDFValue c2 = SDFCylinderGradient( zRotP, 30 );
+            c2.gradient = { c2.gradient.y, -c2.gradient.x, c2.gradient.z };
+            result = SDFSubstraction( result, c2 );
+        } break;
+    }
+
+    // Back to world space (chain rule, so through the transposed transform)
+    m4 const& m = data->invWorldTransform;
+    v3 const& g = result.gradient;
+    *gradient = { g.x * m.e[0][0] + g.y * m.e[1][0] + g.z * m.e[2][0],
+                  g.x * m.e[0][1] + g.y * m.e[1][1] + g.z * m.e[2][1],
+                  g.x * m.e[0][2] + g.y * m.e[1][2] + g.z * m.e[2][2] };
+    return result.d;
+}
+
+ISO_SURFACE_BATCH_FUNC( SimpleSurfaceBatchFunc )
+{
+    ASSERT( samplingData->type == SamplingDataType::SimpleSurface );
+
+    SimpleSurfaceData* data = (SimpleSurfaceData*)samplingData;
+    int surfaceIndex = data->surfaceType;
+
+    for( int i = 0; i < batch->count; i += LaneWidth )
+    {
+        // NOTE Don't care about translation
+        v3x4 invWorldP = Transform( data->invWorldTransform, LoadV3x4( batch->x + i, batch->y + i, batch->z + i ) );
+
+        f32x4 result = F32x4( F32INF );
+        switch( surfaceIndex )
+        {
+            case SimpleSurface::Torus().index:
+                result = SDFTorus( invWorldP, 70, 30 );
+                break;
+            case SimpleSurface::HollowCube().index:
+                result = SDFHollowCube( invWorldP );
+                break;
+            case SimpleSurface::Devil().index:
+                result = SDFDevil( invWorldP );
+                break;
+            case SimpleSurface::QuarticCylinder().index:
+                result = SDFQuarticCylinder( invWorldP );
+                break;
+            case SimpleSurface::TangleCube().index:
+                result = SDFTangleCube( invWorldP );
+                break;
+            case SimpleSurface::Genus2().index:
+                result = SDFGenus2( invWorldP );
+                break;
+
+            case SimpleSurface::MechanicalPart().index:
+            {
+                f32x4 b = SDFBox( invWorldP, { 50, 50, 50 } );
+                f32x4 c = SDFCylinder( invWorldP, 40 );
+                result = SDFUnion( b, c );
+
+                v3x4 yRotP = { invWorldP.z, invWorldP.y, invWorldP.x };
+                f32x4 c1 = SDFCylinder( yRotP, 30 );
+                result = SDFSubstraction( result, c1 );
+                v3x4 zRotP = { -invWorldP.y, invWorldP.x, invWorldP.z };
+                f32x4 c2 = SDFCylinder( zRotP, 30 );
+                result = SDFSubstraction( result, c2 );
+            } break;
+        }
+        StoreF32x4( batch->results + i, result );
+    }
+}
+
+ISO_SURFACE_RANGE_FUNC( SimpleSurfaceRangeFunc )
+{
+    ASSERT( samplingData->type == SamplingDataType::SimpleSurface );
+
+    SimpleSurfaceData* data = (SimpleSurfaceData*)samplingData;
+    int surfaceIndex = data->surfaceType;
+
+    aabb invRegion = Transform( data->invWorldTransform, region );
+
+    // Algebraic surfaces just can't be culled
+    interval result = Interval( -F32INF, F32INF );
+    switch( surfaceIndex )
+    {
+        case SimpleSurface::Torus().index:
+            result = SDFTorus( invRegion, 70, 30 );
+            break;
+
+        case SimpleSurface::MechanicalPart().index:
+        {
+            interval b = SDFBox( invRegion, { 50, 50, 50 } );
+            interval c = SDFCylinder( invRegion, 40 );
+            result = SDFUnion( b, c );
+
+            aabb yRotRegion = { { invRegion.center.z, invRegion.center.y, invRegion.center.x },
+                                { invRegion.halfSize.z, invRegion.halfSize.y, invRegion.halfSize.x } };
+            interval c1 = SDFCylinder( yRotRegion, 30 );
+            result = SDFSubstraction( result, c1 );
+            aabb zRotRegion = { { -invRegion.center.y, invRegion.center.x, invRegion.center.z },
+                                { invRegion.halfSize.y, invRegion.halfSize.x, invRegion.halfSize.z } };
+            interval c2 = SDFCylinder( zRotRegion, 30 );
+            result = SDFSubstraction( result, c2 );
+        } break;
+    }
+    return result;
+}
+
 
 
 
@@ -2952,7 +3888,8 @@ Mesh* ConvertToIsoSurfaceMesh( const Mesh& sourceMesh, f32 drawingDistance, int
     }
 
     Mesh* result = AllocateMeshFromScratchBuffers( meshPool );
-    result->bounds = bounds;
+    if( result )
+        result->bounds = bounds;
     return result;
 }
 
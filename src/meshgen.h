@@ -27,9 +27,23 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "data_types.h"
 #include "renderer.h"
 #include "debugstats.h"
+#include "platform.h"
 #endif
 
 
+// Set of points to be sampled together by an IsoSurfaceBatchFunc, in SoA form so each SIMD lane gets one point
+// All arrays have room for capacity rounded up to a multiple of LaneWidth
+struct IsoSurfaceBatch
+{
+    f32* x;
+    f32* y;
+    f32* z;
+    f32* results;
+
+    i32 count;
+    i32 capacity;
+};
+
 // 2D slice of a 3D sampled area, allowing reuse of sampled values and generated vertices
 struct IsoSurfaceSamplingCache
 {
@@ -40,16 +54,45 @@ struct IsoSurfaceSamplingCache
     i32* middleLayerVertexIndices;
     i32* topLayerVertexIndices;
 
+    // Used to sample each row of a layer in one go
+    IsoSurfaceBatch rowBatch;
+    // Case index for each cell in a row, and which of those cells actually cross the surface
+    i32* rowCaseIndices;
+    i32* rowActiveCells;
+
     v2i cellsPerAxis;
 };
 
+// Memory for all meshes, shared by all threads
+// Threads don't allocate from here directly, but grab big regions for their own MeshPool
+struct MeshHeap
+{
+    MemoryPool memoryPool;
+    TicketMutex mutex;
+};
+
+// Per-thread cache of mesh memory. Only the owner thread can allocate from it, but meshes can be released from any thread
 struct MeshPool
 {
     BucketArray<TexturedVertex> scratchVertices;
     BucketArray<i32> scratchIndices;
 
-    MemoryBlock memorySentinel;
+    MeshHeap* heap;
+    // Regions taken from the heap
+    MemoryPool memoryPool;
+    i32 regionCount;
     i32 meshCount; 
+
+    // Lock-free stack of meshes released by other threads, reclaimed by the owner on its next allocation
+    Mesh* volatile remoteFrees;
+};
+
+// Everything a worker thread needs to generate meshes on its own
+// NOTE Aligned so no two workers ever share a cache line
+struct alignas(64) MeshGeneratorWorkerData
+{
+    IsoSurfaceSamplingCache samplingCache;
+    MeshPool meshPool;
 };
 
 
@@ -104,8 +147,7 @@ struct MeshGeneratorJob
 {
     const StoredEntity*     storedEntity;
     const v3i*              worldOriginClusterP;
-    IsoSurfaceSamplingCache*   samplingCache;
-    MeshPool*               meshPools;
+    MeshGeneratorWorkerData*   workerData;
     LiveEntity*             outputEntity;
 
     volatile bool occupied;
@@ -174,6 +216,7 @@ enum SamplingDataType
 {
     ClusterData,
     SimpleSurface,
+    SDFProgramData,
 };
 
 struct SamplingData
@@ -241,35 +284,72 @@ struct DCSettings
     bool clampCellPoints;
 };
 
+#if !RELEASE
+// NOTE Lives in the debug storage, same as DEBUGglobalMemoryStats. Nothing is counted while this is null
+extern DCEdgeStats* DEBUGglobalDCEdgeStats;
+#endif
+
 
 
 #define ISO_SURFACE_FUNC(name) float name( WorldCoords const& worldP, SamplingData const* samplingData )
 typedef ISO_SURFACE_FUNC(IsoSurfaceFunc);
 
+// Same, but also returns the (unnormalized) gradient at the sampled point, so normals can be found without any extra sampling
+#define ISO_SURFACE_GRADIENT_FUNC(name) float name( WorldCoords const& worldP, SamplingData const* samplingData, v3* gradient )
+typedef ISO_SURFACE_GRADIENT_FUNC(IsoSurfaceGradientFunc);
+
+// Wide version which samples all points in the batch (given relative to the sector of the volume being sampled)
+// and writes their values to batch->results. Always called through SampleBatch()
+#define ISO_SURFACE_BATCH_FUNC(name) void name( IsoSurfaceBatch* batch, SamplingData const* samplingData )
+typedef ISO_SURFACE_BATCH_FUNC(IsoSurfaceBatchFunc);
+
+// Conservative bounds for all values the surface takes inside a region (given in the same space as batch points),
+// used to skip sampling blocks which can't contain any part of the surface. Optional for all contouring techniques
+#define ISO_SURFACE_RANGE_FUNC(name) interval name( aabb const& region, SamplingData const* samplingData )
+typedef ISO_SURFACE_RANGE_FUNC(IsoSurfaceRangeFunc);
+
 ISO_SURFACE_FUNC(RoomSurfaceFunc);
 ISO_SURFACE_FUNC( SimpleSurfaceFunc );
+ISO_SURFACE_GRADIENT_FUNC( SimpleSurfaceGradientFunc );
+ISO_SURFACE_BATCH_FUNC( SimpleSurfaceBatchFunc );
+ISO_SURFACE_RANGE_FUNC( SimpleSurfaceRangeFunc );
 
 
-void InitMeshPool( MeshPool* pool, MemoryArena* arena, sz size );
+void InitMeshHeap( MeshHeap* heap, MemoryArena* arena, sz size );
+void InitMeshPool( MeshPool* pool, MeshHeap* heap, MemoryArena* arena );
 Mesh* AllocateMesh( MeshPool* pool, int vertexCount, int indexCount );
 Mesh* AllocateMeshFromScratchBuffers( MeshPool* pool );
 void ClearScratchBuffers( MeshPool* pool );
 inline Mesh CreateMeshFromBuffers( BucketArray<TexturedVertex> const& vertices, BucketArray<i32> const& indices, MemoryArena* arena );
-void ReleaseMesh( Mesh** mesh );
+void ReleaseMesh( Mesh** mesh, MeshPool* callerPool );
+void ReclaimRemoteFrees( MeshPool* pool );
 
-IsoSurfaceSamplingCache InitSurfaceSamplingCache( MemoryArena* arena, v2i const& cellsPerAxis );
+IsoSurfaceBatch InitIsoSurfaceBatch( MemoryArena* arena, int capacity, MemoryParams params = DefaultMemoryParams() );
+void SampleBatch( IsoSurfaceBatchFunc* sampleBatchFunc, IsoSurfaceBatch* batch, SamplingData const* samplingData );
+
+IsoSurfaceSamplingCache InitSurfaceSamplingCache( MemoryArena* arena, v2i const& cellsPerAxis, MemoryParams params = DefaultMemoryParams() );
 void ClearVertexCaches( IsoSurfaceSamplingCache* samplingCache, bool clearBottomLayer );
 void SwapTopAndBottomLayers( IsoSurfaceSamplingCache* samplingCache );
 
 void MarchCube( const v3& cellCornerWorldP, const v2i& gridCellP, v2i const& cellsPerAxis, f32 cellSizeMeters,
                 IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices,
                 const bool interpolate = true );
-void MarchVolumeFast( WorldCoords const& worldP, v3 const& volumeSideMeters, f32 cellSizeMeters, IsoSurfaceFunc* sampleFunc,
-                 SamplingData const* samplingData, IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices,
-                 BucketArray<i32>* indices, const bool interpolate = true );
-
-void DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMeters, IsoSurfaceFunc* sampleFunc, SamplingData* samplingData,
-          BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices, MemoryArena* arena, MemoryArena* tmpArena, DCSettings const& settings );
+// When given a job queue, the volume is split in slabs along Z which are contoured in parallel (each with its own sampling cache)
+// and stitched together afterwards, otherwise it's all done in the given sampling cache (output is the same either way)
+// NOTE Slab output is copied to tmpArena from the worker threads, same as in DCVolume
+void MarchVolumeFast( WorldCoords const& worldP, v3 const& volumeSideMeters, f32 cellSizeMeters, IsoSurfaceBatchFunc* sampleBatchFunc,
+                 IsoSurfaceRangeFunc* rangeFunc, SamplingData const* samplingData, IsoSurfaceSamplingCache* samplingCache, BucketArray<TexturedVertex>* vertices,
+                 BucketArray<i32>* indices, MemoryArena* tmpArena, const bool interpolate = true, PlatformJobQueue* jobQueue = nullptr );
+
+// When given a job queue, the volume is split in slabs along Z which are contoured in parallel and stitched together afterwards
+// (output is the same either way)
+// NOTE Slabs copy their output to tmpArena from the worker threads as they finish, so it can't be the worker arena of a job
+// that's calling this
+void DCVolume( WorldCoords const& worldP, v3 const& volumeSizeMeters, f32 cellSizeMeters, IsoSurfaceFunc* sampleFunc,
+          IsoSurfaceBatchFunc* sampleBatchFunc, IsoSurfaceGradientFunc* gradientFunc, IsoSurfaceRangeFunc* rangeFunc,
+          SamplingData* samplingData,
+          BucketArray<TexturedVertex>* vertices, BucketArray<i32>* indices, MemoryArena* arena, MemoryArena* tmpArena, DCSettings const& settings,
+          PlatformJobQueue* jobQueue = nullptr );
 
 Mesh* ConvertToIsoSurfaceMesh( const Mesh& sourceMesh, f32 drawingDistance, int displayedLayer, IsoSurfaceSamplingCache* samplingCache,
                                MeshPool* meshPool, MemoryArena* tmpArena, RenderCommands* renderCommands );
@@ -61,7 +61,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifdef _WIN32
 #define LIB_EXPORT extern "C" __declspec(dllexport)
 #else
-#define LIB_EXPORT extern "C" __declspec(dllexport)
+#define LIB_EXPORT extern "C" __attribute__((visibility("default")))
 #endif
 
 #if COMPILER_MSVC
@@ -160,13 +160,83 @@ struct PlatformJobQueue;
 #define PLATFORM_JOBQUEUE_CALLBACK(name) void name( void* userData, int workerThreadIndex )
 typedef PLATFORM_JOBQUEUE_CALLBACK(PlatformJobQueueCallbackFunc);
 
+struct PlatformJobGroup;
+
+// A job that gets added to a queue once all the jobs in some other group have finished
+struct PlatformJobContinuation
+{
+    PlatformJobQueue* queue;
+    PlatformJobQueueCallbackFunc* callback;
+    void* userData;
+    PlatformJobGroup* group;
+};
+
+#define PLATFORM_MAX_JOB_CONTINUATIONS 8
+
+// Counts pending jobs so they can be waited on together, independently of any other jobs in the queues
+// (a group with a single job in it acts as a handle to that job). Groups can also have continuations, which
+// allows expressing whole graphs of dependent jobs.
+// NOTE Zero-initialize before use, and keep it alive and in place until all its jobs are finished!
+// NOTE Add all continuations to a group _before_ adding any jobs to it (i.e: build graphs from the end backwards),
+// and note that continuations of a group which never gets any jobs will never run.
+struct PlatformJobGroup
+{
+    volatile u32 pendingCount;
+
+    u32 continuationCount;
+    PlatformJobContinuation continuations[PLATFORM_MAX_JOB_CONTINUATIONS];
+};
+
+inline bool
+IsDone( PlatformJobGroup* group )
+{
+    return AtomicLoad( &group->pendingCount ) == 0;
+}
+
 #define PLATFORM_ADD_NEW_JOB(name) void name( PlatformJobQueue* queue, PlatformJobQueueCallbackFunc* callback, void* userData )
 typedef PLATFORM_ADD_NEW_JOB(PlatformAddNewJobFunc);
 
+// Same as above, but the job counts towards the given group (can be null)
+#define PLATFORM_ADD_GROUP_JOB(name) void name( PlatformJobQueue* queue, PlatformJobGroup* group, \
+                                                PlatformJobQueueCallbackFunc* callback, void* userData )
+typedef PLATFORM_ADD_GROUP_JOB(PlatformAddGroupJobFunc);
+
+// Batch version of the above. Adds one job per item in userDataArray (items are userDataStride bytes apart)
+#define PLATFORM_ADD_NEW_JOBS(name) void name( PlatformJobQueue* queue, PlatformJobGroup* group, PlatformJobQueueCallbackFunc* callback, \
+                                               void* userDataArray, sz userDataStride, i32 jobCount )
+typedef PLATFORM_ADD_NEW_JOBS(PlatformAddNewJobsFunc);
+
+// Adds a job to the given queue as soon as all jobs in 'dependency' are finished. The new job will count towards 'group' (can be null)
+#define PLATFORM_ADD_CONTINUATION(name) void name( PlatformJobGroup* dependency, PlatformJobQueue* queue, PlatformJobGroup* group, \
+                                                   PlatformJobQueueCallbackFunc* callback, void* userData )
+typedef PLATFORM_ADD_CONTINUATION(PlatformAddContinuationFunc);
+
+// Waits until all jobs in the group are done. The calling thread helps by running jobs from the queue in the meantime
+#define PLATFORM_WAIT_FOR_JOB_GROUP(name) void name( PlatformJobQueue* queue, PlatformJobGroup* group )
+typedef PLATFORM_WAIT_FOR_JOB_GROUP(PlatformWaitForJobGroupFunc);
+
+// Long running jobs in lower priority queues should call this periodically at safe points, and if it returns true,
+// save their progress and re-add themselves to the queue, so any pending higher priority work gets to run first.
+// It also returns true once the job has been running for longer than the yield budget (about a frame)
+#define PLATFORM_SHOULD_YIELD(name) bool name( PlatformJobQueue* queue )
+typedef PLATFORM_SHOULD_YIELD(PlatformShouldYieldFunc);
+
+// Until the platform knows its actual frame time
+#define PLATFORM_DEFAULT_YIELD_BUDGET_MILLIS (1000.0 / 60)
+
+// Scratch memory for the given worker thread (as passed to job callbacks), aligned so that no two workers share a cache line.
+// NOTE Reset automatically after every job, so nothing allocated here can outlive the job that allocated it
+#define PLATFORM_GET_WORKER_ARENA(name) MemoryArena* name( int workerThreadIndex )
+typedef PLATFORM_GET_WORKER_ARENA(PlatformGetWorkerArenaFunc);
+
+#define PLATFORM_WORKER_ARENA_SIZE GIGABYTES(1)
+
 #define PLATFORM_COMPLETE_ALL_JOBS(name) void name( PlatformJobQueue* queue )
 typedef PLATFORM_COMPLETE_ALL_JOBS(PlatformCompleteAllJobsFunc);
 
 #define PLATFORM_MAX_JOBQUEUE_JOBS 16768
+// Capacity of the queue shared by all threads (must be a power of 2)
+#define PLATFORM_SHARED_JOBQUEUE_JOBS 4096
 
 
 // Providing a handle means we're updating the texture data instead of creating it anew
@@ -196,10 +266,20 @@ struct PlatformAPI
     bool DEBUGquit;
 #endif
 
+    // NOTE Jobs can be added from any thread, including from inside other jobs. When the queue is full, pool threads
+    // will run queued jobs inline until there's room again (so don't add jobs while holding a lock other jobs may need!)
     PlatformAddNewJobFunc* AddNewJob;
+    PlatformAddGroupJobFunc* AddGroupJob;
+    PlatformAddNewJobsFunc* AddNewJobs;
+    PlatformAddContinuationFunc* AddContinuation;
+    PlatformWaitForJobGroupFunc* WaitForJobGroup;
+    PlatformShouldYieldFunc* ShouldYield;
+    PlatformGetWorkerArenaFunc* GetWorkerArena;
     PlatformCompleteAllJobsFunc* CompleteAllJobs;
+    // Frame-critical work
     PlatformJobQueue* hiPriorityQueue;
-    //PlatformJobQueue* loPriorityQueue;
+    // Background work. Only runs when there's nothing pending in the hi priority queue
+    PlatformJobQueue* loPriorityQueue;
     // NOTE Includes the main thread! (0)
     i32 coreThreadsCount;
 
@@ -211,6 +291,168 @@ struct PlatformAPI
 extern PlatformAPI globalPlatform;
 
 
+// Data-parallel helpers on top of the job system
+// The range is split into batches (or bricks in 3D) which are run as jobs in the given queue, while the calling thread
+// helps running them until they're all done. Each batch gets the scratch arena of the worker running it, which is reset
+// after every batch. Reductions should write one partial result per batch (see *BatchCount below) and combine them
+// in the optional reduce callback, which always runs on the calling thread, in batch order, so results are deterministic.
+// NOTE Ranges are half-open ([start, end))
+
+#define PARALLEL_FOR_FUNC(name) void name( i32 startIndex, i32 endIndex, i32 batchIndex, void* userData, MemoryArena* scratchArena )
+typedef PARALLEL_FOR_FUNC(ParallelForFunc);
+
+#define PARALLEL_FOR_3D_FUNC(name) void name( v3i const& start, v3i const& end, i32 brickIndex, void* userData, MemoryArena* scratchArena )
+typedef PARALLEL_FOR_3D_FUNC(ParallelFor3DFunc);
+
+#define PARALLEL_REDUCE_FUNC(name) void name( i32 batchIndex, void* userData )
+typedef PARALLEL_REDUCE_FUNC(ParallelReduceFunc);
+
+struct ParallelForContext
+{
+    ParallelForFunc* func;
+    ParallelFor3DFunc* func3D;
+    void* userData;
+
+    v3i start;
+    v3i end;
+    v3i batchSize;
+    // Number of batches along each axis
+    v3i batchCounts;
+};
+
+struct ParallelForBatch
+{
+    ParallelForContext* context;
+    i32 batchIndex;
+};
+
+inline i32
+ParallelForBatchCount( i32 count, i32 batchSize )
+{
+    ASSERT( batchSize > 0 );
+    i32 result = count > 0 ? (count + batchSize - 1) / batchSize : 0;
+    return result;
+}
+
+// Memory the ParallelFor* functions below take from their tmpArena for the given number of batches
+inline sz
+ParallelForTmpArenaSize( i32 batchCount )
+{
+    sz result = batchCount * sizeof(ParallelForBatch);
+    return result;
+}
+
+inline v3i
+ParallelFor3DBrickCounts( v3i const& start, v3i const& end, v3i const& brickSize )
+{
+    v3i result = V3i( ParallelForBatchCount( end.x - start.x, brickSize.x ),
+                      ParallelForBatchCount( end.y - start.y, brickSize.y ),
+                      ParallelForBatchCount( end.z - start.z, brickSize.z ) );
+    return result;
+}
+
+inline i32
+ParallelFor3DBrickCount( v3i const& start, v3i const& end, v3i const& brickSize )
+{
+    v3i counts = ParallelFor3DBrickCounts( start, end, brickSize );
+    return counts.x * counts.y * counts.z;
+}
+
+internal
+PLATFORM_JOBQUEUE_CALLBACK(ParallelForJob)
+{
+    ParallelForBatch* batch = (ParallelForBatch*)userData;
+    ParallelForContext* context = batch->context;
+    MemoryArena* scratchArena = globalPlatform.GetWorkerArena( workerThreadIndex );
+
+    if( context->func3D )
+    {
+        // Bricks are numbered in the same order as Grid3D cells (X first)
+        i32 index = batch->batchIndex;
+        v3i brickP = V3i( index % context->batchCounts.x,
+                          (index / context->batchCounts.x) % context->batchCounts.y,
+                          index / (context->batchCounts.x * context->batchCounts.y) );
+
+        v3i start = context->start + V3i( brickP.x * context->batchSize.x,
+                                          brickP.y * context->batchSize.y,
+                                          brickP.z * context->batchSize.z );
+        v3i end = V3i( Min( start.x + context->batchSize.x, context->end.x ),
+                       Min( start.y + context->batchSize.y, context->end.y ),
+                       Min( start.z + context->batchSize.z, context->end.z ) );
+
+        context->func3D( start, end, batch->batchIndex, context->userData, scratchArena );
+    }
+    else
+    {
+        i32 startIndex = context->start.x + batch->batchIndex * context->batchSize.x;
+        i32 endIndex = Min( startIndex + context->batchSize.x, context->end.x );
+
+        context->func( startIndex, endIndex, batch->batchIndex, context->userData, scratchArena );
+    }
+}
+
+internal void
+RunParallelFor( PlatformJobQueue* queue, ParallelForContext* context, i32 batchCount, ParallelReduceFunc* reduce,
+                MemoryArena* tmpArena )
+{
+    if( batchCount > 0 )
+    {
+        TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
+
+        ParallelForBatch* batches = PUSH_ARRAY( tmpArena, ParallelForBatch, batchCount, Temporary() );
+        for( int i = 0; i < batchCount; ++i )
+            batches[i] = { context, i };
+
+        PlatformJobGroup group = {};
+        globalPlatform.AddNewJobs( queue, &group, ParallelForJob, batches, sizeof(ParallelForBatch), batchCount );
+        globalPlatform.WaitForJobGroup( queue, &group );
+
+        EndTemporaryMemory( tmpMemory );
+
+        if( reduce )
+        {
+            for( int i = 0; i < batchCount; ++i )
+                reduce( i, context->userData );
+        }
+    }
+}
+
+// Runs func for every batch of (at most) batchSize consecutive indices in [startIndex, endIndex)
+// NOTE tmpArena is only used for bookkeeping, and must not be used by any other thread until this returns
+internal void
+ParallelFor( PlatformJobQueue* queue, i32 startIndex, i32 endIndex, i32 batchSize, ParallelForFunc* func, void* userData,
+             MemoryArena* tmpArena, ParallelReduceFunc* reduce = nullptr )
+{
+    ParallelForContext context = {};
+    context.func = func;
+    context.userData = userData;
+    context.start = V3i( startIndex, 0, 0 );
+    context.end = V3i( endIndex, 0, 0 );
+    context.batchSize = V3i( batchSize, 0, 0 );
+
+    RunParallelFor( queue, &context, ParallelForBatchCount( endIndex - startIndex, batchSize ), reduce, tmpArena );
+}
+
+// Runs func for every brick of (at most) brickSize cells in the box [start, end). Bricks should be small enough
+// to stay in cache (and to keep all workers busy), but big enough to amortize the cost of a job
+// NOTE tmpArena is only used for bookkeeping, and must not be used by any other thread until this returns
+internal void
+ParallelFor3D( PlatformJobQueue* queue, v3i const& start, v3i const& end, v3i const& brickSize, ParallelFor3DFunc* func,
+               void* userData, MemoryArena* tmpArena, ParallelReduceFunc* reduce = nullptr )
+{
+    ParallelForContext context = {};
+    context.func3D = func;
+    context.userData = userData;
+    context.start = start;
+    context.end = end;
+    context.batchSize = brickSize;
+    context.batchCounts = ParallelFor3DBrickCounts( start, end, brickSize );
+
+    i32 brickCount = context.batchCounts.x * context.batchCounts.y * context.batchCounts.z;
+    RunParallelFor( queue, &context, brickCount, reduce, tmpArena );
+}
+
+
 ASSERT_HANDLER(DefaultAssertHandler)
 {
     LOG( "ASSERTION FAILED! :: '%s' (%s@%d)\n", msg, file, line );
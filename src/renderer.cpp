@@ -464,23 +464,49 @@ void RenderVoxelGrid( ClusterVoxelGrid const& voxelGrid, v3 const& clusterOffset
         // Per instance data
         InstanceData data = {};
         int instanceCount = 0;
-        u8 const* grid = voxelGrid.data;
+        const int brickSize = ClusterVoxelGrid::BrickSize;
 
-        for( int k = 0; k < VoxelsPerClusterAxis; ++k )
-            for( int j = 0; j < VoxelsPerClusterAxis; ++j )
-                for( int i = 0; i < VoxelsPerClusterAxis; ++i )
-                {
-                    //u8 voxelData = voxelGrid( i, j, k );
-                    u8 voxelData = *grid++;
-                    if( voxelData > 1 )
+        // Only visit bricks that have something in them
+        for( ClusterVoxelGrid::DenseBrick const* brick = voxelGrid.firstDenseBrick; brick; brick = brick->next )
+        {
+            v3i brickP = voxelGrid.BrickOrigin( brick->brickIndex );
+            u8 const* cell = brick->cells;
+
+            for( int k = 0; k < brickSize; ++k )
+                for( int j = 0; j < brickSize; ++j )
+                    for( int i = 0; i < brickSize; ++i )
                     {
-                        data.worldOffset = clusterOffsetP + V3( (f32)i, (f32)j, (f32)k ) * VoxelSizeMeters;
-                        data.color = voxelData == 2 ? Pack01ToRGBA( 1, 0, 1, 1 ) : Pack01ToRGBA( 0, 0, 1, 1 );
+                        u8 voxelData = *cell++;
+                        if( voxelData > 1 )
+                        {
+                            data.worldOffset = clusterOffsetP + V3( brickP + V3i( i, j, k ) ) * VoxelSizeMeters;
+                            data.color = voxelData == 2 ? Pack01ToRGBA( 1, 0, 1, 1 ) : Pack01ToRGBA( 0, 0, 1, 1 );
+                            PushInstanceData( data, commands );
+
+                            instanceCount++;
+                        }
+                    }
+        }
+
+        // Bricks which are still uniform are either completely filled or completely empty
+        for( int b = 0; b < voxelGrid.BrickCount(); ++b )
+        {
+            u8 voxelData = voxelGrid.uniformValues[b];
+            if( voxelGrid.denseBricks[b] || voxelData <= 1 )
+                continue;
+
+            v3i brickP = voxelGrid.BrickOrigin( b );
+            data.color = voxelData == 2 ? Pack01ToRGBA( 1, 0, 1, 1 ) : Pack01ToRGBA( 0, 0, 1, 1 );
+            for( int k = 0; k < brickSize; ++k )
+                for( int j = 0; j < brickSize; ++j )
+                    for( int i = 0; i < brickSize; ++i )
+                    {
+                        data.worldOffset = clusterOffsetP + V3( brickP + V3i( i, j, k ) ) * VoxelSizeMeters;
                         PushInstanceData( data, commands );
 
                         instanceCount++;
                     }
-                }
+        }
 
         entry->instanceCount = instanceCount;
     }
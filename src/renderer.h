@@ -382,7 +382,7 @@ ResetRenderCommands( RenderCommands *commands )
 
 
 struct Cluster;
-typedef Grid3D<u8> ClusterVoxelGrid;
+typedef BrickGrid3D<u8> ClusterVoxelGrid;
 
 void RenderClear( const v4& color, RenderCommands *commands );
 void RenderQuad( const v3 &p1, const v3 &p2, const v3 &p3, const v3 &p4, u32 color, RenderCommands *commands );
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "game.h"
 
 #include "meshgen.h"
+#include "sdf.h"
 #include "world.h"
 #include "wfc.h"
 #include "asset_loaders.h"
@@ -68,6 +69,7 @@ void  LibFree( void* p );
 #include "asset_loaders.cpp"
 #include "wfc.cpp"
 #include "meshgen.cpp"
+#include "sdf.cpp"
 #include "world.cpp"
 #include "editor.cpp"
 
@@ -79,6 +81,8 @@ internal GameConsole *gameConsole;
 internal MemoryArena* auxArena;
 #if !RELEASE
 bool* DEBUGglobalQuit;
+MemoryTagStats* DEBUGglobalMemoryStats;
+DCEdgeStats* DEBUGglobalDCEdgeStats;
 #endif
 
 
@@ -86,7 +90,7 @@ bool* DEBUGglobalQuit;
 void*
 LibMalloc( sz size )
 {
-    void* result = PUSH_SIZE( auxArena, size );
+    void* result = PUSH_SIZE( auxArena, size, Tagged( MemoryTag::UI() ) );
     return result;
 }
 
@@ -133,6 +137,8 @@ GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
     globalPlatform = *memory->platformAPI;
 #if !RELEASE
     DEBUGglobalQuit = &memory->platformAPI->DEBUGquit;
+    DEBUGglobalMemoryStats = ((DebugState*)memory->debugStorage)->memoryStats;
+    DEBUGglobalDCEdgeStats = &((DebugState*)memory->debugStorage)->dcEdgeStats;
 #endif
 
     TIMED_FUNC;
@@ -147,11 +153,14 @@ GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
     {
         InitArena( &gameState->worldArena,
                    (u8 *)memory->permanentStorage + sizeof(GameState),
-                   memory->permanentStorageSize - sizeof(GameState) );
+                   memory->permanentStorageSize - sizeof(GameState), memory->storageBacking );
 
         InitArena( &gameState->transientArena,
                    (u8 *)memory->transientStorage + sizeof(TransientState),
-                   memory->transientStorageSize - sizeof(TransientState) );
+                   memory->transientStorageSize - sizeof(TransientState), memory->storageBacking );
+
+        SetArenaTag( &gameState->worldArena, MemoryTag::World() );
+        SetArenaTag( &gameState->transientArena, MemoryTag::Scratch() );
 
         // TODO Remove this
         auxArena = &gameState->worldArena;
@@ -216,10 +225,15 @@ GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
     float frameTime = 1000.f / fps;
     char statsText[1024];
     snprintf( statsText, ARRAYCOUNT(statsText),
-              "Frame ms.: %.3f (%.1f FPS)   Live entitites %u   Meshes %u   Instances %u   Primitives %u   Vertices %u (+ %u)  DrawCalls %u",
+              "Frame ms.: %.3f (%.1f FPS)   Live entitites %u   Meshes %u   Instances %u   Primitives %u   Vertices %u (+ %u)  DrawCalls %u"
+              "   Clusters %d (%.1f MB)  Hits %u  Misses %u  Evictions %u  DC samples/edge %.2f",
               frameTime, fps, debugState->totalEntities, debugState->totalMeshCount, debugState->totalInstanceCount,
               debugState->totalPrimitiveCount, debugState->totalVertexCount, debugState->totalGeneratedVerticesCount,
-              debugState->totalDrawCalls );
+              debugState->totalDrawCalls, debugState->residentClusterCount,
+              (f64)debugState->residentClusterBytes / MEGABYTES(1), debugState->clusterCacheHits,
+              debugState->clusterCacheMisses, debugState->clusterCacheEvictions,
+              debugState->dcEdgeStats.crossingCount ?
+                  (f64)debugState->dcEdgeStats.sampleCount / debugState->dcEdgeStats.crossingCount : 0.0 );
 
     if( memory->DEBUGglobalEditing )
     {
@@ -0,0 +1,190 @@
+/*
+The MIT License
+
+Copyright (c) 2017 Oscar Peñas Pariente <oscarpp80@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef __SDF_H__
+#define __SDF_H__
+
+#if NON_UNITY_BUILD
+#include "data_types.h"
+#include "meshgen.h"
+#endif
+
+// SDFs described as data: a graph of primitives, CSG operations and transforms is built once (usually in some arena
+// that lives as long as whatever it describes), and then compiled for the region that is going to be sampled into
+// a flat program that a small interpreter can run over whole batches of points.
+// Compiling folds transforms into the primitives, folds constants, and drops any bounded operations that can't
+// affect the compiled region.
+
+
+enum class SDFNodeType : u8
+{
+    Constant,
+    // Primitives
+    Box,
+    Cylinder,
+    Torus,
+    HollowCube,
+    Devil,
+    QuarticCylinder,
+    TangleCube,
+    Genus2,
+    // Transforms (apply to the point the child is sampled at)
+    Translate,
+    Transform,
+    // Operations
+    Union,
+    Substraction,
+    Intersection,
+    Onion,
+    // Only apply the operation to points inside the given bounds (otherwise the result is just the first child)
+    BoundedUnion,
+    BoundedSubstraction,
+};
+
+struct SDFNode
+{
+    SDFNodeType type;
+    // Onion only: skip it when sampling with SamplingData::zeroThickness
+    bool optional;
+
+    SDFNode* children[2];
+
+    union
+    {
+        f32 value;
+        // Box
+        struct
+        {
+            v3 halfSize;
+            f32 radius;
+        } box;
+        // Cylinder, Torus, Onion
+        struct
+        {
+            f32 radius;
+            f32 thickness;
+        } round;
+        v3 translation;
+        // Inverse transform, from world to child space
+        m4 transform;
+        aabb bounds;
+    };
+};
+
+SDFNode* PushSDFConstant( MemoryArena* arena, f32 value );
+SDFNode* PushSDFBox( MemoryArena* arena, v3 const& halfSize, f32 radius = 0.f );
+SDFNode* PushSDFCylinder( MemoryArena* arena, f32 radius );
+SDFNode* PushSDFTorus( MemoryArena* arena, f32 radius, f32 thickness );
+// For all the parameterless primitives
+SDFNode* PushSDFPrimitive( MemoryArena* arena, SDFNodeType type );
+
+SDFNode* PushSDFTranslate( MemoryArena* arena, SDFNode* child, v3 const& translation );
+SDFNode* PushSDFTransform( MemoryArena* arena, SDFNode* child, m4 const& invTransform );
+
+SDFNode* PushSDFUnion( MemoryArena* arena, SDFNode* a, SDFNode* b );
+SDFNode* PushSDFSubstraction( MemoryArena* arena, SDFNode* a, SDFNode* b );
+SDFNode* PushSDFIntersection( MemoryArena* arena, SDFNode* a, SDFNode* b );
+SDFNode* PushSDFOnion( MemoryArena* arena, SDFNode* child, f32 thickness, bool optional = false );
+SDFNode* PushSDFBoundedUnion( MemoryArena* arena, SDFNode* a, SDFNode* b, aabb const& bounds );
+SDFNode* PushSDFBoundedSubstraction( MemoryArena* arena, SDFNode* a, SDFNode* b, aabb const& bounds );
+
+
+enum class SDFOpCode : u8
+{
+    Constant,
+    Box,
+    Cylinder,
+    Torus,
+    HollowCube,
+    Devil,
+    QuarticCylinder,
+    TangleCube,
+    Genus2,
+    Union,
+    Substraction,
+    Intersection,
+    Onion,
+    // Bounded ops are split in two: the begin tests the bounds and skips over the second operand entirely
+    // if no lanes are inside, the end combines both operands
+    BeginBounded,
+    EndBoundedUnion,
+    EndBoundedSubstraction,
+};
+
+enum SDFInstructionFlags
+{
+    SDFInstruction_Translated = 0x1,        // Params start with a translation
+    SDFInstruction_Transformed = 0x2,       // Params start with a 3x4 matrix
+    SDFInstruction_Optional = 0x4,          // Skipped when sampling with zero thickness
+};
+
+struct SDFInstruction
+{
+    SDFOpCode op;
+    u8 flags;
+    // BeginBounded only: instructions to skip to get past the matching end
+    u16 skipCount;
+
+    union
+    {
+        // Constants are stored inline, everything else in the params array
+        f32 value;
+        u32 paramOffset;
+    };
+};
+
+// Max depth of the evaluation stack (left-leaning graphs only ever need 2 or 3 slots)
+const int SDFMaxStackDepth = 16;
+
+struct SDFProgram
+{
+    Array<SDFInstruction> instructions;
+    Array<f32> params;
+};
+
+SDFProgram CompileSDFProgram( SDFNode const* root, aabb const& region, MemoryArena* arena, MemoryParams params = DefaultMemoryParams() );
+void EvaluateSDFProgram( SDFProgram const& program, IsoSurfaceBatch* batch, bool zeroThickness );
+// Conservative bounds for all values inside the region
+interval EvaluateSDFProgramRange( SDFProgram const& program, aabb const& region, bool zeroThickness );
+
+
+struct SDFProgramSamplingData
+{
+    SamplingData header;
+
+    SDFProgram const* program;
+};
+
+SDFProgramSamplingData InitSDFProgramSamplingData( SDFProgram const* program )
+{
+    SamplingData header = { SamplingDataType::SDFProgramData, true };
+    SDFProgramSamplingData result = { header, program };
+
+    return result;
+}
+
+ISO_SURFACE_FUNC( SDFProgramSurfaceFunc );
+ISO_SURFACE_GRADIENT_FUNC( SDFProgramSurfaceGradientFunc );
+ISO_SURFACE_BATCH_FUNC( SDFProgramSurfaceBatchFunc );
+ISO_SURFACE_RANGE_FUNC( SDFProgramSurfaceRangeFunc );
+
+#endif /* __SDF_H__ */
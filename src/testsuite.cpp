@@ -36,23 +36,37 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "intrinsics.h"
 #include "memory.h"
 #include "math_types.h"
+#include "math_sdf.h"
 #include "math.h"
 #include "data_types.h"
 #include "util.h"
+#include "macro_madness.h"
+#include "platform.h"
+#include "debugstats.h"
+#include "renderer.h"
+#include "meshgen.h"
+#include "sdf.h"
+#include "world.h"
+
 #include "util.cpp"
+#include "renderer.cpp"
+#include "meshgen.cpp"
+#include "sdf.cpp"
 
 
 internal f64 globalCounterFreqSecs = 0.0;
 internal i64 globalCounterStart;
+// Only Log is set (see main)
+PlatformAPI globalPlatform;
+#if !RELEASE
+// Memory tags & DC stats are not tracked in the tests
+MemoryTagStats* DEBUGglobalMemoryStats = nullptr;
+DCEdgeStats* DEBUGglobalDCEdgeStats = nullptr;
+#endif
 
 u64 __rdtsc_start;
 #define TIME(f) ( __rdtsc_start = ReadCycles(), f, ReadCycles() - __rdtsc_start )
 
-ASSERT_HANDLER(DefaultAssertHandler)
-{
-    printf( "ASSERTION FAILED! :: '%s' (%s@%d)\n", msg, file, line );
-}
-
 // TODO Print error messages
 #define EXPECT_TRUE(expr) ((void)( (expr) || HALT()))
 #define ASSERT_TRUE(expr) ((void)( (expr) || HALT()))
@@ -730,11 +744,1471 @@ void TestFastSqrtSpeed( MemoryArena* tmpArena )
 }
 
 
+/////     WIDE SDF     /////
+
+// Wide SDF versions must give exactly the same results as the scalar ones, or meshes would change depending on the sampling path
+void TestWideSDF()
+{
+    const int pointCount = 100000;
+
+    for( int n = 0; n < pointCount; n += LaneWidth )
+    {
+        f32 xs[LaneWidth], ys[LaneWidth], zs[LaneWidth];
+        for( int l = 0; l < LaneWidth; ++l )
+        {
+            xs[l] = RandomRangeF32( -100.f, 100.f );
+            ys[l] = RandomRangeF32( -100.f, 100.f );
+            zs[l] = RandomRangeF32( -100.f, 100.f );
+        }
+        v3x4 p = LoadV3x4( xs, ys, zs );
+
+        f32 box[LaneWidth], torus[LaneWidth], onion[LaneWidth], cylinder[LaneWidth], genus2[LaneWidth], devil[LaneWidth];
+        StoreF32x4( box, SDFBox( p, V3( 50.f, 30.f, 70.f ), 2.f ) );
+        StoreF32x4( torus, SDFTorus( p, 70, 30 ) );
+        StoreF32x4( onion, SDFOnion( SDFSubstraction( SDFBox( p, V3( 60.f ) ), SDFCylinder( p, 40 ) ), 0.5f ) );
+        StoreF32x4( cylinder, SDFUnion( SDFCylinder( p, 30 ), SDFQuarticCylinder( p ) ) );
+        StoreF32x4( genus2, SDFIntersection( SDFGenus2( p ), SDFHollowCube( p ) ) );
+        StoreF32x4( devil, SDFDevil( p ) + SDFTangleCube( p ) );
+
+        for( int l = 0; l < LaneWidth; ++l )
+        {
+            v3 q = V3( xs[l], ys[l], zs[l] );
+
+            ASSERT_TRUE( box[l] == SDFBox( q, V3( 50.f, 30.f, 70.f ), 2.f ) );
+            ASSERT_TRUE( torus[l] == SDFTorus( q, 70, 30 ) );
+            ASSERT_TRUE( onion[l] == SDFOnion( SDFSubstraction( SDFBox( q, V3( 60.f ) ), SDFCylinder( q, 40 ) ), 0.5f ) );
+            ASSERT_TRUE( cylinder[l] == SDFUnion( SDFCylinder( q, 30 ), SDFQuarticCylinder( q ) ) );
+            ASSERT_TRUE( genus2[l] == SDFIntersection( SDFGenus2( q ), SDFHollowCube( q ) ) );
+            ASSERT_TRUE( devil[l] == SDFDevil( q ) + SDFTangleCube( q ) );
+        }
+    }
+}
+
+// Same surface as the program built in TestSDFProgram, written by hand like the cluster sampling functions
+internal f32
+SDFProgramReference( v3 const& p, aabb const hallBounds[2], aabb const& roomBounds, bool zeroThickness )
+{
+    f32 result = F32MAX;
+    for( int h = 0; h < 2; ++h )
+    {
+        if( ContainsOrTouches( hallBounds[h], p ) )
+            result = SDFUnion( result, SDFBox( p - hallBounds[h].center, hallBounds[h].halfSize - V3( 2.f ) ) );
+    }
+    if( !zeroThickness )
+        result = SDFOnion( result, 1.f );
+
+    if( ContainsOrTouches( roomBounds, p ) )
+        result = SDFSubstraction( result, SDFBox( p - roomBounds.center, roomBounds.halfSize - V3( 2.f ) ) );
+
+    v3 zRotP = { -p.y, p.x, p.z };
+    result = SDFUnion( result, SDFIntersection( SDFCylinder( zRotP, 20.f ), SDFTorus( p - V3( 0.f, 0.f, 60.f ), 70, 30 ) ) );
+    return result;
+}
+
+// Compiled programs must give exactly the same results as the same SDF written by hand, no matter which path samples them
+// or which region they were compiled for
+void TestSDFProgram( MemoryArena* tmpArena )
+{
+    TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
+    // Graph nodes are not temporary allocations
+    MemoryArena graphArena = MakeSubArena( tmpArena, KILOBYTES(64), Temporary() );
+
+    const aabb hallBounds[2] = { AABBCenterSize( V3( -20.f, 0.f, 0.f ), V3( 140.f, 30.f, 30.f ) ),
+                                 AABBCenterSize( V3( 30.f, 10.f, 0.f ), V3( 30.f, 150.f, 40.f ) ) };
+    const aabb roomBounds = AABBCenterSize( V3( 30.f, 40.f, 0.f ), V3( 50.f, 50.f, 50.f ) );
+    // Rotates 90 degrees around Z (exactly, so it matches the hand-written version)
+    const m4 zRotation =
+    {{
+         { 0, -1, 0, 0 },
+         { 1,  0, 0, 0 },
+         { 0,  0, 1, 0 },
+         { 0,  0, 0, 1 }
+    }};
+
+    SDFNode* root = PushSDFConstant( &graphArena, F32MAX );
+    for( int h = 0; h < 2; ++h )
+    {
+        SDFNode* hall = PushSDFTranslate( &graphArena, PushSDFBox( &graphArena, hallBounds[h].halfSize - V3( 2.f ) ), hallBounds[h].center );
+        root = PushSDFBoundedUnion( &graphArena, root, hall, hallBounds[h] );
+    }
+    root = PushSDFOnion( &graphArena, root, 1.f, true );
+    SDFNode* room = PushSDFTranslate( &graphArena, PushSDFBox( &graphArena, roomBounds.halfSize - V3( 2.f ) ), roomBounds.center );
+    root = PushSDFBoundedSubstraction( &graphArena, root, room, roomBounds );
+    SDFNode* ring = PushSDFIntersection( &graphArena, PushSDFTransform( &graphArena, PushSDFCylinder( &graphArena, 20.f ), zRotation ),
+                                         PushSDFTranslate( &graphArena, PushSDFTorus( &graphArena, 70, 30 ), V3( 0.f, 0.f, 60.f ) ) );
+    root = PushSDFUnion( &graphArena, root, ring );
+
+    // One program for the whole thing, and one for a region well inside the first hall and away from the room,
+    // where both bounded ops should have been compiled away
+    const aabb fullRegion = AABBCenterSize( V3Zero, V3( 200.f ) );
+    const aabb hallRegion = AABBCenterSize( V3( -60.f, 0.f, 0.f ), V3( 20.f ) );
+    SDFProgram fullProgram = CompileSDFProgram( root, fullRegion, tmpArena, Temporary() );
+    SDFProgram hallProgram = CompileSDFProgram( root, hallRegion, tmpArena, Temporary() );
+    ASSERT_TRUE( hallProgram.instructions.count < fullProgram.instructions.count );
+    for( int i = 0; i < hallProgram.instructions.count; ++i )
+        ASSERT_TRUE( hallProgram.instructions[i].op != SDFOpCode::BeginBounded );
+
+    const int pointCount = 10000;
+    IsoSurfaceBatch batch = InitIsoSurfaceBatch( tmpArena, pointCount, Temporary() );
+
+    for( int t = 0; t < 2; ++t )
+    {
+        bool zeroThickness = t != 0;
+        SDFProgram const* programs[2] = { &fullProgram, &hallProgram };
+
+        for( int r = 0; r < 2; ++r )
+        {
+            aabb const& region = r == 0 ? fullRegion : hallRegion;
+            SDFProgramSamplingData samplingData = InitSDFProgramSamplingData( programs[r] );
+            samplingData.header.zeroThickness = zeroThickness;
+
+            batch.count = 0;
+            for( int n = 0; n < pointCount; ++n )
+            {
+                v3 p = region.center + V3( RandomRangeF32( -region.halfSize.x, region.halfSize.x ),
+                                           RandomRangeF32( -region.halfSize.y, region.halfSize.y ),
+                                           RandomRangeF32( -region.halfSize.z, region.halfSize.z ) );
+                AddBatchPoint( &batch, p );
+            }
+            SDFProgramSurfaceBatchFunc( &batch, (SamplingData*)&samplingData );
+
+            for( int n = 0; n < batch.count; ++n )
+            {
+                WorldCoords p = { V3( batch.x[n], batch.y[n], batch.z[n] ), V3iZero };
+                f32 expected = SDFProgramReference( p.relativeP, hallBounds, roomBounds, zeroThickness );
+
+                ASSERT_TRUE( batch.results[n] == expected );
+                ASSERT_TRUE( SDFProgramSurfaceFunc( p, (SamplingData*)&samplingData ) == expected );
+                v3 gradient;
+                ASSERT_TRUE( SDFProgramSurfaceGradientFunc( p, (SamplingData*)&samplingData, &gradient ) == expected );
+
+                // Ranges must be conservative
+                aabb cellRegion = AABBCenterSize( p.relativeP, V3( 2.f ) );
+                interval range = SDFProgramSurfaceRangeFunc( cellRegion, (SamplingData*)&samplingData );
+                ASSERT_TRUE( range.min <= expected && expected <= range.max );
+            }
+        }
+    }
+
+    EndTemporaryMemory( tmpMemory );
+}
+
+// Analytic gradients must match central differences, except right at the creases of the surface
+internal bool
+GradientMatches( SDFValue const& value, f32 dx, f32 dy, f32 dz )
+{
+    v3 numeric = V3( dx, dy, dz );
+    if( LengthSq( numeric ) == 0.f || LengthSq( value.gradient ) == 0.f )
+        return false;
+
+    return Dot( NormalizedSlow( numeric ), NormalizedSlow( value.gradient ) ) > 0.999f;
+}
+
+// The creases we know about. A point counts as being 'near' one when the differencing stencil around it could reach across
+// (with some margin, as the fields aren't linear)
+
+// Two operands of a union / intersection / substraction swap over
+internal bool
+NearTie( SDFValue const& a, SDFValue const& b, f32 delta )
+{
+    return Abs( a.d - b.d ) <= 2.f * delta * (LengthSlow( a.gradient ) + LengthSlow( b.gradient ));
+}
+
+// The medial planes inside a box, where the closest face changes, and its edges & corners, where the field curves too sharply
+internal bool
+NearBoxCrease( v3 const& p, v3 const& hdim, f32 delta )
+{
+    const v3 d = Abs( p ) - hdim;
+    f32 maxD = Max( d.x, Max( d.y, d.z ) );
+    f32 secondD = d.x == maxD ? Max( d.y, d.z ) : d.y == maxD ? Max( d.x, d.z ) : Max( d.x, d.y );
+
+    if( maxD <= delta )
+        return maxD - secondD <= 2.f * delta;
+    else
+        return secondD >= -delta && maxD <= 20.f * delta;
+}
+
+// The surface itself, for the onion (which folds the field over at zero)
+internal bool
+NearZero( SDFValue const& value, f32 delta )
+{
+    return Abs( value.d ) <= 2.f * delta * LengthSlow( value.gradient );
+}
+
+// Critical points of the algebraic surfaces, or anywhere the differences would be lost to float rounding
+internal bool
+NearFlat( SDFValue const& value, f32 delta )
+{
+    return LengthSlow( value.gradient ) * delta <= 1e-5f * Abs( value.d ) + 1e-3f;
+}
+
+#define CHECK_GRADIENT( gradientCall, valueCall, nearKink )                                 \
+    {                                                                                       \
+        v3 q = p;                                                                           \
+        SDFValue value = gradientCall;                                                      \
+        ASSERT_TRUE( value.d == valueCall );                                                \
+                                                                                            \
+        f32 diffs[3];                                                                       \
+        for( int a = 0; a < 3; ++a )                                                        \
+        {                                                                                   \
+            q = p + deltas[a];                                                              \
+            f32 next = valueCall;                                                           \
+            q = p - deltas[a];                                                              \
+            diffs[a] = next - (valueCall);                                                  \
+        }                                                                                   \
+        if( !(nearKink) )                                                                   \
+            ASSERT_TRUE( GradientMatches( value, diffs[0], diffs[1], diffs[2] ) );          \
+    }
+
+void TestSDFGradients()
+{
+    const int pointCount = 10000;
+    const f32 delta = 0.01f;
+    const v3 deltas[3] = { { delta, 0.f, 0.f }, { 0.f, delta, 0.f }, { 0.f, 0.f, delta } };
+
+    for( int n = 0; n < pointCount; ++n )
+    {
+        v3 p = V3( RandomRangeF32( -100.f, 100.f ), RandomRangeF32( -100.f, 100.f ), RandomRangeF32( -100.f, 100.f ) );
+
+        f32 lxy = Length( p.xy );
+        f32 lq = Length( V2( lxy - 70.f, p.z ) );
+        SDFValue box60 = SDFBoxGradient( p, V3( 60.f ) );
+        SDFValue cyl40 = SDFCylinderGradient( p, 40 );
+        SDFValue notCyl40 = { -cyl40.d, -cyl40.gradient };
+        SDFValue cyl30 = SDFCylinderGradient( p, 30 );
+        SDFValue quartic = SDFQuarticCylinderGradient( p );
+        SDFValue genus2 = SDFGenus2Gradient( p );
+        SDFValue hollowCube = SDFHollowCubeGradient( p );
+
+        CHECK_GRADIENT( SDFBoxGradient( q, V3( 50.f, 30.f, 70.f ), 2.f ), SDFBox( q, V3( 50.f, 30.f, 70.f ), 2.f ),
+                        NearBoxCrease( p, V3( 50.f, 30.f, 70.f ), delta ) );
+        CHECK_GRADIENT( SDFTorusGradient( q, 70, 30 ), SDFTorus( q, 70, 30 ),
+                        lxy <= 2.f * delta || lq <= 2.f * delta );
+        CHECK_GRADIENT( SDFSphereGradient( q, 40 ), SDFSphere( q, 40 ),
+                        LengthSlow( p ) <= 2.f * delta );
+        CHECK_GRADIENT( SDFOnion( SDFSubstraction( SDFBoxGradient( q, V3( 60.f ) ), SDFCylinderGradient( q, 40 ) ), 0.5f ),
+                        SDFOnion( SDFSubstraction( SDFBox( q, V3( 60.f ) ), SDFCylinder( q, 40 ) ), 0.5f ),
+                        NearBoxCrease( p, V3( 60.f ), delta ) || NearTie( box60, notCyl40, delta )
+                        || NearZero( SDFSubstraction( box60, cyl40 ), delta ) || NearFlat( SDFSubstraction( box60, cyl40 ), delta ) );
+        CHECK_GRADIENT( SDFUnion( SDFCylinderGradient( q, 30 ), SDFQuarticCylinderGradient( q ) ),
+                        SDFUnion( SDFCylinder( q, 30 ), SDFQuarticCylinder( q ) ),
+                        NearTie( cyl30, quartic, delta ) || NearFlat( SDFUnion( cyl30, quartic ), delta ) );
+        CHECK_GRADIENT( SDFIntersection( SDFGenus2Gradient( q ), SDFHollowCubeGradient( q ) ),
+                        SDFIntersection( SDFGenus2( q ), SDFHollowCube( q ) ),
+                        NearTie( genus2, hollowCube, delta ) || NearFlat( SDFIntersection( genus2, hollowCube ), delta ) );
+        CHECK_GRADIENT( SDFDevilGradient( q ), SDFDevil( q ),
+                        NearFlat( SDFDevilGradient( p ), delta ) );
+        CHECK_GRADIENT( SDFTangleCubeGradient( q ), SDFTangleCube( q ),
+                        NearFlat( SDFTangleCubeGradient( p ), delta ) );
+        CHECK_GRADIENT( SDFConeGradient( q, 0.5f, 100.f ), SDFCone( q, 0.5f, 100.f ),
+                        NearFlat( SDFConeGradient( p, 0.5f, 100.f ), delta ) );
+    }
+
+    // Right on the Z axis the torus gradient is undefined, but it must still come out finite
+    SDFValue onAxis = SDFTorusGradient( V3( 0.f, 0.f, 10.f ), 70, 30 );
+    ASSERT_TRUE( onAxis.gradient.x == 0.f && onAxis.gradient.y == 0.f && onAxis.gradient.z > 0.f );
+}
+#undef CHECK_GRADIENT
+
+
+/////     CONTOURING     /////
+
+// Only ever used as a handle here
+struct PlatformJobQueue {};
+
+// Stand-in for the platform job system: jobs just run inline in the calling thread, last one first, so nothing can count
+// on them finishing in order. Same as with the real thing, whatever a job allocates from its worker arena is gone once it's done
+MemoryArena testWorkerArena;
+
+internal
+PLATFORM_ADD_NEW_JOBS(TestAddNewJobs)
+{
+    for( int i = jobCount - 1; i >= 0; --i )
+    {
+        TemporaryMemory jobMemory = BeginTemporaryMemory( &testWorkerArena );
+        callback( (u8*)userDataArray + i * userDataStride, 0 );
+        EndTemporaryMemory( jobMemory );
+    }
+}
+
+internal
+PLATFORM_WAIT_FOR_JOB_GROUP(TestWaitForJobGroup)
+{
+    // Everything already ran
+}
+
+internal
+PLATFORM_GET_WORKER_ARENA(TestGetWorkerArena)
+{
+    ASSERT( workerThreadIndex == 0 );
+    return &testWorkerArena;
+}
+
+internal void
+InitTestJobs( sz workerArenaSize, int fakeCoreCount )
+{
+    InitArena( &testWorkerArena, new u8[workerArenaSize], workerArenaSize );
+
+    globalPlatform.AddNewJobs = TestAddNewJobs;
+    globalPlatform.WaitForJobGroup = TestWaitForJobGroup;
+    globalPlatform.GetWorkerArena = TestGetWorkerArena;
+    // Only affects how many slabs the volume is split into
+    globalPlatform.coreThreadsCount = fakeCoreCount;
+}
+
+template <typename T>
+internal bool
+SameContents( BucketArray<T> const& a, BucketArray<T> const& b, MemoryArena* tmpArena )
+{
+    if( a.count != b.count )
+        return false;
+
+    TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
+    Array<T> aArray( tmpArena, a.count, Temporary() );
+    Array<T> bArray( tmpArena, b.count, Temporary() );
+    a.CopyTo( &aArray );
+    b.CopyTo( &bArray );
+    bool result = memcmp( aArray.data, bArray.data, a.count * sizeof(T) ) == 0;
+    EndTemporaryMemory( tmpMemory );
+
+    return result;
+}
+
+// Contouring in slabs must give exactly the same mesh as contouring in one go
+void TestParallelDCVolume( MemoryArena* tmpArena )
+{
+    TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
+
+    // Not a whole number of slabs, so the last one is thinner
+    const v3 volumeSizeMeters = V3( 240.f );
+    const f32 cellSizeMeters = 2.f;
+    SimpleSurfaceData samplingData = InitSimpleSurfaceData();
+    samplingData.invWorldTransform = M4ZRotation( -Radians( 30.f ) ) * M4XRotation( -Radians( 20.f ) );
+
+    DCSettings settings = {};
+    settings.cellPointsComputationMethod = DCComputeMethod::QEFProbabilistic;
+    settings.clampCellPoints = true;
+    settings.sigmaN = 0.02f;
+    settings.sigmaNDouble = 0.01f;
+
+    PlatformJobQueue queue;
+    int surfaces[] = { SimpleSurface::Torus().index, SimpleSurface::MechanicalPart().index };
+    for( int s = 0; s < ARRAYCOUNT(surfaces); ++s )
+    {
+        samplingData.surfaceType = surfaces[s];
+
+        BucketArray<TexturedVertex> serialVertices( tmpArena, 1024, Temporary() );
+        BucketArray<i32> serialIndices( tmpArena, 1024, Temporary() );
+        DCVolume( { V3Zero, V3iZero }, volumeSizeMeters, cellSizeMeters, SimpleSurfaceFunc, SimpleSurfaceBatchFunc,
+                  SimpleSurfaceGradientFunc, SimpleSurfaceRangeFunc, (SamplingData*)&samplingData,
+                  &serialVertices, &serialIndices, nullptr, tmpArena, settings );
+
+        BucketArray<TexturedVertex> slabVertices( tmpArena, 1024, Temporary() );
+        BucketArray<i32> slabIndices( tmpArena, 1024, Temporary() );
+        DCVolume( { V3Zero, V3iZero }, volumeSizeMeters, cellSizeMeters, SimpleSurfaceFunc, SimpleSurfaceBatchFunc,
+                  SimpleSurfaceGradientFunc, SimpleSurfaceRangeFunc, (SamplingData*)&samplingData,
+                  &slabVertices, &slabIndices, nullptr, tmpArena, settings, &queue );
+
+        ASSERT_TRUE( serialIndices.count > 0 );
+        ASSERT_TRUE( SameContents( serialVertices, slabVertices, tmpArena ) );
+        ASSERT_TRUE( SameContents( serialIndices, slabIndices, tmpArena ) );
+    }
+
+    EndTemporaryMemory( tmpMemory );
+}
+
+
+// The case indices computed a lane at a time must be the same MarchCube would get, for any row width
+void TestMCCaseIndices( MemoryArena* tmpArena )
+{
+    TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
+
+    int rowWidths[] = { 1, 2, 3, 4, 5, 7, 8, 13, 64, 67 };
+    for( int w = 0; w < ARRAYCOUNT(rowWidths); ++w )
+    {
+        v2i cellsPerAxis = V2i( rowWidths[w], 5 );
+        v2i layerStepsPerAxis = cellsPerAxis + V2iOne;
+        int layerSampleCount = layerStepsPerAxis.x * layerStepsPerAxis.y;
+        IsoSurfaceSamplingCache samplingCache = InitSurfaceSamplingCache( tmpArena, cellsPerAxis, Temporary() );
+
+        for( int pass = 0; pass < 10; ++pass )
+        {
+            // Mostly on one side, so there's long runs of inactive cells too. Also fill the padding at the end, as lanes
+            // past the end of the row will read it
+            for( int i = 0; i < layerSampleCount + LaneWidth; ++i )
+            {
+                f32 samples[2];
+                for( int l = 0; l < 2; ++l )
+                {
+                    int r = RandomRangeI32( 0, 19 );
+                    samples[l] = r == 0 ? 0.f : r == 1 ? -0.f : r == 2 ? RandomRangeF32( -1.f, -0.01f ) : RandomRangeF32( 0.01f, 1.f );
+                }
+                samplingCache.bottomLayerSamples[i] = samples[0];
+                samplingCache.topLayerSamples[i] = samples[1];
+            }
+
+            for( int j = 0; j < cellsPerAxis.y; ++j )
+            {
+                int rowOffset = j * layerStepsPerAxis.x;
+                int activeCount = FindActiveCellsInRow( samplingCache.bottomLayerSamples + rowOffset,
+                                                        samplingCache.topLayerSamples + rowOffset, layerStepsPerAxis.x,
+                                                        cellsPerAxis.x, samplingCache.rowCaseIndices, samplingCache.rowActiveCells );
+
+                int expectedActiveCount = 0;
+                for( int i = 0; i < cellsPerAxis.x; ++i )
+                {
+                    // Same as in MarchCube
+                    int caseIndex = 0;
+                    for( int c = 0; c < 8; ++c )
+                    {
+                        v3i cornerOffset = cornerOffsets[c];
+                        v3i layerP = V3i( i, j, 0 ) + cornerOffset;
+                        int layerOffset = layerP.y * layerStepsPerAxis.x + layerP.x;
+
+                        f32 sample = cornerOffset.z
+                            ? samplingCache.topLayerSamples[layerOffset]
+                            : samplingCache.bottomLayerSamples[layerOffset];
+                        if( sample >= 0 )
+                            caseIndex |= 1 << c;
+                    }
+
+                    ASSERT_TRUE( samplingCache.rowCaseIndices[i] == caseIndex );
+                    if( caseIndex != 0 && caseIndex != 0xFF )
+                    {
+                        ASSERT_TRUE( expectedActiveCount < activeCount );
+                        ASSERT_TRUE( samplingCache.rowActiveCells[expectedActiveCount] == i );
+                        expectedActiveCount++;
+                    }
+                }
+                ASSERT_TRUE( activeCount == expectedActiveCount );
+            }
+        }
+    }
+
+    EndTemporaryMemory( tmpMemory );
+}
+
+// Marching in slabs must give exactly the same mesh as marching in one go
+void TestParallelMarchVolume( MemoryArena* tmpArena )
+{
+    TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
+
+    // Not a whole number of lanes per row nor of slabs, so the last one is thinner
+    const v3 volumeSideMeters = V3( 242.f );
+    const f32 cellSizeMeters = 2.f;
+    SimpleSurfaceData samplingData = InitSimpleSurfaceData();
+    samplingData.invWorldTransform = M4ZRotation( -Radians( 30.f ) ) * M4XRotation( -Radians( 20.f ) );
+    IsoSurfaceSamplingCache samplingCache = InitSurfaceSamplingCache( tmpArena, V2i( volumeSideMeters.xy / cellSizeMeters ),
+                                                                      Temporary() );
+
+    PlatformJobQueue queue;
+    int surfaces[] = { SimpleSurface::Torus().index, SimpleSurface::MechanicalPart().index };
+    for( int s = 0; s < ARRAYCOUNT(surfaces); ++s )
+    {
+        samplingData.surfaceType = surfaces[s];
+
+        for( int interpolate = 0; interpolate < 2; ++interpolate )
+        {
+            BucketArray<TexturedVertex> serialVertices( tmpArena, 1024, Temporary() );
+            BucketArray<i32> serialIndices( tmpArena, 1024, Temporary() );
+            MarchVolumeFast( { V3Zero, V3iZero }, volumeSideMeters, cellSizeMeters, SimpleSurfaceBatchFunc, SimpleSurfaceRangeFunc,
+                             (SamplingData*)&samplingData, &samplingCache, &serialVertices, &serialIndices, tmpArena,
+                             interpolate != 0 );
+
+            BucketArray<TexturedVertex> slabVertices( tmpArena, 1024, Temporary() );
+            BucketArray<i32> slabIndices( tmpArena, 1024, Temporary() );
+            MarchVolumeFast( { V3Zero, V3iZero }, volumeSideMeters, cellSizeMeters, SimpleSurfaceBatchFunc, SimpleSurfaceRangeFunc,
+                             (SamplingData*)&samplingData, &samplingCache, &slabVertices, &slabIndices, tmpArena,
+                             interpolate != 0, &queue );
+
+            ASSERT_TRUE( serialIndices.count > 0 );
+            ASSERT_TRUE( SameContents( serialVertices, slabVertices, tmpArena ) );
+            ASSERT_TRUE( SameContents( serialIndices, slabIndices, tmpArena ) );
+        }
+    }
+
+    EndTemporaryMemory( tmpMemory );
+}
+
+
+/////     RESOURCE POOL     /////
+
+void TestResourcePool( MemoryArena* tmpArena )
+{
+    TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
+
+    const int capacity = 1000;
+    ResourcePool<i32> pool( tmpArena, capacity, 3, Temporary() );
+    Array<ResourceHandle<i32>> handles( tmpArena, capacity, Temporary() );
+
+    for( int i = 0; i < capacity; ++i )
+    {
+        ResourceHandle<i32> handle = pool.Add( i, (u8)(i & 0xFF) );
+        ASSERT_TRUE( handle.IsValid() && handle.Allocator() == 3 && handle.Flags() == (u8)(i & 0xFF) );
+        handles.Push( handle );
+    }
+    // Full
+    ASSERT_TRUE( !pool.Add( -1 ).IsValid() );
+
+    // Remove every odd item, stale handles must fail from then on
+    for( int i = 1; i < capacity; i += 2 )
+        ASSERT_TRUE( pool.Remove( handles[i] ) );
+    ASSERT_TRUE( pool.count == capacity / 2 );
+    for( int i = 0; i < capacity; ++i )
+    {
+        i32* item = pool.GetTransientPointer( handles[i] );
+        ASSERT_TRUE( (i & 1) ? item == nullptr : (item && *item == i) );
+    }
+    ASSERT_TRUE( !pool.Remove( handles[1] ) );
+
+    // Reused slots get a new generation
+    ResourceHandle<i32> reused = pool.Add( 12345 );
+    ASSERT_TRUE( reused != handles[capacity - 1] && reused.Index() == handles[capacity - 1].Index() );
+    ASSERT_TRUE( !pool.Contains( handles[capacity - 1] ) && *pool.GetTransientPointer( reused ) == 12345 );
+
+    // Dense iteration sees every live item exactly once, and handles round trip
+    i64 sum = 0;
+    for( int i = 0; i < pool.count; ++i )
+    {
+        sum += pool[i];
+        ASSERT_TRUE( pool.GetTransientPointer( pool.HandleAt( i ) ) == &pool[i] );
+    }
+    ASSERT_TRUE( sum == (i64)(capacity / 2) * (capacity - 2) / 2 + 12345 );
+
+    pool.Clear();
+    ASSERT_TRUE( pool.count == 0 && !pool.Contains( reused ) && !pool.Contains( handles[0] ) );
+
+    EndTemporaryMemory( tmpMemory );
+}
+
+
+/////     HASH TABLE BENCHMARK     /////
+
+// The previous (chained, modulo indexed) HashTable, as a baseline
+template <typename K, typename V, u32 (*H)( const K&, i32 )>
+struct ChainedHashTable
+{
+    struct Slot
+    {
+        Slot* nextInHash;
+        V value;
+        K key;
+        bool occupied;
+    };
+
+
+    Slot* table;
+    i32 tableSize;
+    i32 count;
+
+    MemoryArena* arena;
+    MemoryParams memoryParams;
+
+
+    ChainedHashTable( MemoryArena* arena_, int size, MemoryParams params = DefaultMemoryParams() )
+    {
+        ASSERT( size > 0 );
+        table = PUSH_ARRAY( arena_, Slot, size, params );
+        tableSize = size;
+        count = 0;
+        arena = arena_;
+        memoryParams = params;
+
+        Clear();
+    }
+
+    // Disallow implicit copying
+    ChainedHashTable( const ChainedHashTable& ) = delete;
+    ChainedHashTable& operator =( const ChainedHashTable& ) = delete;
+
+    void Clear()
+    {
+        for( int i = 0; i < tableSize; ++i )
+            table[i].occupied = false;
+        // FIXME Add existing externally chained elements to a free list like in BucketArray
+        count = 0;
+    }
+
+    V* Find( const K& key )
+    {
+        int idx = IndexFromKey( key );
+
+        Slot* slot = &table[idx];
+        if( slot->occupied )
+        {
+            do
+            {
+                if( slot->key == key )
+                    return &slot->value;
+
+                slot = slot->nextInHash;
+            } while( slot );
+        }
+
+        return nullptr;
+    }
+
+    V* InsertEmpty( const K& key )
+    {
+        int idx = IndexFromKey( key );
+
+        Slot* prev = nullptr;
+        Slot* slot = &table[idx];
+        if( slot->occupied )
+        {
+            do
+            {
+                // TODO Allow key comparisons different from bit-equality if needed
+                if( slot->key == key )
+                    return nullptr;
+
+                prev = slot;
+                slot = slot->nextInHash;
+            } while( slot );
+
+            slot = PUSH_STRUCT( arena, Slot, memoryParams );
+            prev->nextInHash = slot;
+        }
+
+        count++;
+        slot->occupied = true;
+        slot->key = key;
+        slot->nextInHash = nullptr;
+        PZERO( &slot->value, sizeof(V) );
+
+        return &slot->value;
+    }
+
+    bool Insert( const K& key, const V& value )
+    {
+        bool result = false;
+
+        V* slotValue = InsertEmpty( key );
+        if( slotValue )
+        {
+            *slotValue = value;
+            result = true;
+        }
+
+        return result;
+    }
+
+private:
+
+    int IndexFromKey( const K& key ) const
+    {
+        u32 hashValue = H( key, tableSize );
+        // TODO Make tableSize a power of 2 and mask instead
+        int result = I32( hashValue % tableSize );
+        return result;
+    }
+};
+
+// Same as the one used for the world's cluster table
+inline u32
+BenchmarkClusterHash( const v3i& clusterP, i32 tableSize )
+{
+    u32 hashValue = ((u32)clusterP.x * 73856093u) ^ ((u32)clusterP.y * 19349663u) ^ ((u32)clusterP.z * 83492791u);
+    return hashValue;
+}
+
+// What the world used before. Only ~100 different values across a 5x5x5 region, so most keys collide
+inline u32
+LegacyClusterHash( const v3i& clusterP, i32 tableSize )
+{
+    u32 hashValue = (u32)(19*clusterP.x + 7*clusterP.y + 3*clusterP.z);
+    return hashValue;
+}
+
+// Roughly the size of a Cluster
+struct BenchmarkCluster
+{
+    u8 data[120];
+};
+
+// Flies along a random walk, streaming in clusters ahead of us and looking up the whole sim region every step,
+// just like the world does
+template <typename TableType>
+internal void
+RunHashTableBenchmark( TableType* clusterTable, char const* name, Array<v3i> const& path, int radius )
+{
+    u64 lookupCycles = 0, insertCycles = 0;
+    i32 found = 0;
+
+    StartCounter();
+    for( int s = 0; s < path.count; ++s )
+    {
+        v3i const& originP = path[s];
+
+        u64 startCycles = ReadCycles();
+        for( int k = -radius; k <= radius; ++k )
+            for( int j = -radius; j <= radius; ++j )
+                for( int i = -radius; i <= radius; ++i )
+                {
+                    v3i clusterP = originP + V3i( i, j, k );
+                    if( !clusterTable->Find( clusterP ) )
+                        clusterTable->InsertEmpty( clusterP )->data[0] = 1;
+                }
+        u64 midCycles = ReadCycles();
+
+        // Plain lookups, like rendering & simulation do every frame
+        for( int k = -radius; k <= radius; ++k )
+            for( int j = -radius; j <= radius; ++j )
+                for( int i = -radius; i <= radius; ++i )
+                {
+                    BenchmarkCluster* cluster = clusterTable->Find( originP + V3i( i, j, k ) );
+                    found += cluster ? cluster->data[0] : 0;
+                }
+        u64 endCycles = ReadCycles();
+
+        insertCycles += midCycles - startCycles;
+        lookupCycles += endCycles - midCycles;
+    }
+    f64 totalMs = GetCounterMs();
+
+    int regionSize = (2 * radius + 1) * (2 * radius + 1) * (2 * radius + 1);
+    EXPECT_TRUE( found == path.count * regionSize );
+    printf( "%22s :: %10.3f ms :: %6llu cycles/find+insert :: %6llu cycles/find :: %d clusters\n", name, totalMs,
+            insertCycles / ((u64)path.count * regionSize), lookupCycles / ((u64)path.count * regionSize), clusterTable->count );
+}
+
+internal void
+TestHashTableBenchmark( int steps, int radius )
+{
+    // Random walk through the world
+    Array<v3i> path = NewArray<v3i>( steps );
+    v3i p = V3iZero;
+    for( int s = 0; s < steps; ++s )
+    {
+        p.e[RandomRangeI32( 0, 3 ) % 3] += RandomNormalizedF32() < 0.5f ? -1 : 1;
+        path[s] = p;
+    }
+
+    printf( "HashTable benchmark (%d steps, %d clusters per step)\n", steps, (2*radius + 1) * (2*radius + 1) * (2*radius + 1) );
+
+    sz memorySize = GIGABYTES(1);
+    u8* memory = new u8[memorySize];
+    MemoryArena arena;
+
+    // Same size the world used for its cluster table
+    InitArena( &arena, memory, memorySize );
+    {
+        ChainedHashTable<v3i, BenchmarkCluster, LegacyClusterHash> chainedTable( &arena, 256*1024 );
+        RunHashTableBenchmark( &chainedTable, "Chained (legacy hash)", path, radius );
+    }
+    InitArena( &arena, memory, memorySize );
+    {
+        ChainedHashTable<v3i, BenchmarkCluster, BenchmarkClusterHash> chainedTable( &arena, 256*1024 );
+        RunHashTableBenchmark( &chainedTable, "Chained", path, radius );
+    }
+
+    // Same initial size as the new table, which can't grow
+    InitArena( &arena, memory, memorySize );
+    {
+        ChainedHashTable<v3i, BenchmarkCluster, BenchmarkClusterHash> chainedTable( &arena, 1024 );
+        RunHashTableBenchmark( &chainedTable, "Chained (1024 slots)", path, radius );
+    }
+
+    // Start small and let it grow
+    InitArena( &arena, memory, memorySize );
+    {
+        HashTable<v3i, BenchmarkCluster, BenchmarkClusterHash> robinHoodTable( &arena, 1024 );
+        RunHashTableBenchmark( &robinHoodTable, "Robin Hood", path, radius );
+
+        // Removal keeps everything reachable
+        for( int s = 0; s < path.count; s += 2 )
+            robinHoodTable.Remove( path[s] );
+        for( int s = 1; s < path.count; s += 2 )
+        {
+            bool removedToo = false;
+            for( int r = 0; r < path.count && !removedToo; r += 2 )
+                removedToo = path[r] == path[s];
+            EXPECT_TRUE( removedToo || robinHoodTable.Find( path[s] ) );
+        }
+    }
+
+    delete[] memory;
+    DeleteArray( path );
+
+    printf( "\n" );
+    printf( "---\n" );
+    printf( "\n" );
+}
+
+/////     CONCURRENT QUEUE BENCHMARK     /////
+
+// The previous (mutex based) ConcurrentQueue, as a baseline
+template <typename T>
+struct MutexQueue
+{
+    Queue<T> queue;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    void Push( T* item )
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        queue.Push( item );
+        lock.unlock();
+
+        condition.notify_one();
+    }
+
+    T* PopOrBlock()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        
+        while( queue.IsEmpty() )
+            condition.wait( lock );
+
+        return queue.Pop();
+    }
+};
+
+struct QueueBenchmarkNode
+{
+    QueueBenchmarkNode* next;
+    QueueBenchmarkNode* prev;
+};
+
+struct QueueBenchmarkThread
+{
+    MutexQueue<QueueBenchmarkNode>* mutexQueue;
+    ConcurrentQueue<QueueBenchmarkNode*>* lockFreeQueue;
+    QueueBenchmarkNode* node;
+    volatile bool* go;
+    int iterations;
+};
+
+// Every thread pushes its node and pops whatever is in front, so there's always something to pop
+// and we measure pure contention on both ends of the queue
+DWORD WINAPI
+QueueBenchmarkThreadProc( LPVOID param )
+{
+    QueueBenchmarkThread* thread = (QueueBenchmarkThread*)param;
+    QueueBenchmarkNode* node = thread->node;
+
+    while( !AtomicLoad( thread->go ) )
+        _mm_pause();
+
+    if( thread->mutexQueue )
+    {
+        for( int i = 0; i < thread->iterations; ++i )
+        {
+            thread->mutexQueue->Push( node );
+            node = thread->mutexQueue->PopOrBlock();
+        }
+    }
+    else
+    {
+        for( int i = 0; i < thread->iterations; ++i )
+        {
+            bool pushed = thread->lockFreeQueue->Push( node );
+            ASSERT( pushed );
+            node = thread->lockFreeQueue->PopOrBlock();
+        }
+    }
+
+    return 0;
+}
+
+internal f64
+RunQueueBenchmark( MutexQueue<QueueBenchmarkNode>* mutexQueue, ConcurrentQueue<QueueBenchmarkNode*>* lockFreeQueue,
+                   int threadCount, int iterations, MemoryArena* tmpArena )
+{
+    TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
+
+    QueueBenchmarkNode* nodes = PUSH_ARRAY( tmpArena, QueueBenchmarkNode, threadCount, Temporary() );
+    QueueBenchmarkThread* threads = PUSH_ARRAY( tmpArena, QueueBenchmarkThread, threadCount, Temporary() );
+    HANDLE* handles = PUSH_ARRAY( tmpArena, HANDLE, threadCount, Temporary() );
+    volatile bool go = false;
+
+    for( int i = 0; i < threadCount; ++i )
+    {
+        threads[i] = { mutexQueue, lockFreeQueue, &nodes[i], &go, iterations };
+        handles[i] = CreateThread( 0, 0, QueueBenchmarkThreadProc, &threads[i], 0, 0 );
+        ASSERT_TRUE( handles[i] );
+    }
+
+    StartCounter();
+    AtomicExchange( &go, true );
+    WaitForMultipleObjects( (DWORD)threadCount, handles, TRUE, INFINITE );
+    f64 elapsedMs = GetCounterMs();
+
+    for( int i = 0; i < threadCount; ++i )
+        CloseHandle( handles[i] );
+
+    EndTemporaryMemory( tmpMemory );
+    return elapsedMs;
+}
+
+internal void
+TestConcurrentQueueBenchmark( int iterationsPerThread, MemoryArena* tmpArena )
+{
+    printf( "ConcurrentQueue benchmark (%d push/pop pairs per thread)\n", iterationsPerThread );
+
+    // NOTE WaitForMultipleObjects can only take up to 64 handles
+    const int maxThreadCount = 64;
+    for( int threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2 )
+    {
+        // Never holds more than one node per thread
+        MutexQueue<QueueBenchmarkNode> mutexQueue;
+        ConcurrentQueue<QueueBenchmarkNode*> lockFreeQueue( tmpArena, (u32)maxThreadCount, Temporary() );
+
+        f64 mutexMs = RunQueueBenchmark( &mutexQueue, nullptr, threadCount, iterationsPerThread, tmpArena );
+        f64 lockFreeMs = RunQueueBenchmark( nullptr, &lockFreeQueue, threadCount, iterationsPerThread, tmpArena );
+
+        f64 totalOps = 2.0 * threadCount * iterationsPerThread;
+        printf( "%2d threads :: mutex %10.3f ms (%8.1f ns/op) :: lock-free %10.3f ms (%8.1f ns/op) :: %5.2fx\n",
+                threadCount, mutexMs, mutexMs * 1000000.0 / totalOps, lockFreeMs, lockFreeMs * 1000000.0 / totalOps,
+                mutexMs / lockFreeMs );
+    }
+
+    printf( "\n" );
+    printf( "---\n" );
+    printf( "\n" );
+}
+
+
+
+/////     MEMORY POOL BENCHMARK     /////
+
+// The previous (first-fit, linear search) MemoryPool, as a baseline
+struct FirstFitBlock
+{
+    FirstFitBlock* prev;
+    FirstFitBlock* next;
+
+    sz size;
+    bool used;
+};
+
+internal void
+InsertFirstFitBlock( FirstFitBlock* prev, sz size, void* memory )
+{
+    FirstFitBlock* block = (FirstFitBlock*)memory;
+    block->size = size - sizeof(FirstFitBlock);
+    block->used = false;
+    block->prev = prev;
+    block->next = prev->next;
+    block->prev->next = block;
+    block->next->prev = block;
+}
+
+internal void*
+AllocateFirstFit( FirstFitBlock* sentinel, sz size )
+{
+    const sz blockSplitThreshold = 4096;
+
+    for( FirstFitBlock* block = sentinel->next; block != sentinel; block = block->next )
+    {
+        if( block->size >= size && !block->used )
+        {
+            block->used = true;
+            void* result = block + 1;
+
+            sz remainingSize = block->size - size;
+            if( remainingSize > blockSplitThreshold )
+            {
+                block->size -= remainingSize;
+                InsertFirstFitBlock( block, remainingSize, (u8*)result + size );
+            }
+            return result;
+        }
+    }
+    return nullptr;
+}
+
+internal void
+MergeFirstFit( FirstFitBlock* first, FirstFitBlock* second, FirstFitBlock* sentinel )
+{
+    if( first != sentinel && second != sentinel && !first->used && !second->used
+        && (u8*)second == (u8*)(first + 1) + first->size )
+    {
+        second->next->prev = second->prev;
+        second->prev->next = second->next;
+        first->size += sizeof(FirstFitBlock) + second->size;
+    }
+}
+
+internal void
+ReleaseFirstFit( FirstFitBlock* sentinel, void* memory )
+{
+    FirstFitBlock* block = (FirstFitBlock*)memory - 1;
+    block->used = false;
+
+    MergeFirstFit( block, block->next, sentinel );
+    MergeFirstFit( block->prev, block, sentinel );
+}
+
+internal void
+FirstFitFreeStats( FirstFitBlock* sentinel, sz* freeSize, sz* largestFreeSize )
+{
+    *freeSize = 0;
+    *largestFreeSize = 0;
+    for( FirstFitBlock* block = sentinel->next; block != sentinel; block = block->next )
+    {
+        if( !block->used )
+        {
+            *freeSize += block->size;
+            *largestFreeSize = Max( *largestFreeSize, block->size );
+        }
+    }
+}
+
+struct MeshTraceOp
+{
+    i32 meshIndex;
+    // Zero means free
+    sz size;
+};
+
+// Simulates flying through the world: every new cluster allocates a bunch of meshes of very different sizes,
+// while the ones falling out of the sim region free theirs in random order, and some live meshes get rebuilt
+internal Array<MeshTraceOp>
+BuildMeshTrace( int clusterCount, int liveClusterCount, int* meshCount )
+{
+    const int maxMeshesPerCluster = 24;
+    const f32 minLogSize = logf( 4.f * 1024 );
+    const f32 maxLogSize = logf( 2.f * 1024 * 1024 );
+
+    Array<MeshTraceOp> result = NewArray<MeshTraceOp>( clusterCount * maxMeshesPerCluster * 4 );
+    result.count = 0;
+
+    Array<i32> clusterMeshStart = NewArray<i32>( clusterCount + 1 );
+    *meshCount = 0;
+
+    for( int c = 0; c < clusterCount; ++c )
+    {
+        if( c >= liveClusterCount )
+        {
+            int evicted = c - liveClusterCount;
+            int start = clusterMeshStart[evicted];
+            int count = clusterMeshStart[evicted + 1] - start;
+
+            // Free them in a random order
+            int offset = RandomRangeI32( 0, count - 1 );
+            for( int m = 0; m < count; ++m )
+                result.Push( { start + (m + offset) % count, 0 } );
+        }
+
+        clusterMeshStart[c] = *meshCount;
+        int count = RandomRangeI32( 8, maxMeshesPerCluster );
+        for( int m = 0; m < count; ++m )
+        {
+            sz size = (sz)expf( minLogSize + RandomNormalizedF32() * (maxLogSize - minLogSize) );
+            result.Push( { (*meshCount)++, size } );
+        }
+        clusterMeshStart[c + 1] = *meshCount;
+
+        // Rebuild a few meshes in the live clusters
+        int firstLive = c >= liveClusterCount ? clusterMeshStart[c - liveClusterCount + 1] : 0;
+        for( int r = 0; r < 4; ++r )
+        {
+            int meshIndex = RandomRangeI32( firstLive, *meshCount - 1 );
+            sz size = (sz)expf( minLogSize + RandomNormalizedF32() * (maxLogSize - minLogSize) );
+            result.Push( { meshIndex, 0 } );
+            result.Push( { meshIndex, size } );
+        }
+    }
+
+    DeleteArray( clusterMeshStart );
+    return result;
+}
+
+internal void
+TestMemoryPoolBenchmark( int clusterCount, sz poolSize, MemoryArena* tmpArena )
+{
+    const int liveClusterCount = 27;
+    int meshCount = 0;
+    Array<MeshTraceOp> trace = BuildMeshTrace( clusterCount, liveClusterCount, &meshCount );
+    Array<void*> meshes = NewArray<void*>( meshCount );
+    u8* memory = new u8[poolSize + 64];
+
+    printf( "MemoryPool benchmark (%d ops, %d meshes, %llu MB pool)\n", trace.count, meshCount, (u64)poolSize / MEGABYTES(1) );
+
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        bool firstFit = pass == 0;
+        PZERO( meshes.data, meshes.count * sizeof(void*) );
+
+        FirstFitBlock sentinel = { &sentinel, &sentinel, 0, true };
+        MemoryPool* pool = PUSH_STRUCT( tmpArena, MemoryPool, Temporary() );
+        MemoryArena poolArena;
+        InitArena( &poolArena, memory, poolSize + 64 );
+        if( firstFit )
+            InsertFirstFitBlock( &sentinel, poolSize, Align( memory, 16 ) );
+        else
+            InitMemoryPool( pool, &poolArena, poolSize );
+
+        int failedCount = 0;
+        f64 worstFragmentation = 0;
+
+        StartCounter();
+        u64 startCycles = ReadCycles();
+        for( int i = 0; i < trace.count; ++i )
+        {
+            MeshTraceOp const& op = trace[i];
+            void*& mesh = meshes[op.meshIndex];
+
+            if( op.size )
+            {
+                ASSERT( !mesh );
+                mesh = firstFit ? AllocateFirstFit( &sentinel, op.size ) : AllocateFromPool( pool, op.size );
+                if( !mesh )
+                    failedCount++;
+            }
+            else if( mesh )
+            {
+                if( firstFit )
+                    ReleaseFirstFit( &sentinel, mesh );
+                else
+                    ReleaseToPool( pool, mesh );
+                mesh = nullptr;
+            }
+
+            // Sample external fragmentation (outside the timed section would be fairer, but it's rare enough)
+            if( (i & 1023) == 0 )
+            {
+                sz freeSize, largestFreeSize;
+                if( firstFit )
+                    FirstFitFreeStats( &sentinel, &freeSize, &largestFreeSize );
+                else
+                {
+                    freeSize = pool->freeSize;
+                    largestFreeSize = LargestFreeBlockSize( *pool );
+                }
+                if( freeSize )
+                    worstFragmentation = Max( worstFragmentation, 1.0 - (f64)largestFreeSize / freeSize );
+            }
+        }
+        u64 totalCycles = ReadCycles() - startCycles;
+        f64 totalMs = GetCounterMs();
+
+        printf( "%22s :: %10.3f ms :: %8llu cycles/op :: %6d failed :: %5.1f%% worst fragmentation\n",
+                firstFit ? "First fit" : "TLSF", totalMs, totalCycles / trace.count, failedCount, worstFragmentation * 100.0 );
+
+        // Everything should coalesce back into a single block
+        if( !firstFit )
+        {
+            for( int m = 0; m < meshes.count; ++m )
+                if( meshes[m] )
+                    ReleaseToPool( pool, meshes[m] );
+            EXPECT_TRUE( pool->usedBlockCount == 0 );
+            EXPECT_TRUE( LargestFreeBlockSize( *pool ) == poolSize - sizeof(MemoryBlock) );
+
+            // Sizes past the biggest bin just fail
+            EXPECT_TRUE( AllocateFromPool( pool, (sz)1 << MEMORY_POOL_FL_MAX_LOG2 ) == nullptr );
+            EXPECT_TRUE( AllocateFromPool( pool, ((sz)1 << MEMORY_POOL_FL_MAX_LOG2) * 4 + 1 ) == nullptr );
+        }
+    }
+
+    delete[] memory;
+    DeleteArray( meshes );
+    DeleteArray( trace );
+
+    printf( "\n" );
+    printf( "---\n" );
+    printf( "\n" );
+}
+
+
+/////     GRID LAYOUT BENCHMARK     /////
+
+// Same size & layout as the DC cell data
+struct BenchmarkCellData
+{
+    v3 edgeCrossingsP[3];
+    v3 edgeCrossingsN[3];
+    f32 sampledValue;
+    i32 vertexIndex;
+};
+
+// Models an 8-way set associative cache with LRU replacement (256 KB, like a typical L2) to count misses,
+// since we have no portable access to the hardware counters
+struct CacheModel
+{
+    static const int WayCount = 8;
+    static const int SetCount = 512;
+
+    u64 tags[SetCount][WayCount];
+    u32 ages[SetCount][WayCount];
+    u32 clock;
+    u64 accessCount;
+    u64 missCount;
+};
+
+internal void
+TouchCacheModel( CacheModel* cache, void const* address, sz size )
+{
+    u64 firstLine = (u64)address >> 6;
+    u64 lastLine = ((u64)address + size - 1) >> 6;
+
+    for( u64 line = firstLine; line <= lastLine; ++line )
+    {
+        u64* tags = cache->tags[line % CacheModel::SetCount];
+        u32* ages = cache->ages[line % CacheModel::SetCount];
+        cache->accessCount++;
+        cache->clock++;
+
+        int victim = 0;
+        bool hit = false;
+        for( int w = 0; w < CacheModel::WayCount; ++w )
+        {
+            if( tags[w] == line + 1 )
+            {
+                ages[w] = cache->clock;
+                hit = true;
+                break;
+            }
+            if( ages[w] < ages[victim] )
+                victim = w;
+        }
+
+        if( !hit )
+        {
+            tags[victim] = line + 1;
+            ages[victim] = cache->clock;
+            cache->missCount++;
+        }
+    }
+}
+
+#define CELL( i, j, k ) ( cache ? TouchCacheModel( cache, &cellData( i, j, k ), sizeof(BenchmarkCellData) ) : (void)0, cellData( i, j, k ) )
+
+// Replicates the cell accesses done by DCVolume (the SDF is sampled beforehand so it doesn't dominate the timings)
+template <typename GridType>
+internal u64
+RunGridLayoutBenchmark( GridType& cellData, f32 const* samples, CacheModel* cache )
+{
+    static const v3i cornerOffsets[8] =
+    {
+        V3i( -1, -1, -1 ), V3i(  0, -1, -1 ), V3i( -1,  0, -1 ), V3i(  0,  0, -1 ),
+        V3i( -1, -1,  0 ), V3i(  0, -1,  0 ), V3i( -1,  0,  0 ), V3i(  0,  0,  0 ),
+    };
+
+    u64 checksum = 0;
+    i32 vertexCount = 0;
+    v3i dims = cellData.dims;
+
+    for( int k = 0; k < dims.z; ++k )
+        for( int j = 0; j < dims.y; ++j )
+            for( int i = 0; i < dims.x; ++i )
+            {
+                f32 sample = *samples++;
+                CELL( i, j, k ).sampledValue = sample;
+
+                u32 caseMask = 0;
+                for( int s = 0; s < 7; ++s )
+                {
+                    v3i p = V3i( i, j, k ) + cornerOffsets[s];
+                    f32 cornerSample = (p.x < 0 || p.y < 0 || p.z < 0) ? sample : CELL( p.x, p.y, p.z ).sampledValue;
+                    if( cornerSample < 0.f )
+                        caseMask |= 1 << s;
+                }
+                if( sample < 0.f )
+                    caseMask |= 1 << 7;
+
+                if( caseMask == 0u || caseMask == 0xFFu )
+                    continue;
+
+                // Own edges, plus the ones stored in the neighbours sharing the other 9
+                for( int e = 0; e < 3; ++e )
+                {
+                    CELL( i, j, k ).edgeCrossingsP[e] = V3( (f32)i, (f32)j, (f32)k );
+                    CELL( i, j, k ).edgeCrossingsN[e] = V3( 0.f, 0.f, 1.f );
+                }
+                for( int s = 1; s < 7; ++s )
+                {
+                    v3i p = V3i( i, j, k ) + cornerOffsets[s];
+                    if( p.x >= 0 && p.y >= 0 && p.z >= 0 )
+                        checksum += (u64)CELL( p.x, p.y, p.z ).edgeCrossingsP[s % 3].x;
+                }
+
+                CELL( i, j, k ).vertexIndex = vertexCount++;
+
+                // Quads looking backwards
+                if( i > 0 && j > 0 && k > 0 )
+                {
+                    checksum += CELL( i, j-1, k ).vertexIndex + CELL( i, j, k-1 ).vertexIndex + CELL( i, j-1, k-1 ).vertexIndex;
+                    checksum += CELL( i-1, j, k ).vertexIndex + CELL( i-1, j, k-1 ).vertexIndex + CELL( i-1, j-1, k ).vertexIndex;
+                }
+            }
+
+    return checksum + vertexCount;
+}
+
+#undef CELL
+
+template <typename GridType>
+internal void
+TestGridLayout( char const* name, v3i const& dims, f32 const* samples, CacheModel* cache, int passes, u64* checksum )
+{
+    sz memorySize = GIGABYTES(1);
+    u8* memory = new u8[memorySize];
+    MemoryArena arena;
+    InitArena( &arena, memory, memorySize );
+
+    GridType cellData( &arena, dims );
+
+    u64 bestCycles = U64MAX;
+    for( int p = 0; p < passes; ++p )
+    {
+        u64 startCycles = ReadCycles();
+        u64 result = RunGridLayoutBenchmark( cellData, samples, nullptr );
+        bestCycles = Min( bestCycles, ReadCycles() - startCycles );
+
+        EXPECT_TRUE( *checksum == 0 || *checksum == result );
+        *checksum = result;
+    }
+
+    PZERO( cache, sizeof(CacheModel) );
+    RunGridLayoutBenchmark( cellData, samples, cache );
+
+    u64 cellCount = (u64)dims.x * dims.y * dims.z;
+    printf( "%22s :: %8.2f cycles/cell :: %6.2f%% modelled misses (%.3f per cell) :: %llu MB\n", name,
+            (f64)bestCycles / cellCount, 100.0 * cache->missCount / cache->accessCount, (f64)cache->missCount / cellCount,
+            (u64)(cellData.layout.StorageCount() * sizeof(BenchmarkCellData)) / MEGABYTES(1) );
+
+    delete[] memory;
+}
+
+// DC meshing of a full cluster (one cell per voxel, plus the extra border layer)
+internal void
+TestGridLayoutBenchmark( int cellsPerAxis, int passes )
+{
+    v3i dims = V3i( cellsPerAxis );
+    u64 cellCount = (u64)dims.x * dims.y * dims.z;
+    f32* samples = new f32[cellCount];
+
+    // Some random hollow boxes, like our halls & rooms
+    const int boxCount = 16;
+    v3 boxCenters[boxCount], boxHalfSizes[boxCount];
+    for( int b = 0; b < boxCount; ++b )
+    {
+        boxHalfSizes[b] = V3( RandomRangeF32( 4.f, cellsPerAxis / 4.f ), RandomRangeF32( 4.f, cellsPerAxis / 4.f ),
+                              RandomRangeF32( 4.f, cellsPerAxis / 4.f ) );
+        boxCenters[b] = V3( RandomRangeF32( 0.f, (f32)cellsPerAxis ), RandomRangeF32( 0.f, (f32)cellsPerAxis ),
+                            RandomRangeF32( 0.f, (f32)cellsPerAxis ) );
+    }
+
+    f32* sample = samples;
+    for( int k = 0; k < dims.z; ++k )
+        for( int j = 0; j < dims.y; ++j )
+            for( int i = 0; i < dims.x; ++i )
+            {
+                f32 minDistance = F32MAX;
+                for( int b = 0; b < boxCount; ++b )
+                {
+                    v3 d = V3( Abs( i - boxCenters[b].x ), Abs( j - boxCenters[b].y ), Abs( k - boxCenters[b].z ) ) - boxHalfSizes[b];
+                    f32 distance = Max( d.x, Max( d.y, d.z ) );
+                    minDistance = Min( minDistance, Abs( distance ) - 1.5f );
+                }
+                *sample++ = minDistance;
+            }
+
+    printf( "Grid3D layout benchmark (%d^3 cells, %d bytes per cell)\n", cellsPerAxis, (int)sizeof(BenchmarkCellData) );
+
+    CacheModel* cache = new CacheModel;
+    u64 checksum = 0;
+    TestGridLayout< Grid3D<BenchmarkCellData, LinearGridLayout> >( "Linear", dims, samples, cache, passes, &checksum );
+    TestGridLayout< Grid3D<BenchmarkCellData, TiledGridLayout<2>> >( "Tiled 4^3", dims, samples, cache, passes, &checksum );
+    TestGridLayout< Grid3D<BenchmarkCellData, TiledGridLayout<3>> >( "Tiled 8^3", dims, samples, cache, passes, &checksum );
+
+    delete cache;
+    delete[] samples;
+
+    printf( "\n" );
+    printf( "---\n" );
+    printf( "\n" );
+}
+
+// Contours a whole cluster worth of halls & rooms, same as the world generation does for each of them
+void
+TestDCClusterBenchmark( int hallCount, int roomCount, int passes )
+{
+    // Enough for a full grid of DC cells over the cluster, plus the output
+    sz arenaSize = GIGABYTES(2);
+    MemoryArena arena;
+    InitArena( &arena, new u8[arenaSize], arenaSize );
+
+    // Same surface as BuildClusterSurfaceSDF, for a few random straight halls and boxy rooms
+    RandomStream random = RandomStreamFromSeed( 0x5EED );
+    const v3 volumeBorder = V3( VoxelSizeMeters * 1.01f );
+    const f32 maxP = ClusterSizeMeters * 0.5f - 16.f;
+
+    SDFNode* root = PushSDFConstant( &arena, F32MAX );
+    for( int i = 0; i < hallCount; ++i )
+    {
+        v3 center = V3( RandomRangeI32( &random, (i32)-maxP, (i32)maxP ), RandomRangeI32( &random, (i32)-maxP, (i32)maxP ),
+                        RandomRangeI32( &random, (i32)-maxP, (i32)maxP ) );
+        v3 halfSize = V3( 8.f );
+        halfSize.e[ RandomRangeI32( &random, 0, 2 ) ] = maxP - 16.f;
+        aabb bounds = AABBCenterSize( center, halfSize * 2.f );
+
+        SDFNode* hallSDF = PushSDFTranslate( &arena, PushSDFBox( &arena, halfSize - volumeBorder ), center );
+        root = PushSDFBoundedUnion( &arena, root, hallSDF, bounds );
+    }
+    root = PushSDFOnion( &arena, root, VoxelSizeMeters * 0.5f, true );
+    for( int i = 0; i < roomCount; ++i )
+    {
+        v3 center = V3( RandomRangeI32( &random, (i32)-maxP, (i32)maxP ), RandomRangeI32( &random, (i32)-maxP, (i32)maxP ),
+                        RandomRangeI32( &random, (i32)-maxP, (i32)maxP ) );
+        v3 halfSize = V3( RandomRangeI32( &random, 16, 48 ), RandomRangeI32( &random, 16, 48 ), RandomRangeI32( &random, 16, 48 ) );
+        aabb bounds = AABBCenterSize( center, halfSize * 2.f );
+
+        SDFNode* roomSDF = PushSDFTranslate( &arena, PushSDFBox( &arena, halfSize - volumeBorder ), center );
+        root = PushSDFBoundedSubstraction( &arena, root, roomSDF, bounds );
+    }
+
+    aabb region = AABBCenterSize( V3Zero, V3( ClusterSizeMeters + VoxelSizeMeters * 8.f ) );
+    SDFProgram program = CompileSDFProgram( root, region, &arena );
+    SDFProgramSamplingData samplingData = InitSDFProgramSamplingData( &program );
+    samplingData.header.zeroThickness = false;
+
+    DCSettings settings = {};
+    settings.cellPointsComputationMethod = DCComputeMethod::QEFProbabilistic;
+    settings.clampCellPoints = true;
+    settings.sigmaN = 0.02f;
+    settings.sigmaNDouble = 0.01f;
+
+    i32 cellsPerAxis = VoxelsPerClusterAxis + 1;
+    printf( "DC cluster benchmark (%d^3 cells, %d halls, %d rooms)\n", cellsPerAxis, hallCount, roomCount );
+
+    f64 bestMillis = F64MAX;
+    for( int p = 0; p < passes; ++p )
+    {
+        TemporaryMemory tmpMemory = BeginTemporaryMemory( &arena );
+        BucketArray<TexturedVertex> vertices( &arena, 1024, Temporary() );
+        BucketArray<i32> indices( &arena, 1024, Temporary() );
+
+        StartCounter();
+        DCVolume( { V3Zero, V3iZero }, V3( ClusterSizeMeters ), VoxelSizeMeters, SDFProgramSurfaceFunc, SDFProgramSurfaceBatchFunc,
+                  SDFProgramSurfaceGradientFunc, SDFProgramSurfaceRangeFunc, (SamplingData*)&samplingData,
+                  &vertices, &indices, nullptr, &arena, settings );
+        f64 elapsedMillis = GetCounterMs();
+        bestMillis = Min( bestMillis, elapsedMillis );
+
+        printf( "%22s :: %10.2f ms :: %d vertices, %d indices\n", "DCVolume", elapsedMillis, vertices.count, indices.count );
+        EndTemporaryMemory( tmpMemory );
+    }
+    printf( "%22s :: %10.2f ms :: %.2f ns/cell\n", "Best", bestMillis,
+            bestMillis * 1000000.0 / ((f64)cellsPerAxis * cellsPerAxis * cellsPerAxis) );
+
+    delete[] arena.base;
+
+    printf( "\n" );
+    printf( "---\n" );
+    printf( "\n" );
+}
 
 void
 main( int argC, char** argV )
 {
     RandomSeed();
+    globalPlatform.Log = Log;
 
     LARGE_INTEGER li;
     ASSERT_TRUE( QueryPerformanceFrequency( &li ) );
@@ -748,6 +2222,21 @@ main( int argC, char** argV )
     //TestFastSqrt();
     TestFastSqrtSpeed( &tmpArena );
 
+    TestResourcePool( &tmpArena );
+
+    TestWideSDF();
+    TestSDFProgram( &tmpArena );
+    TestSDFGradients();
+
+    // Enough for a whole DC volume of 121^3 cells
+    sz contouringArenaSize = MEGABYTES(512);
+    MemoryArena contouringArena;
+    InitArena( &contouringArena, new u8[contouringArenaSize], contouringArenaSize );
+    InitTestJobs( MEGABYTES(256), 4 );
+
+    TestParallelDCVolume( &contouringArena );
+    TestMCCaseIndices( &tmpArena );
+    TestParallelMarchVolume( &contouringArena );
 
 
     // TODO Add a cmdline argument 'bench' that allows executing among available benchmarks
@@ -771,4 +2260,43 @@ main( int argC, char** argV )
         TestSortingBenchmark( &sortingBenchmark, 10 );
         TearDownSortingBenchmark( &sortingBenchmark );
     }
+
+    bool testConcurrentQueueBenchmark = false;
+
+    if( testConcurrentQueueBenchmark )
+    {
+        TestConcurrentQueueBenchmark( 100000, &tmpArena );
+    }
+
+    bool testHashTableBenchmark = false;
+
+    if( testHashTableBenchmark )
+    {
+        TestHashTableBenchmark( 10000, 2 );
+    }
+
+    bool testMemoryPoolBenchmark = false;
+
+    if( testMemoryPoolBenchmark )
+    {
+        TestMemoryPoolBenchmark( 10000, MEGABYTES(512), &tmpArena );
+    }
+
+    bool testGridLayoutBenchmark = false;
+
+    if( testGridLayoutBenchmark )
+    {
+        TestGridLayoutBenchmark( 129, 5 );
+    }
+
+    bool testDCClusterBenchmark = false;
+
+    if( testDCClusterBenchmark )
+    {
+        TestDCClusterBenchmark( 12, 8, 3 );
+    }
 }
+
+#if !RELEASE
+DebugCycleCounter DEBUGglobalCounters[__COUNTER__];
+#endif
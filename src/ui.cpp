@@ -275,6 +275,66 @@ void DrawPerformanceCountersTotals( const DebugState* debugState, MemoryArena* t
     }
 }
 
+void DrawMemoryStats( const DebugState* debugState )
+{
+    f32 contentWidth = ImGui::GetWindowContentRegionWidth();
+
+    f32 col1Width = contentWidth * 0.34f;
+    f32 col2Width = contentWidth * 0.22f;
+    f32 col3Width = contentWidth * 0.22f;
+    f32 col4Width = contentWidth * 0.22f;
+
+    ImGui::Columns( 4, nullptr, true );
+    ImGui::SetColumnWidth( -1, col1Width );
+    ImGui::Text( "Tag" );
+    ImGui::NextColumn();
+    ImGui::SetColumnWidth( -1, col2Width );
+    DrawTextRightAligned( ImGui::GetColumnOffset( -1 ) + col2Width, 5, "Live MB" );
+    ImGui::NextColumn();
+    ImGui::SetColumnWidth( -1, col3Width );
+    DrawTextRightAligned( ImGui::GetColumnOffset( -1 ) + col3Width, 5, "Peak MB" );
+    ImGui::NextColumn();
+    ImGui::SetColumnWidth( -1, col4Width );
+    DrawTextRightAligned( ImGui::GetColumnOffset( -1 ) + col4Width, 5, "Allocs" );
+    ImGui::NextColumn();
+
+    for( int t = 0; t < MemoryTag::Values::count; ++t )
+    {
+        MemoryTagStats const& stats = debugState->memoryStats[t];
+
+        if( stats.allocationCount > 0 )
+        {
+            ImGui::Text( "%s", MemoryTag::Values::names[t] );
+            ImGui::NextColumn();
+
+            DrawTextRightAligned( ImGui::GetColumnOffset( -1 ) + col2Width, 5, "%0.3f", (f64)stats.liveBytes / MEGABYTES(1) );
+            ImGui::NextColumn();
+
+            DrawTextRightAligned( ImGui::GetColumnOffset( -1 ) + col3Width, 5, "%0.3f", (f64)stats.peakBytes / MEGABYTES(1) );
+            ImGui::NextColumn();
+
+            DrawTextRightAligned( ImGui::GetColumnOffset( -1 ) + col4Width, 5, "%llu", (u64)stats.allocationCount );
+            ImGui::NextColumn();
+        }
+    }
+}
+
+bool DumpMemoryStats( MemoryTagStats const* memoryStats, char const* filename )
+{
+    char buffer[4096];
+    int length = snprintf( buffer, ARRAYCOUNT(buffer), "%-16s %16s %16s %16s\n", "Tag", "Live bytes", "Peak bytes", "Allocations" );
+
+    for( int t = 0; t < MemoryTag::Values::count && length < ARRAYCOUNT(buffer); ++t )
+    {
+        MemoryTagStats const& stats = memoryStats[t];
+        length += snprintf( buffer + length, ARRAYCOUNT(buffer) - length, "%-16s %16llu %16llu %16llu\n",
+                            MemoryTag::Values::names[t], (u64)stats.liveBytes, (u64)stats.peakBytes, (u64)stats.allocationCount );
+    }
+
+    length = Min( length, (int)ARRAYCOUNT(buffer) - 1 );
+    return globalPlatform.DEBUGWriteEntireFile( filename, (u32)length, buffer );
+}
+
 void DrawPerformanceCountersWindow( const DebugState* debugState, u32 windowWidth, u32 windowHeight, MemoryArena* tmpArena )
 {
     ImGui::SetNextWindowPos( ImVec2( 0.f, windowHeight * 0.25f ), ImGuiCond_Always );
@@ -287,24 +347,38 @@ void DrawPerformanceCountersWindow( const DebugState* debugState, u32 windowWidt
     ImGui::Begin( "window_middle_panel", NULL,
                   ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize );
 
-    ImGui::BeginChild( "child_middle_left", ImVec2( ImGui::GetWindowContentRegionWidth() * 0.5f, -50.f ), true );
+    f32 leftWidth = ImGui::GetWindowContentRegionWidth() * 0.4f;
+    f32 middleWidth = ImGui::GetWindowContentRegionWidth() * 0.35f;
+
+    ImGui::BeginChild( "child_middle_left", ImVec2( leftWidth, -50.f ), true );
     DrawPerformanceCounters( debugState, tmpArena );
     ImGui::EndChild();
 
     ImGui::SameLine();
 
-    ImGui::BeginChild( "child_middle_right", ImVec2( 0.f, -50.f ), true );
+    ImGui::BeginChild( "child_middle_middle", ImVec2( middleWidth, -50.f ), true );
     DrawPerformanceCountersTotals( debugState, tmpArena );
     ImGui::EndChild();
 
+    ImGui::SameLine();
+
+    ImGui::BeginChild( "child_middle_right", ImVec2( 0.f, -50.f ), true );
+    DrawMemoryStats( debugState );
+    ImGui::EndChild();
+
     // Buttons row
-    ImGui::BeginChild( "child_buttons_left", ImVec2( ImGui::GetWindowContentRegionWidth() * 0.5f, 0.f ), false );
+    ImGui::BeginChild( "child_buttons_left", ImVec2( leftWidth, 0.f ), false );
     ImGui::Button( "Counters" );
     ImGui::EndChild();
     ImGui::SameLine();
-    ImGui::BeginChild( "child_buttons_right", ImVec2( 0.f, 0.f ), false );
+    ImGui::BeginChild( "child_buttons_middle", ImVec2( middleWidth, 0.f ), false );
     ImGui::Button( "Totals" );
     ImGui::EndChild();
+    ImGui::SameLine();
+    ImGui::BeginChild( "child_buttons_right", ImVec2( 0.f, 0.f ), false );
+    if( ImGui::Button( "Dump memory stats" ) )
+        DumpMemoryStats( debugState->memoryStats, "memstats.txt" );
+    ImGui::EndChild();
 
 
 
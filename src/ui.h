@@ -20,5 +20,7 @@ void DrawEditorStats( u16 windowWidth, u16 windowHeight, const char* statsText,
 void DrawAxisGizmos( RenderCommands *renderCommands );
 void DrawTextRightAligned( f32 cursorStartX, f32 rightPadding, const char* format, ... );
 void DrawPerformanceCounters( const DebugState* debugState, MemoryArena* tmpArena );
+void DrawMemoryStats( const DebugState* debugState );
+bool DumpMemoryStats( MemoryTagStats const* memoryStats, char const* filename );
 void DrawPerformanceCountersWindow( const DebugState* debugState, u32 windowWidth, u32 windowHeight, MemoryArena* tmpArena );
 void DrawEditorStateWindow( const v2i& windowP, const v2i& windowDim, const EditorState& state );
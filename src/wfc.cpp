@@ -934,9 +934,15 @@ DoWFC( Job* job )
 {
     const Spec& spec = *job->spec;
     const Input& input = *job->input;
-    State* state = job->state = PUSH_STRUCT( &job->memory->arena, State );
+    State* state = job->state;
 
-    bool propagateFirst = Init( spec, input, job->initInfo, state, &job->memory->arena ); 
+    // Only init when first started (we may be resuming after yielding)
+    bool propagateFirst = false;
+    if( !state )
+    {
+        state = job->state = PUSH_STRUCT( &job->memory->arena, State );
+        propagateFirst = Init( spec, input, job->initInfo, state, &job->memory->arena ); 
+    }
 
     while( !IsFinished( *state ) )
     {
@@ -973,6 +979,10 @@ DoWFC( Job* job )
             state->currentResult = Propagate( spec, input, state );
 
         propagateFirst = false;
+
+        // Give way to any frame-critical work. We'll be resumed later on
+        if( state->currentResult == InProgress && globalPlatform.ShouldYield( globalPlatform.loPriorityQueue ) )
+            return state->currentResult;
     }
 
     if( state->currentResult == Done )
@@ -1031,7 +1041,11 @@ PLATFORM_JOBQUEUE_CALLBACK(DoWFCJob)
     Job* job = (Job*)userData;
     Result result = DoWFC( job );
 
-    EndJobWithMemory( job, result );
+    if( result == InProgress )
+        // Yielded, so queue ourselves again to continue where we left off
+        globalPlatform.AddNewJob( globalPlatform.loPriorityQueue, DoWFCJob, job );
+    else
+        EndJobWithMemory( job, result );
 }
 
 internal bool
@@ -1050,8 +1064,10 @@ TryStartJobFor( const v2i& pOutputChunk, GlobalState* globalState, const ChunkIn
         job->input = &globalState->input;
         job->outputChunk = chunk;
         job->initInfo = initInfo;
+        job->state = nullptr;
 
-        globalPlatform.AddNewJob( globalPlatform.hiPriorityQueue,
+        // Chunks can take a long while, so run them in the background
+        globalPlatform.AddNewJob( globalPlatform.loPriorityQueue,
                                   DoWFCJob,
                                   job );
 
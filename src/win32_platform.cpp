@@ -85,6 +85,7 @@ internal IAudioRenderClient* globalAudioRenderClient;
 internal i64 globalPerfCounterFrequency;
 #if !RELEASE
 internal HCURSOR DEBUGglobalCursor;
+MemoryTagStats* DEBUGglobalMemoryStats;
 #endif
 
 
@@ -1848,63 +1849,195 @@ Win32InitOpenGL( HDC dc, const RenderCommands& commands, int frameVSyncSkipCount
     return true;
 }
 
+internal
+VIRTUAL_MEMORY_COMMIT(Win32CommitMemory)
+{
+    // NOTE VirtualAlloc already commits every page touched by the range
+    void* result = VirtualAlloc( address, size, MEM_COMMIT, PAGE_READWRITE );
+    return result != nullptr;
+}
+
+internal
+VIRTUAL_MEMORY_DECOMMIT(Win32DecommitMemory)
+{
+    // NOTE VirtualFree decommits every page touched by the range, so round inwards ourselves
+    sz pageSize = globalPlatformState.pageSize;
+    u8* start = (u8*)Align( address, pageSize );
+    u8* end = (u8*)(((sz)address + size) & ~(pageSize - 1));
+
+    if( end > start )
+        VirtualFree( start, Sz( end - start ), MEM_DECOMMIT );
+}
+
+#define MAIN_THREAD_WORKER_INDEX 0
+#define EXTERNAL_THREAD_WORKER_INDEX -1
+
+// Index of the worker the current thread runs as (used to find its own deque when adding jobs)
+// Threads not belonging to the pool don't have a deque, and can only add jobs through the shared queue
+internal thread_local i32 globalWorkerThreadIndex = EXTERNAL_THREAD_WORKER_INDEX;
+
 internal bool
-Win32DoNextQueuedJob( PlatformJobQueue* queue, int workerThreadIndex )
+Win32StealJob( PlatformJobQueue* queue, int workerThreadIndex, PlatformJobQueueJob* job )
 {
-    bool workAvailable = true;
+    // Start at a pseudo-random victim so thieves don't all convoy on the same deque
+    int victimCount = queue->workerCount;
+    int startIndex = (int)(Rdtsc() % (u64)victimCount);
+
+    for( int i = 0; i < victimCount; ++i )
+    {
+        int victimIndex = (startIndex + i) % victimCount;
+        if( victimIndex != workerThreadIndex && queue->workerQueues[victimIndex].Steal( job ) )
+            return true;
+    }
+
+    return false;
+}
+
+internal void Win32PushJob( PlatformJobQueue* queue, PlatformJobQueueJob const& job );
+internal void Win32WakeWorkers( PlatformJobQueue* queue, i32 jobCount );
 
-    u32 observedValue = queue->nextJobToRead;
-    u32 desiredValue = (observedValue + 1) % ARRAYCOUNT(queue->jobs);
+internal void
+Win32FinishGroupJob( PlatformJobGroup* group )
+{
+    // NOTE Copy continuations before decrementing, as the group can go away as soon as its count reaches zero
+    PlatformJobContinuation continuations[PLATFORM_MAX_JOB_CONTINUATIONS];
+    u32 continuationCount = group->continuationCount;
+    for( u32 i = 0; i < continuationCount; ++i )
+        continuations[i] = group->continuations[i];
 
-    if( observedValue != queue->nextJobToWrite )
+    // Last one out launches all continuations
+    if( AtomicAdd( &group->pendingCount, (u32)-1 ) == 1 )
     {
-        u32 index = AtomicCompareExchange( &queue->nextJobToRead, desiredValue, observedValue );
-        if( index == observedValue )
+        for( u32 i = 0; i < continuationCount; ++i )
         {
-            PlatformJobQueueJob job = queue->jobs[index];
-            job.callback( job.userData, workerThreadIndex );
-            
-            AtomicAdd( &queue->completionCount, 1 );
+            PlatformJobContinuation const& c = continuations[i];
+            // NOTE Already accounted for in the queue's completionTarget when the continuation was added
+            Win32PushJob( c.queue, { c.callback, c.userData, c.group } );
+            Win32WakeWorkers( c.queue, 1 );
         }
     }
-    else
-        workAvailable = false;
+}
+
+internal bool
+Win32DoNextQueuedJob( PlatformJobQueue* queue, int workerThreadIndex )
+{
+    PlatformJobQueueJob job;
+
+    bool workAvailable = queue->workerQueues[workerThreadIndex].Pop( &job )
+        || queue->sharedQueue.TryPop( &job )
+        || Win32StealJob( queue, workerThreadIndex, &job );
+
+    if( workAvailable )
+    {
+        // Whatever the job allocates from its worker's arena is gone as soon as it finishes
+        Win32WorkerMemory* workerMemory = &queue->pool->workerMemory[workerThreadIndex];
+        TemporaryMemory jobMemory = BeginTemporaryMemory( &workerMemory->arena );
+        // NOTE Jobs can run other jobs while they wait, so restore the outer job's start time afterwards
+        f64 outerJobStartMillis = workerMemory->jobStartMillis;
+        workerMemory->jobStartMillis = Win32CurrentTimeMillis();
+
+        job.callback( job.userData, workerThreadIndex );
+
+        workerMemory->jobStartMillis = outerJobStartMillis;
+        EndTemporaryMemory( jobMemory );
+
+        if( job.group )
+            Win32FinishGroupJob( job.group );
+        AtomicAdd( &queue->completionCount, 1 );
+    }
 
     return workAvailable;
 }
 
+internal bool
+Win32DoNextPoolJob( Win32WorkerPool* pool, int workerThreadIndex )
+{
+    for( int i = 0; i < pool->queueCount; ++i )
+    {
+        if( Win32DoNextQueuedJob( pool->queues[i], workerThreadIndex ) )
+            return true;
+    }
+
+    return false;
+}
+
 internal DWORD WINAPI
 Win32WorkerThreadProc( LPVOID lpParam )
 {
     Win32WorkerThreadContext* context = (Win32WorkerThreadContext*)lpParam;
-    PlatformJobQueue* queue = context->queue;
+    Win32WorkerPool* pool = context->pool;
+    globalWorkerThreadIndex = context->threadIndex;
 
     while( true )
     {
-        if( !Win32DoNextQueuedJob( queue, context->threadIndex ) )
+        if( !Win32DoNextPoolJob( pool, context->threadIndex ) )
         {
-            WaitForSingleObjectEx( queue->semaphore, INFINITE, FALSE );
+            // Announce we're going to sleep and check again, so we can't miss jobs added in between
+            AtomicAdd( &pool->sleepingWorkerCount, 1 );
+            if( !Win32DoNextPoolJob( pool, context->threadIndex ) )
+                WaitForSingleObjectEx( pool->semaphore, INFINITE, FALSE );
+            AtomicAdd( &pool->sleepingWorkerCount, (u32)-1 );
         }
     }
 
     return 0;
 }
 
-#define MAIN_THREAD_WORKER_INDEX 0
+internal void
+Win32InitJobQueue( PlatformJobQueue* queue, Win32WorkerPool* pool, int threadCount )
+{
+    *queue = {};
+
+    // Any one thread must be able to have all jobs in flight
+    u32 dequeCapacity = NextPowerOf2( PLATFORM_MAX_JOBQUEUE_JOBS );
+    sz dequeSize = sizeof(WorkStealingDeque<PlatformJobQueueJob>) + dequeCapacity * sizeof(PlatformJobQueueJob);
+    sz sharedQueueSize = sizeof(MPMCQueue<PlatformJobQueueJob>::Slot) * PLATFORM_SHARED_JOBQUEUE_JOBS;
+    sz memorySize = threadCount * dequeSize + sharedQueueSize + 64;
 
+    MemoryArena dequeArena;
+    InitArena( &dequeArena, (u8*)VirtualAlloc( 0, memorySize, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE ), memorySize );
+    ASSERT( dequeArena.base );
+
+    queue->workerQueues = PUSH_ARRAY( &dequeArena, WorkStealingDeque<PlatformJobQueueJob>, threadCount, Aligned( 64 ) );
+    queue->workerCount = threadCount;
+    queue->pool = pool;
+    INIT( &queue->sharedQueue ) MPMCQueue<PlatformJobQueueJob>( &dequeArena, PLATFORM_SHARED_JOBQUEUE_JOBS, NoClear() );
+
+    for( int i = 0; i < threadCount; ++i )
+        INIT( &queue->workerQueues[i] ) WorkStealingDeque<PlatformJobQueueJob>( &dequeArena, dequeCapacity, NoClear() );
+
+    // Queues are added in order of decreasing priority
+    ASSERT( pool->queueCount < ARRAYCOUNT(pool->queues) );
+    pool->queues[pool->queueCount++] = queue;
+}
+
+// NOTE Call after all queues have been initialized
 internal void
-Win32InitJobQueue( PlatformJobQueue* queue,
-                   Win32WorkerThreadContext* threadContexts, int threadCount )
+Win32InitWorkerPool( Win32WorkerPool* pool, Win32WorkerThreadContext* threadContexts, int threadCount,
+                     VirtualMemoryBacking* arenaBacking )
 {
-    *queue = {0};
-    queue->semaphore = CreateSemaphoreEx( 0, 0, threadCount,
-                                          0, 0, SEMAPHORE_ALL_ACCESS );
+    pool->semaphore = CreateSemaphoreEx( 0, 0, threadCount,
+                                         0, 0, SEMAPHORE_ALL_ACCESS );
+
+    sz memorySize = threadCount * sizeof(Win32WorkerMemory) + 64;
+    MemoryArena poolArena;
+    InitArena( &poolArena, (u8*)VirtualAlloc( 0, memorySize, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE ), memorySize );
+    ASSERT( poolArena.base );
+
+    pool->workerMemory = PUSH_ARRAY( &poolArena, Win32WorkerMemory, threadCount, Aligned( 64 ) );
+    pool->workerCount = threadCount;
+    pool->yieldBudgetMillis = PLATFORM_DEFAULT_YIELD_BUDGET_MILLIS;
+
+    // Worker arenas only commit what they actually use (and give it back after big jobs)
+    u8* arenasBase = (u8*)VirtualAlloc( 0, threadCount * PLATFORM_WORKER_ARENA_SIZE, MEM_RESERVE, PAGE_NOACCESS );
+    ASSERT( arenasBase );
 
     for( int i = 0; i < threadCount; ++i )
     {
-        // FIXME Separate platform thread infos from the queues!
-        // TODO Consider creating an arena per thread (specially for hi-prio threads!)
-        threadContexts[i] = { i, queue };
+        InitArena( &pool->workerMemory[i].arena, arenasBase + i * PLATFORM_WORKER_ARENA_SIZE, PLATFORM_WORKER_ARENA_SIZE,
+                   arenaBacking );
+        SetArenaTag( &pool->workerMemory[i].arena, MemoryTag::Jobs() );
+        threadContexts[i] = { i, pool };
 
         // Worker thread index 0 is reserved for the main thread!
         if( i > MAIN_THREAD_WORKER_INDEX )
@@ -1918,20 +2051,147 @@ Win32InitJobQueue( PlatformJobQueue* queue,
     }
 }
 
+internal void
+Win32WakeWorkers( PlatformJobQueue* queue, i32 jobCount )
+{
+    // NOTE The atomic add on completionTarget before calling this acts as a full barrier, so we either see
+    // a sleeping worker here, or that worker will see the new jobs when it checks again before sleeping
+    Win32WorkerPool* pool = queue->pool;
+    i32 sleepingCount = (i32)AtomicLoad( &pool->sleepingWorkerCount );
+    i32 wakeCount = Min( jobCount, sleepingCount );
+
+    if( wakeCount > 0 )
+        ReleaseSemaphore( pool->semaphore, wakeCount, 0 );
+}
+
+internal void
+Win32PushJob( PlatformJobQueue* queue, PlatformJobQueueJob const& job )
+{
+    i32 workerThreadIndex = globalWorkerThreadIndex;
+    bool isPoolThread = workerThreadIndex != EXTERNAL_THREAD_WORKER_INDEX && workerThreadIndex < queue->workerCount;
+
+    while( true )
+    {
+        if( isPoolThread && queue->workerQueues[workerThreadIndex].Push( job ) )
+            break;
+        if( queue->sharedQueue.TryPush( job ) )
+            break;
+
+        // Back-pressure: everything is full, so help drain the queue (or just wait if we can't run jobs) until there's room
+        if( !isPoolThread || !Win32DoNextQueuedJob( queue, workerThreadIndex ) )
+            _mm_pause();
+    }
+}
+
 internal
 PLATFORM_ADD_NEW_JOB(Win32AddNewJob)
 {
-    // NOTE Single producer
-    ASSERT( (queue->nextJobToWrite + 1) % ARRAYCOUNT(queue->jobs) != queue->nextJobToRead );
+    Win32PushJob( queue, { callback, userData, nullptr } );
+
+    AtomicAdd( &queue->completionTarget, 1 );
+    Win32WakeWorkers( queue, 1 );
+}
+
+internal
+PLATFORM_ADD_GROUP_JOB(Win32AddGroupJob)
+{
+    if( group )
+        AtomicAdd( &group->pendingCount, 1 );
+    Win32PushJob( queue, { callback, userData, group } );
+
+    AtomicAdd( &queue->completionTarget, 1 );
+    Win32WakeWorkers( queue, 1 );
+}
+
+internal
+PLATFORM_ADD_NEW_JOBS(Win32AddNewJobs)
+{
+    if( group )
+        AtomicAdd( &group->pendingCount, (u32)jobCount );
+
+    u8* userData = (u8*)userDataArray;
+    for( int i = 0; i < jobCount; ++i )
+    {
+        Win32PushJob( queue, { callback, userData, group } );
+        userData += userDataStride;
+    }
+
+    AtomicAdd( &queue->completionTarget, (u32)jobCount );
+    Win32WakeWorkers( queue, jobCount );
+}
+
+internal
+PLATFORM_ADD_CONTINUATION(Win32AddContinuation)
+{
+    ASSERT( dependency->continuationCount < PLATFORM_MAX_JOB_CONTINUATIONS );
+    dependency->continuations[dependency->continuationCount++] = { queue, callback, userData, group };
+
+    // Account for the job right away, so waiting on either group (or the whole queue) includes it
+    if( group )
+        AtomicAdd( &group->pendingCount, 1 );
+    AtomicAdd( &queue->completionTarget, 1 );
+}
+
+internal
+PLATFORM_WAIT_FOR_JOB_GROUP(Win32WaitForJobGroup)
+{
+    i32 workerThreadIndex = globalWorkerThreadIndex;
+    bool isPoolThread = workerThreadIndex != EXTERNAL_THREAD_WORKER_INDEX && workerThreadIndex < queue->workerCount;
 
-    PlatformJobQueueJob& job = queue->jobs[queue->nextJobToWrite];
-    job = { callback, userData };
-    ++queue->completionTarget;
+    while( !IsDone( group ) )
+    {
+        if( !isPoolThread || !Win32DoNextQueuedJob( queue, workerThreadIndex ) )
+            _mm_pause();
+    }
+}
 
-    MEMORY_WRITE_BARRIER;
+internal bool
+Win32HasQueuedJobs( PlatformJobQueue* queue )
+{
+    if( queue->sharedQueue.Count() > 0 )
+        return true;
+
+    for( int i = 0; i < queue->workerCount; ++i )
+    {
+        if( queue->workerQueues[i].Count() > 0 )
+            return true;
+    }
 
-    queue->nextJobToWrite = (queue->nextJobToWrite + 1) % ARRAYCOUNT(queue->jobs);
-    ReleaseSemaphore( queue->semaphore, 1, 0 );
+    return false;
+}
+
+internal
+PLATFORM_SHOULD_YIELD(Win32ShouldYield)
+{
+    // Yield whenever there's work waiting to be picked up in any queue with a higher priority
+    Win32WorkerPool* pool = queue->pool;
+    bool isLowerPriority = false;
+    for( int i = 0; i < pool->queueCount && pool->queues[i] != queue; ++i )
+    {
+        if( Win32HasQueuedJobs( pool->queues[i] ) )
+            return true;
+        isLowerPriority = true;
+    }
+
+    // .. or once the job has used up its slice of the frame, so it doesn't hog the worker for too long
+    i32 workerThreadIndex = globalWorkerThreadIndex;
+    if( isLowerPriority && workerThreadIndex != EXTERNAL_THREAD_WORKER_INDEX && workerThreadIndex < pool->workerCount )
+    {
+        f64 elapsedMillis = Win32CurrentTimeMillis() - pool->workerMemory[workerThreadIndex].jobStartMillis;
+        if( elapsedMillis > pool->yieldBudgetMillis )
+            return true;
+    }
+
+    return false;
+}
+
+internal
+PLATFORM_GET_WORKER_ARENA(Win32GetWorkerArena)
+{
+    Win32WorkerPool* pool = &globalPlatformState.workerPool;
+    ASSERT( workerThreadIndex >= 0 && workerThreadIndex < pool->workerCount );
+
+    return &pool->workerMemory[workerThreadIndex].arena;
 }
 
 internal
@@ -1941,13 +2201,11 @@ PLATFORM_COMPLETE_ALL_JOBS(Win32CompleteAllJobs)
     // FIXME Assert that this is only called from the main thread!
     //
     //
-    while( queue->completionCount < queue->completionTarget )
+    // NOTE Counters are never reset, so other threads can keep adding jobs while we wait
+    while( (i32)(AtomicLoad( &queue->completionTarget ) - AtomicLoad( &queue->completionCount )) > 0 )
     {
         Win32DoNextQueuedJob( queue, MAIN_THREAD_WORKER_INDEX );
     }
-
-    queue->completionTarget = 0;
-    queue->completionCount = 0;
 }
 
 
@@ -1999,17 +2257,34 @@ main( int argC, char **argV )
     globalPlatform.DEBUGGetParentPath = Win32GetParentPath;
     globalPlatform.DEBUGCurrentTimeMillis = Win32CurrentTimeMillis;
     globalPlatform.AddNewJob = Win32AddNewJob;
+    globalPlatform.AddGroupJob = Win32AddGroupJob;
+    globalPlatform.AddNewJobs = Win32AddNewJobs;
+    globalPlatform.AddContinuation = Win32AddContinuation;
+    globalPlatform.WaitForJobGroup = Win32WaitForJobGroup;
+    globalPlatform.ShouldYield = Win32ShouldYield;
+    globalPlatform.GetWorkerArena = Win32GetWorkerArena;
     globalPlatform.CompleteAllJobs = Win32CompleteAllJobs;
     globalPlatform.AllocateOrUpdateTexture = Win32AllocateTexture;
     globalPlatform.DeallocateTexture = Win32DeallocateTexture;
 
+    globalPlatformState.pageSize = systemInfo.dwPageSize;
+    VirtualMemoryBacking* memoryBacking = &globalPlatformState.memoryBacking;
+    memoryBacking->Commit = Win32CommitMemory;
+    memoryBacking->Decommit = Win32DecommitMemory;
+    memoryBacking->commitBlockSize = MEGABYTES(2);
+    memoryBacking->decommitThreshold = MEGABYTES(64);
+
     // FIXME Should be dynamic, but can't be bothered!
     Win32WorkerThreadContext threadContexts[32];
     int coreCount = int( systemInfo.dwNumberOfProcessors );
     ASSERT( coreCount <= ARRAYCOUNT(threadContexts) );
 
-    Win32InitJobQueue( &globalPlatformState.hiPriorityQueue, threadContexts, coreCount );
+    globalWorkerThreadIndex = MAIN_THREAD_WORKER_INDEX;
+    Win32InitJobQueue( &globalPlatformState.hiPriorityQueue, &globalPlatformState.workerPool, coreCount );
+    Win32InitJobQueue( &globalPlatformState.loPriorityQueue, &globalPlatformState.workerPool, coreCount );
+    Win32InitWorkerPool( &globalPlatformState.workerPool, threadContexts, coreCount, memoryBacking );
     globalPlatform.hiPriorityQueue = &globalPlatformState.hiPriorityQueue;
+    globalPlatform.loPriorityQueue = &globalPlatformState.loPriorityQueue;
     globalPlatform.coreThreadsCount = coreCount;
 
     globalPlatformState.renderer = Renderer::OpenGL;
@@ -2129,7 +2404,8 @@ main( int argC, char **argV )
             {
                 LPVOID baseAddress = 0;
 
-                // TODO Make simple growable arenas for these, that _reserve_ say 8Gb each, but only commit in sizeable blocks as needed
+                // TODO Reserve a lot more and pass our memory backing in gameMemory.storageBacking so the game arenas can grow,
+                // once looped live code editing only snapshots the committed ranges (it copies the whole block right now)
                 // Allocate game memory pools
                 u64 totalSize = gameMemory.permanentStorageSize + gameMemory.transientStorageSize;
 #if !RELEASE
@@ -2145,6 +2421,7 @@ main( int argC, char **argV )
                 gameMemory.transientStorage = (u8 *)gameMemory.permanentStorage + gameMemory.permanentStorageSize;
 #if !RELEASE
                 gameMemory.debugStorage = (u8*)gameMemory.transientStorage + gameMemory.transientStorageSize;
+                DEBUGglobalMemoryStats = ((DebugState*)gameMemory.debugStorage)->memoryStats;
 #endif
 
                 i16 *soundSamples = (i16 *)VirtualAlloc( 0, audioOutput.bufferSizeFrames * audioOutput.bytesPerFrame,
@@ -2212,6 +2489,8 @@ main( int argC, char **argV )
                     u64 lastCycleCounter = Rdtsc();
 
                     f32 targetElapsedPerFrameSecs = 1.0f / videoTargetFramerateHz;
+                    // Background jobs get at most one frame's worth of time before they yield
+                    globalPlatformState.workerPool.yieldBudgetMillis = targetElapsedPerFrameSecs * 1000.0;
                     // Assume our target for the first frame
                     f32 frameElapsedSeconds = targetElapsedPerFrameSecs;
 
@@ -2249,6 +2528,7 @@ main( int argC, char **argV )
                         if( CompareFileTime( &dllWriteTime, &globalPlatformState.gameCode.lastDLLWriteTime ) != 0 )
                         {
                             Win32CompleteAllJobs( globalPlatform.hiPriorityQueue );
+                            Win32CompleteAllJobs( globalPlatform.loPriorityQueue );
 
                             if( !globalPlatformState.gameCodeReloading )
                                 LOG( "Detected updated game DLL. Reloading.." );
@@ -53,24 +53,59 @@ struct PlatformJobQueueJob
 {
     PlatformJobQueueCallbackFunc* callback;
     void* userData;
+    PlatformJobGroup* group;
 };
 
+struct Win32WorkerPool;
+
 struct PlatformJobQueue
 {
-    HANDLE semaphore;
-    volatile u32 nextJobToRead;
-    volatile u32 nextJobToWrite;
+    // One deque per worker thread (index 0 is the main thread). Threads add jobs to their own deque
+    // and steal from everybody else's when they run out
+    WorkStealingDeque<PlatformJobQueueJob>* workerQueues;
+    i32 workerCount;
+    // Jobs added from threads outside the pool, plus overflow from any full deques
+    MPMCQueue<PlatformJobQueueJob> sharedQueue;
+
+    // Threads running jobs from this queue (shared with all other queues)
+    Win32WorkerPool* pool;
 
     volatile u32 completionCount;
     volatile u32 completionTarget;
+};
+
+#define WIN32_MAX_JOB_QUEUES 2
+
+// Scratch memory for each worker. Padded to a full cache line so workers never touch each other's
+struct alignas(64) Win32WorkerMemory
+{
+    MemoryArena arena;
+    // When the job currently running in this worker started
+    f64 jobStartMillis;
+};
+
+// All queues share the same worker threads, which always run jobs from higher priority queues first
+// and sleep on a common semaphore when there's nothing to do in any of them
+struct Win32WorkerPool
+{
+    // In order of decreasing priority
+    PlatformJobQueue* queues[WIN32_MAX_JOB_QUEUES];
+    i32 queueCount;
 
-    PlatformJobQueueJob jobs[PLATFORM_MAX_JOBQUEUE_JOBS];
+    HANDLE semaphore;
+    volatile u32 sleepingWorkerCount;
+
+    Win32WorkerMemory* workerMemory;
+    i32 workerCount;
+
+    // Longest a job from a lower priority queue gets to run before it's asked to yield, even if there's no other work pending
+    f64 yieldBudgetMillis;
 };
 
 struct Win32WorkerThreadContext
 {
     i32 threadIndex;
-    PlatformJobQueue* queue;
+    Win32WorkerPool* pool;
 };
 
 struct Win32GameCode
@@ -124,6 +159,9 @@ struct Win32State
     u64 gameMemorySize;
     Win32ReplayBuffer replayBuffers[MAX_REPLAY_BUFFERS];
 
+    sz pageSize;
+    VirtualMemoryBacking memoryBacking;
+
     i32 inputRecordingIndex;
     HANDLE recordingHandle;
     i32 inputPlaybackIndex;
@@ -136,6 +174,8 @@ struct Win32State
     i32 assetListenerCount;
 
     PlatformJobQueue hiPriorityQueue;
+    PlatformJobQueue loPriorityQueue;
+    Win32WorkerPool workerPool;
 };
 
 // Taken from https://github.com/depp/keycode
@@ -35,8 +35,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 inline u32
 ClusterHash( const v3i& clusterP, i32 tableSize )
 {
-    // TODO Better hash function! x)
-    u32 hashValue = (u32)(19*clusterP.x + 7*clusterP.y + 3*clusterP.z);
+    // Large primes, so neighbouring clusters don't end up with equal hashes (the table mixes the result again anyway)
+    u32 hashValue = ((u32)clusterP.x * 73856093u) ^ ((u32)clusterP.y * 19349663u) ^ ((u32)clusterP.z * 83492791u);
     return hashValue;
 }
 
@@ -61,7 +61,7 @@ CalcSimClusterIndex( v3i const& clusterRelativeP )
 #define INITIAL_CLUSTER_COORDS V3i( I32MAX, I32MAX, I32MAX )
 
 void
-InitWorld( World* world, MemoryArena* worldArena, MemoryArena* transientArena )
+InitWorld( World* world, MemoryArena* worldArena, MemoryArena* transientArena, sz clusterCacheBudget = DefaultClusterCacheBudget )
 {
     //RandomSeed();
 
@@ -78,7 +78,21 @@ InitWorld( World* world, MemoryArena* worldArena, MemoryArena* transientArena )
     playerMaterial->diffuseMap = textureResult.handle;
     world->player->mesh.material = playerMaterial;
 
-    INIT( &world->clusterTable ) HashTable<v3i, Cluster, ClusterHash>( worldArena, 256*1024 );
+    INIT( &world->clusterTable ) HashTable<v3i, Cluster, ClusterHash>( worldArena, 1024 );
+    {
+        ClusterCache* cache = &world->clusterCache;
+        *cache = {};
+        // Arenas are only part of the budget, so this will rarely be full before going over it
+        sz maxPoolSize = Available( *worldArena ) / 4;
+        if( clusterCacheBudget > maxPoolSize )
+        {
+            LOG( "WARN :: Cluster cache budget of %llu MB doesn't fit in the world arena, clamping to %llu MB",
+                 (u64)(clusterCacheBudget / MEGABYTES(1)), (u64)(maxPoolSize / MEGABYTES(1)) );
+            clusterCacheBudget = maxPoolSize;
+        }
+        InitMemoryPool( &cache->memoryPool, worldArena, clusterCacheBudget, true );
+        cache->budgetBytes = clusterCacheBudget;
+    }
     INIT( &world->liveEntities ) BucketArray<LiveEntity>( worldArena, 256 );
     INIT( &world->entityRefs ) HashTable<u32, StoredEntity *, EntityHash>( worldArena, 1024 );
 
@@ -94,18 +108,19 @@ InitWorld( World* world, MemoryArena* worldArena, MemoryArena* transientArena )
     world->meshGenerators[GenRoom] = MeshGeneratorRoomFunc;
 #endif
 
-    const u32 coreThreadsCount = 1; //globalPlatform.coreThreadsCount;
-    world->samplingCache = PUSH_ARRAY( worldArena, IsoSurfaceSamplingCache, coreThreadsCount );
-    world->meshPools = PUSH_ARRAY( worldArena, MeshPool, coreThreadsCount );
-    sz arenaAvailable = Available( *worldArena );
-    sz maxPerThread = arenaAvailable / 2 / coreThreadsCount;
+    const i32 coreThreadsCount = globalPlatform.coreThreadsCount;
+    world->workerData = PUSH_ARRAY( worldArena, MeshGeneratorWorkerData, coreThreadsCount, Aligned( 64 ) );
+    world->workerCount = coreThreadsCount;
+    // NOTE The world arena may just be a huge reserved range that commits pages as needed, so cap this
+    sz meshHeapSize = Min( (u64)Available( *worldArena ) / 2, (u64)GIGABYTES(1) );
+    InitMeshHeap( &world->meshHeap, worldArena, meshHeapSize );
 
     // NOTE This limits the max room size we can sample
     const v2i maxVoxelsPerAxis = V2i( 150 );
     for( int i = 0; i < coreThreadsCount; ++i )
     {
-        world->samplingCache[i] = InitSurfaceSamplingCache( worldArena, maxVoxelsPerAxis );
-        InitMeshPool( &world->meshPools[i], worldArena, maxPerThread );
+        world->workerData[i].samplingCache = InitSurfaceSamplingCache( worldArena, maxVoxelsPerAxis );
+        InitMeshPool( &world->workerData[i].meshPool, &world->meshHeap, worldArena );
     }
 
     // Pre-calc offsets to each simulated cluster to pass to shaders
@@ -143,7 +158,8 @@ AddEntityToCluster( Cluster* cluster, const v3i& clusterP, const v3& entityRelat
     newEntity->generator = { generatorFunc, generatorData };
 }
 
-bool SplitVolume( BinaryVolume* v, Array<BinaryVolume>* volumes, const int minVolumeSize, i32* totalVolumesCount )
+bool SplitVolume( BinaryVolume* v, Array<BinaryVolume>* volumes, const int minVolumeSize, RandomStream* random,
+                  i32* totalVolumesCount )
 {
     if( v->leftChild || v->rightChild )
         return false;
@@ -174,8 +190,7 @@ bool SplitVolume( BinaryVolume* v, Array<BinaryVolume>* volumes, const int minVo
         splitDimIndex = maxDimIndex;
     else
     {
-        // FIXME Random functions should have the seed always passed in!
-        splitDimIndex = RandomRangeI32( 0, remainingDimCount - 1 );
+        splitDimIndex = RandomRangeI32( random, 0, remainingDimCount - 1 );
         if( dims.e[splitDimIndex] == 0.f )
             splitDimIndex++;
     }
@@ -185,7 +200,7 @@ bool SplitVolume( BinaryVolume* v, Array<BinaryVolume>* volumes, const int minVo
     int splitSizeMax = dims.e[splitDimIndex] - minVolumeSize;
     if( splitSizeMax > minVolumeSize )
     {
-        int splitSize = RandomRangeI32( minVolumeSize, splitSizeMax );
+        int splitSize = RandomRangeI32( random, minVolumeSize, splitSizeMax );
 
         BinaryVolume* left = volumes->PushEmpty();
         left->voxelP = v->voxelP;
@@ -248,6 +263,68 @@ INLINE f32 SDFHall( WorldCoords const& worldP, Hall const& hall )
     return result;
 }
 
+INLINE f32x4 SDFRoom( v3x4 const& p, Room const& room )
+{
+    v3x4 invP = p - room.bounds.center;
+    f32x4 result = SDFBox( invP, room.bounds.halfSize - V3( VoxelSizeMeters * 1.01f ) );
+
+    return result;
+}
+
+INLINE f32x4 SDFHall( v3x4 const& p, Hall const& hall )
+{
+    const v3 volumeBorder = V3( VoxelSizeMeters * 1.01f );
+    f32x4 result = SDFBox( p - hall.sectionBounds[0].center, hall.sectionBounds[0].halfSize - volumeBorder );
+    result = SDFUnion( result, SDFBox( p - hall.sectionBounds[1].center, hall.sectionBounds[1].halfSize - volumeBorder ) );
+    result = SDFUnion( result, SDFBox( p - hall.sectionBounds[2].center, hall.sectionBounds[2].halfSize - volumeBorder ) );
+
+    return result;
+}
+
+INLINE v3i
+VolumeGridCell( v3 const& p )
+{
+    // Points outside the cluster just use the closest cell
+    v3 cellP = (p + ClusterHalfSize) * (1.f / VolumeGridCellSizeMeters);
+    v3i result = { (i32)cellP.x, (i32)cellP.y, (i32)cellP.z };
+    Clamp( &result.x, 0, VolumeGridCellsPerAxis - 1 );
+    Clamp( &result.y, 0, VolumeGridCellsPerAxis - 1 );
+    Clamp( &result.z, 0, VolumeGridCellsPerAxis - 1 );
+
+    return result;
+}
+
+INLINE i32
+VolumeGridCellIndex( v3i const& cell )
+{
+    return (cell.z * VolumeGridCellsPerAxis + cell.y) * VolumeGridCellsPerAxis + cell.x;
+}
+
+INLINE i32
+VolumeGridCellIndex( v3 const& p )
+{
+    return VolumeGridCellIndex( VolumeGridCell( p ) );
+}
+
+// Distinct grid cells containing the lanes starting at batch index 'b'
+// NOTE Visiting a volume twice is harmless, as applying the same union / substraction again doesn't change the result
+internal int
+GatherLaneCells( IsoSurfaceBatch const* batch, int b, i32 cells[LaneWidth] )
+{
+    int count = 0;
+    for( int l = 0; l < LaneWidth; ++l )
+    {
+        i32 cellIndex = VolumeGridCellIndex( V3( batch->x[b + l], batch->y[b + l], batch->z[b + l] ) );
+
+        bool found = false;
+        for( int c = 0; c < count && !found; ++c )
+            found = cells[c] == cellIndex;
+        if( !found )
+            cells[count++] = cellIndex;
+    }
+    return count;
+}
+
 ISO_SURFACE_FUNC(RoomSurfaceFunc)
 {
     TIMED_FUNC_WITH_TOTALS;
@@ -255,14 +332,16 @@ ISO_SURFACE_FUNC(RoomSurfaceFunc)
     ASSERT( samplingData->type == SamplingDataType::ClusterData );
 
     ClusterSamplingData* clusterData = (ClusterSamplingData*)samplingData;
+    ClusterVolumeGrid const& grid = clusterData->volumeGrid;
     Room const& room = clusterData->rooms[clusterData->sampledVolumeIndex];
 
     f32 result = SDFRoom( worldP, room );
 
     // Union with any halls which intersect our volume
-    for( int i = 0; i < clusterData->halls.count; ++i )
+    i32 cellIndex = VolumeGridCellIndex( worldP.relativeP );
+    for( int n = grid.hallStarts[cellIndex]; n < grid.hallStarts[cellIndex + 1]; ++n )
     {
-        Hall const& hall = clusterData->halls[i];
+        Hall const& hall = clusterData->halls[grid.hallIndices[n]];
 
         if( ContainsOrTouches( hall.bounds, worldP.relativeP ) )
         {
@@ -280,6 +359,47 @@ ISO_SURFACE_FUNC(RoomSurfaceFunc)
     return result;
 }
 
+ISO_SURFACE_BATCH_FUNC(RoomSurfaceBatchFunc)
+{
+    TIMED_FUNC_WITH_TOTALS;
+
+    ASSERT( samplingData->type == SamplingDataType::ClusterData );
+
+    ClusterSamplingData* clusterData = (ClusterSamplingData*)samplingData;
+    ClusterVolumeGrid const& grid = clusterData->volumeGrid;
+    Room const& room = clusterData->rooms[clusterData->sampledVolumeIndex];
+
+    for( int b = 0; b < batch->count; b += LaneWidth )
+    {
+        v3x4 p = LoadV3x4( batch->x + b, batch->y + b, batch->z + b );
+        f32x4 result = SDFRoom( p, room );
+
+        i32 cells[LaneWidth];
+        int cellCount = GatherLaneCells( batch, b, cells );
+
+        // Union with any halls which intersect our volume (only on the lanes inside each one)
+        for( int c = 0; c < cellCount; ++c )
+        {
+            for( int n = grid.hallStarts[cells[c]]; n < grid.hallStarts[cells[c] + 1]; ++n )
+            {
+                Hall const& hall = clusterData->halls[grid.hallIndices[n]];
+
+                maskx4 inside = ContainsOrTouches( hall.bounds, p );
+                if( AnyTrue( inside ) )
+                    result = Select( inside, SDFUnion( result, SDFHall( p, hall ) ), result );
+            }
+        }
+
+        if( !samplingData->zeroThickness )
+        {
+            // Carve the inside and give it a thickness
+            result = SDFOnion( result, VoxelSizeMeters * 0.5f );
+        }
+
+        StoreF32x4( batch->results + b, result );
+    }
+}
+
 ISO_SURFACE_FUNC(HallSurfaceFunc)
 {
     TIMED_FUNC_WITH_TOTALS;
@@ -287,6 +407,8 @@ ISO_SURFACE_FUNC(HallSurfaceFunc)
     ASSERT( samplingData->type == SamplingDataType::ClusterData );
 
     ClusterSamplingData* clusterData = (ClusterSamplingData*)samplingData;
+    ClusterVolumeGrid const& grid = clusterData->volumeGrid;
+    i32 cellIndex = VolumeGridCellIndex( worldP.relativeP );
 #if 0
     Hall const& hall = clusterData->halls[clusterData->sampledVolumeIndex];
 
@@ -297,9 +419,9 @@ ISO_SURFACE_FUNC(HallSurfaceFunc)
 
 #if 1
     // Union with any halls which intersect our volume
-    for( int i = 0; i < clusterData->halls.count; ++i )
+    for( int n = grid.hallStarts[cellIndex]; n < grid.hallStarts[cellIndex + 1]; ++n )
     {
-        Hall const& other = clusterData->halls[i];
+        Hall const& other = clusterData->halls[grid.hallIndices[n]];
 
         if( ContainsOrTouches( other.bounds, worldP.relativeP ) )
         {
@@ -316,9 +438,9 @@ ISO_SURFACE_FUNC(HallSurfaceFunc)
     }
 
 #if 1
-    for( int i = 0; i < clusterData->rooms.count; ++i )
+    for( int n = grid.roomStarts[cellIndex]; n < grid.roomStarts[cellIndex + 1]; ++n )
     {
-        Room const& room = clusterData->rooms[i];
+        Room const& room = clusterData->rooms[grid.roomIndices[n]];
 
         if( ContainsOrTouches( room.bounds, worldP.relativeP ) )
         {
@@ -332,6 +454,58 @@ ISO_SURFACE_FUNC(HallSurfaceFunc)
     return result;
 }
 
+ISO_SURFACE_BATCH_FUNC(HallSurfaceBatchFunc)
+{
+    TIMED_FUNC_WITH_TOTALS;
+
+    ASSERT( samplingData->type == SamplingDataType::ClusterData );
+
+    ClusterSamplingData* clusterData = (ClusterSamplingData*)samplingData;
+    ClusterVolumeGrid const& grid = clusterData->volumeGrid;
+
+    for( int b = 0; b < batch->count; b += LaneWidth )
+    {
+        v3x4 p = LoadV3x4( batch->x + b, batch->y + b, batch->z + b );
+        f32x4 result = F32x4( F32MAX );
+
+        i32 cells[LaneWidth];
+        int cellCount = GatherLaneCells( batch, b, cells );
+
+        // Union with any halls which intersect our volume
+        for( int c = 0; c < cellCount; ++c )
+        {
+            for( int n = grid.hallStarts[cells[c]]; n < grid.hallStarts[cells[c] + 1]; ++n )
+            {
+                Hall const& other = clusterData->halls[grid.hallIndices[n]];
+
+                maskx4 inside = ContainsOrTouches( other.bounds, p );
+                if( AnyTrue( inside ) )
+                    result = Select( inside, SDFUnion( result, SDFHall( p, other ) ), result );
+            }
+        }
+
+        if( !samplingData->zeroThickness )
+        {
+            // Carve the inside and give it a thickness
+            result = SDFOnion( result, VoxelSizeMeters * 0.5f );
+        }
+
+        for( int c = 0; c < cellCount; ++c )
+        {
+            for( int n = grid.roomStarts[cells[c]]; n < grid.roomStarts[cells[c] + 1]; ++n )
+            {
+                Room const& room = clusterData->rooms[grid.roomIndices[n]];
+
+                maskx4 inside = ContainsOrTouches( room.bounds, p );
+                if( AnyTrue( inside ) )
+                    result = Select( inside, SDFSubstraction( result, SDFRoom( p, room ) ), result );
+            }
+        }
+
+        StoreF32x4( batch->results + b, result );
+    }
+}
+
 ISO_SURFACE_FUNC(ClusterSurfaceFunc)
 {
     TIMED_FUNC;
@@ -340,19 +514,21 @@ ISO_SURFACE_FUNC(ClusterSurfaceFunc)
 
     f32 result = F32MAX;
     ClusterSamplingData* clusterData = (ClusterSamplingData*)samplingData;
+    ClusterVolumeGrid const& grid = clusterData->volumeGrid;
+    i32 cellIndex = VolumeGridCellIndex( worldP.relativeP );
 
-    for( int i = 0; i < clusterData->rooms.count; ++i )
+    for( int n = grid.roomStarts[cellIndex]; n < grid.roomStarts[cellIndex + 1]; ++n )
     {
-        Room const& room = clusterData->rooms[i];
+        Room const& room = clusterData->rooms[grid.roomIndices[n]];
         if( ContainsOrTouches( room.bounds, worldP.relativeP ) )
         {
             f32 roomSDF = SDFRoom( worldP, room );
             result = SDFUnion( result, roomSDF );
         }
     }
-    for( int i = 0; i < clusterData->halls.count; ++i )
+    for( int n = grid.hallStarts[cellIndex]; n < grid.hallStarts[cellIndex + 1]; ++n )
     {
-        Hall const& hall = clusterData->halls[i];
+        Hall const& hall = clusterData->halls[grid.hallIndices[n]];
         if( ContainsOrTouches( hall.bounds, worldP.relativeP ) )
         {
             f32 hallSDF = SDFHall( worldP, hall );
@@ -363,6 +539,45 @@ ISO_SURFACE_FUNC(ClusterSurfaceFunc)
     return result;
 }
 
+ISO_SURFACE_BATCH_FUNC(ClusterSurfaceBatchFunc)
+{
+    TIMED_FUNC;
+
+    ASSERT( samplingData->type == SamplingDataType::ClusterData );
+
+    ClusterSamplingData* clusterData = (ClusterSamplingData*)samplingData;
+    ClusterVolumeGrid const& grid = clusterData->volumeGrid;
+
+    for( int b = 0; b < batch->count; b += LaneWidth )
+    {
+        v3x4 p = LoadV3x4( batch->x + b, batch->y + b, batch->z + b );
+        f32x4 result = F32x4( F32MAX );
+
+        i32 cells[LaneWidth];
+        int cellCount = GatherLaneCells( batch, b, cells );
+
+        for( int c = 0; c < cellCount; ++c )
+        {
+            for( int n = grid.roomStarts[cells[c]]; n < grid.roomStarts[cells[c] + 1]; ++n )
+            {
+                Room const& room = clusterData->rooms[grid.roomIndices[n]];
+                maskx4 inside = ContainsOrTouches( room.bounds, p );
+                if( AnyTrue( inside ) )
+                    result = Select( inside, SDFUnion( result, SDFRoom( p, room ) ), result );
+            }
+            for( int n = grid.hallStarts[cells[c]]; n < grid.hallStarts[cells[c] + 1]; ++n )
+            {
+                Hall const& hall = clusterData->halls[grid.hallIndices[n]];
+                maskx4 inside = ContainsOrTouches( hall.bounds, p );
+                if( AnyTrue( inside ) )
+                    result = Select( inside, SDFUnion( result, SDFHall( p, hall ) ), result );
+            }
+        }
+
+        StoreF32x4( batch->results + b, result );
+    }
+}
+
 internal void
 RoomBoundsToMinMaxP( Room const& room, v3i* minP, v3i* maxP )
 {
@@ -371,7 +586,7 @@ RoomBoundsToMinMaxP( Room const& room, v3i* minP, v3i* maxP )
 }
 
 internal void
-CreateHall( BinaryVolume* v, Room const& roomA, Room const& roomB, Cluster* cluster )
+CreateHall( BinaryVolume* v, Room const& roomA, Room const& roomB, Cluster* cluster, RandomStream* random )
 {
     v3i minP, maxP;
 
@@ -379,16 +594,16 @@ CreateHall( BinaryVolume* v, Room const& roomA, Room const& roomB, Cluster* clus
     RoomBoundsToMinMaxP( roomA, &minP, &maxP );
     v3i startP =
     {
-        RandomRangeI32( minP.x, maxP.x ),
-        RandomRangeI32( minP.y, maxP.y ),
-        RandomRangeI32( minP.z, maxP.z ),
+        RandomRangeI32( random, minP.x, maxP.x ),
+        RandomRangeI32( random, minP.y, maxP.y ),
+        RandomRangeI32( random, minP.z, maxP.z ),
     };
     RoomBoundsToMinMaxP( roomB, &minP, &maxP );
     v3i endP =
     {
-        RandomRangeI32( minP.x, maxP.x ),
-        RandomRangeI32( minP.y, maxP.y ),
-        RandomRangeI32( minP.z, maxP.z ),
+        RandomRangeI32( random, minP.x, maxP.x ),
+        RandomRangeI32( random, minP.y, maxP.y ),
+        RandomRangeI32( random, minP.z, maxP.z ),
     };
 
     v->hall.startP = V3( startP ) + V3One * VoxelSizeMeters * 0.5f;
@@ -407,7 +622,7 @@ CreateHall( BinaryVolume* v, Room const& roomA, Room const& roomB, Cluster* clus
     aabb hallBounds = {};
     while( remainingAxes )
     {
-        int index = RandomRangeI32( 0, 2 );
+        int index = RandomRangeI32( random, 0, 2 );
 
         if( nextAxis[index] == -1 )
             continue;
@@ -490,7 +705,7 @@ CreateHall( BinaryVolume* v, Room const& roomA, Room const& roomB, Cluster* clus
 
 internal Room*
 CreateRooms( BinaryVolume* v, SectorParams const& genParams, Cluster* cluster, v3i const& clusterP,
-             IsoSurfaceSamplingCache* samplingCache, MeshPool* meshPool, World* world, MemoryArena* arena, MemoryArena* tmpArena,
+             World* world, MemoryArena* arena, MemoryArena* tmpArena, RandomStream* random,
              i32* totalRoomsCount, i32* totalHallsCount )
 {
     // Non-leaf, recurse
@@ -500,21 +715,21 @@ CreateRooms( BinaryVolume* v, SectorParams const& genParams, Cluster* cluster, v
         Room* rightRoom = nullptr;
 
         if( v->leftChild )
-            leftRoom = CreateRooms( v->leftChild, genParams, cluster, clusterP, samplingCache, meshPool, world, arena, tmpArena,
+            leftRoom = CreateRooms( v->leftChild, genParams, cluster, clusterP, world, arena, tmpArena, random,
                                     totalRoomsCount, totalHallsCount );
         if( v->rightChild )
-            rightRoom = CreateRooms( v->rightChild, genParams, cluster, clusterP, samplingCache, meshPool, world, arena, tmpArena,
+            rightRoom = CreateRooms( v->rightChild, genParams, cluster, clusterP, world, arena, tmpArena, random,
                                      totalRoomsCount, totalHallsCount ); 
 
         if( leftRoom && rightRoom )
         {
             ASSERT( !(v->flags & VolumeFlags::HasRoom) );
-            CreateHall( v, *leftRoom, *rightRoom, cluster );
+            CreateHall( v, *leftRoom, *rightRoom, cluster, random );
             v->flags |= VolumeFlags::HasHall;
             *totalHallsCount += 1;
         }
 
-        return RandomNormalizedF32() < 0.5f ? leftRoom : rightRoom;
+        return RandomNormalizedF32( random ) < 0.5f ? leftRoom : rightRoom;
     }
     // Leaf, create a room
     else
@@ -524,16 +739,16 @@ CreateRooms( BinaryVolume* v, SectorParams const& genParams, Cluster* cluster, v
 
         v3i roomSizeVoxels =
         {
-            RandomRangeI32( (i32)(vSize.x * genParams.minRoomSizeRatio), (i32)(vSize.x * genParams.maxRoomSizeRatio) ),
-            RandomRangeI32( (i32)(vSize.y * genParams.minRoomSizeRatio), (i32)(vSize.y * genParams.maxRoomSizeRatio) ),
-            RandomRangeI32( (i32)(vSize.z * genParams.minRoomSizeRatio), (i32)(vSize.z * genParams.maxRoomSizeRatio) ),
+            RandomRangeI32( random, (i32)(vSize.x * genParams.minRoomSizeRatio), (i32)(vSize.x * genParams.maxRoomSizeRatio) ),
+            RandomRangeI32( random, (i32)(vSize.y * genParams.minRoomSizeRatio), (i32)(vSize.y * genParams.maxRoomSizeRatio) ),
+            RandomRangeI32( random, (i32)(vSize.z * genParams.minRoomSizeRatio), (i32)(vSize.z * genParams.maxRoomSizeRatio) ),
         };
 
         v3i roomOffset =
         {
-            RandomRangeI32( genParams.volumeSafeMarginSize, vSize.x - roomSizeVoxels.x - genParams.volumeSafeMarginSize ),
-            RandomRangeI32( genParams.volumeSafeMarginSize, vSize.y - roomSizeVoxels.y - genParams.volumeSafeMarginSize ),
-            RandomRangeI32( genParams.volumeSafeMarginSize, vSize.z - roomSizeVoxels.z - genParams.volumeSafeMarginSize ),
+            RandomRangeI32( random, genParams.volumeSafeMarginSize, vSize.x - roomSizeVoxels.x - genParams.volumeSafeMarginSize ),
+            RandomRangeI32( random, genParams.volumeSafeMarginSize, vSize.y - roomSizeVoxels.y - genParams.volumeSafeMarginSize ),
+            RandomRangeI32( random, genParams.volumeSafeMarginSize, vSize.z - roomSizeVoxels.z - genParams.volumeSafeMarginSize ),
         };
 
         v3i roomIntMinP = v->voxelP + roomOffset;
@@ -549,15 +764,9 @@ CreateRooms( BinaryVolume* v, SectorParams const& genParams, Cluster* cluster, v
         // Inclusive
         v3i roomIntMaxP = roomIntMinP + roomSizeVoxels - V3iOne;
 
-        for( int k = roomIntMinP.z; k <= roomIntMaxP.z; ++k )
-            for( int j = roomIntMinP.y; j <= roomIntMaxP.y; ++j )
-                for( int i = roomIntMinP.x; i <= roomIntMaxP.x; ++i )
-                {
-                    bool atBorder = (i == roomIntMinP.x || i == roomIntMaxP.x)
-                        || (j == roomIntMinP.y || j == roomIntMaxP.y)
-                        || (k == roomIntMinP.z || k == roomIntMaxP.z);
-                    cluster->voxelGrid( i, j, k ) = atBorder ? 2 : 1;
-                }
+        // Whole bricks inside the room stay uniform, only the ones along the walls get their own cells
+        cluster->voxelGrid.Fill( roomIntMinP, roomIntMaxP, 2 );
+        cluster->voxelGrid.Fill( roomIntMinP + V3iOne, roomIntMaxP - V3iOne, 1 );
 #endif
 
         v->flags |= VolumeFlags::HasRoom;
@@ -582,9 +791,47 @@ StoreInCluster( BinaryVolume const& volume, Cluster* cluster )
 }
 
 
+// Store the contoured volume in as many meshes as MeshesPerVolume says
+internal void
+StoreVolumeMeshes( BucketArray<TexturedVertex> const& vertices, BucketArray<i32> const& indices, aabb const& bounds,
+                   v3 const& sampledVolumeSize, v3i const& clusterP, World* world, MeshPool* meshPool, MemoryArena* tmpArena,
+                   Mesh** outMeshes )
+{
+    if( SplitVolumeMeshes )
+    {
+        outMeshes[0] = FastDecimate( vertices, indices, bounds.center, sampledVolumeSize, VoxelSizeMeters * 2.f, VertexTag::Inner,
+                                     meshPool, tmpArena );
+        outMeshes[1] = FastDecimate( vertices, indices, bounds.center, sampledVolumeSize, VoxelSizeMeters * 2.f, VertexTag::Outer,
+                                     meshPool, tmpArena );
+    }
+    else if( indices.count )
+    {
+        // NOTE Already logged if the heap is full. The volume is just left without a mesh
+        Mesh* mesh = AllocateMesh( meshPool, vertices.count, indices.count );
+        if( mesh )
+        {
+            vertices.CopyTo( &mesh->vertices );
+            indices.CopyTo( &mesh->indices );
+        }
+        outMeshes[0] = mesh;
+    }
+
+    // Set initial offset index based on cluster
+    // FIXME This must be done again everytime we switch the origin cluster
+    v3i clusterRelativeP = clusterP - world->originClusterP;
+    for( int m = 0; m < MeshesPerVolume; ++m )
+    {
+        if( outMeshes[m] )
+        {
+            outMeshes[m]->bounds = bounds;
+            outMeshes[m]->simClusterIndex = CalcSimClusterIndex( clusterRelativeP );
+        }
+    }
+}
+
 internal void
-CreateRoomMesh( i32 roomIndex, Cluster* cluster, v3i const& clusterP, World* world, MemoryArena* arena, MemoryArena* tmpArena,
-                Array<Mesh>* meshStore )
+CreateRoomMesh( i32 roomIndex, Cluster* cluster, v3i const& clusterP, World* world, MeshPool* meshPool, MemoryArena* tmpArena,
+                BucketArray<DebugVolume>* debugVolumes, Mesh** outMeshes )
 {
     TIMED_FUNC_WITH_TOTALS;
 
@@ -592,14 +839,14 @@ CreateRoomMesh( i32 roomIndex, Cluster* cluster, v3i const& clusterP, World* wor
 
     WorldCoords worldP = { room.bounds.center, clusterP };
     v3 sampledVolumeSize = room.bounds.halfSize * 2.0f;
-    ClusterSamplingData roomSamplingData = InitClusterSamplingData( cluster->rooms, cluster->halls, roomIndex );
+    ClusterSamplingData roomSamplingData = InitClusterSamplingData( cluster->rooms, cluster->halls, cluster->volumeGrid, roomIndex );
     if( roomIndex == 0 )
-        roomSamplingData.debugCluster = cluster;
+        roomSamplingData.debugVolumes = debugVolumes;
 
     // TODO Super sample the volume shell?
     // TODO Skip interior!
 
-    DCSettings settings;
+    DCSettings settings = {};
     settings.cellPointsComputationMethod = DCComputeMethod::QEFProbabilistic;
     settings.sigmaN = 0.02f;
     // FIXME Keep this as separate in the tests UI but get rid of it for generation
@@ -607,54 +854,32 @@ CreateRoomMesh( i32 roomIndex, Cluster* cluster, v3i const& clusterP, World* wor
     BucketArray<TexturedVertex> tmpVertices( tmpArena, 1024, Temporary() );
     BucketArray<i32> tmpIndices( tmpArena, 1024, Temporary() );
 
-    DCVolume( worldP, sampledVolumeSize, VoxelSizeMeters, RoomSurfaceFunc, (SamplingData*)&roomSamplingData,
-              &tmpVertices, &tmpIndices, arena, tmpArena, settings );
-
-    Mesh result = {};
-    InitMesh( &result );
-    result.bounds = room.bounds;
-    // Set initial offset index based on cluster
-    // FIXME This must be done again everytime we switch the origin cluster
-    v3i clusterRelativeP = clusterP - world->originClusterP;
-    result.simClusterIndex = CalcSimClusterIndex( clusterRelativeP );
-
-#if 1
-    result = CreateMeshFromBuffers( tmpVertices, tmpIndices, arena );
-    meshStore->Push( result );
-#else
-    Mesh innerMesh = result;
-    FastDecimate( tmpVertices, tmpIndices, room.bounds.center, sampledVolumeSize, VoxelSizeMeters * 2.f, VertexTag::Inner,
-                  arena, tmpArena, &innerMesh.vertices, &innerMesh.indices );
-    meshStore->Push( innerMesh );
-
-    Mesh outerMesh = result;
-    FastDecimate( tmpVertices, tmpIndices, room.bounds.center, sampledVolumeSize, VoxelSizeMeters * 2.f, VertexTag::Outer,
-                  arena, tmpArena, &outerMesh.vertices, &outerMesh.indices );
-    meshStore->Push( outerMesh );
-#endif
+    DCVolume( worldP, sampledVolumeSize, VoxelSizeMeters, RoomSurfaceFunc, RoomSurfaceBatchFunc, nullptr, nullptr, (SamplingData*)&roomSamplingData,
+              &tmpVertices, &tmpIndices, nullptr, tmpArena, settings );
 
+    StoreVolumeMeshes( tmpVertices, tmpIndices, room.bounds, sampledVolumeSize, clusterP, world, meshPool, tmpArena, outMeshes );
 
-#if 1
-    cluster->debugVolumes.Push( { AABBCenterSize( room.bounds.center, sampledVolumeSize ), { 1, 0, 0, 0.5f }, } );
-#endif
+    debugVolumes->Push( { AABBCenterSize( room.bounds.center, sampledVolumeSize ), { 1, 0, 0, 0.5f }, } );
 }
 
 internal void
-CreateHallMesh( i32 hallIndex, Cluster* cluster, v3i const& clusterP, World* world, MemoryArena* arena, MemoryArena* tmpArena,
-                Array<Mesh>* meshStore )
+CreateHallMesh( i32 hallIndex, Cluster* cluster, v3i const& clusterP, World* world, MeshPool* meshPool, MemoryArena* tmpArena,
+                Mesh** outMeshes )
 {
     TIMED_FUNC_WITH_TOTALS;
 
     Hall const& hall = cluster->halls[hallIndex];
 
     WorldCoords worldP = { hall.bounds.center, clusterP };
-    ClusterSamplingData roomSamplingData = InitClusterSamplingData( cluster->rooms, cluster->halls, hallIndex );
-    roomSamplingData.header.zeroThickness = false;
-    if( hallIndex % 2 == 0 )
-        roomSamplingData.debugCluster = cluster;
     v3 sampledVolumeSize = hall.bounds.halfSize * 2.f;
 
-    DCSettings settings;
+    // Only keep what can affect the sampled volume (DC samples a couple cells past it, plus some normals)
+    aabb sampledRegion = AABBCenterSize( hall.bounds.center, sampledVolumeSize + V3( VoxelSizeMeters * 8.f ) );
+    SDFProgram program = CompileSDFProgram( cluster->surfaceSDF, sampledRegion, tmpArena, Temporary() );
+    SDFProgramSamplingData samplingData = InitSDFProgramSamplingData( &program );
+    samplingData.header.zeroThickness = false;
+
+    DCSettings settings = {};
     settings.cellPointsComputationMethod = DCComputeMethod::QEFProbabilistic;
     settings.clampCellPoints = true;
     settings.sigmaN = 0.02f;
@@ -663,34 +888,15 @@ CreateHallMesh( i32 hallIndex, Cluster* cluster, v3i const& clusterP, World* wor
     BucketArray<TexturedVertex> tmpVertices( tmpArena, 1024, Temporary() );
     BucketArray<i32> tmpIndices( tmpArena, 1024, Temporary() );
 
-    DCVolume( worldP, sampledVolumeSize, VoxelSizeMeters, HallSurfaceFunc, (SamplingData*)&roomSamplingData,
-              &tmpVertices, &tmpIndices, arena, tmpArena, settings );
-    // TODO 
+    DCVolume( worldP, sampledVolumeSize, VoxelSizeMeters, SDFProgramSurfaceFunc, SDFProgramSurfaceBatchFunc,
+              SDFProgramSurfaceGradientFunc, SDFProgramSurfaceRangeFunc, (SamplingData*)&samplingData,
+              &tmpVertices, &tmpIndices, nullptr, tmpArena, settings );
 
-    Mesh result = {};
-    InitMesh( &result );
-    result.bounds = hall.bounds;
-    // Set initial offset index based on cluster
-    // FIXME This must be done again everytime we switch the origin cluster
-    v3i clusterRelativeP = clusterP - world->originClusterP;
-    result.simClusterIndex = CalcSimClusterIndex( clusterRelativeP );
-
-#if 1
-    result = CreateMeshFromBuffers( tmpVertices, tmpIndices, arena );
-    meshStore->Push( result );
-#else
-    Mesh innerMesh = result;
-    FastDecimate( tmpVertices, tmpIndices, hall.bounds.center, sampledVolumeSize, VoxelSizeMeters * 2.f, VertexTag::Inner,
-                  arena, tmpArena, &innerMesh.vertices, &innerMesh.indices );
-    meshStore->Push( innerMesh );
-
-    Mesh outerMesh = result;
-    FastDecimate( tmpVertices, tmpIndices, hall.bounds.center, sampledVolumeSize, VoxelSizeMeters * 2.f, VertexTag::Outer,
-                  arena, tmpArena, &outerMesh.vertices, &outerMesh.indices );
-    meshStore->Push( outerMesh );
-#endif
+    StoreVolumeMeshes( tmpVertices, tmpIndices, hall.bounds, sampledVolumeSize, clusterP, world, meshPool, tmpArena, outMeshes );
 }
 
+// NOTE Not called from anywhere at the moment (see MeshClusterJob), so the slab-parallel path in DCVolume only runs live
+// in the editor contouring tests. Room & hall meshes are already contoured in parallel with each other, from their worker arenas.
 internal Mesh
 CreateClusterMesh( Cluster* cluster, v3i const& clusterP, World* world, MemoryArena* arena, MemoryArena* tmpArena )
 {
@@ -698,10 +904,10 @@ CreateClusterMesh( Cluster* cluster, v3i const& clusterP, World* world, MemoryAr
 
     Mesh result = {};
     WorldCoords worldP = { V3Zero, clusterP };
-    ClusterSamplingData roomSamplingData = InitClusterSamplingData( cluster->rooms, cluster->halls, 0 );
+    ClusterSamplingData roomSamplingData = InitClusterSamplingData( cluster->rooms, cluster->halls, cluster->volumeGrid, 0 );
     roomSamplingData.header.zeroThickness = false;
 
-    DCSettings settings;
+    DCSettings settings = {};
     settings.cellPointsComputationMethod = DCComputeMethod::QEFProbabilistic;
     settings.sigmaN = 0.02f;
     // FIXME Keep this as separate in the tests UI but get rid of it for generation
@@ -709,8 +915,8 @@ CreateClusterMesh( Cluster* cluster, v3i const& clusterP, World* world, MemoryAr
     BucketArray<TexturedVertex> tmpVertices( tmpArena, 1024, Temporary() );
     BucketArray<i32> tmpIndices( tmpArena, 1024, Temporary() );
 
-    DCVolume( worldP, V3( ClusterSizeMeters ), VoxelSizeMeters, ClusterSurfaceFunc, (SamplingData*)&roomSamplingData,
-              &tmpVertices, &tmpIndices, arena, tmpArena, settings );
+    DCVolume( worldP, V3( ClusterSizeMeters ), VoxelSizeMeters, ClusterSurfaceFunc, ClusterSurfaceBatchFunc, nullptr, nullptr, (SamplingData*)&roomSamplingData,
+              &tmpVertices, &tmpIndices, arena, tmpArena, settings, globalPlatform.hiPriorityQueue );
     result = CreateMeshFromBuffers( tmpVertices, tmpIndices, arena );
 
     // Set initial offset index based on cluster
@@ -739,11 +945,107 @@ IsInSimRegion( const v3i& clusterP, const v3i& worldOriginClusterP )
         && clusterOffset.z >= -SimExteriorHalfSize && clusterOffset.z <= SimExteriorHalfSize ;
 }
 
+// Same surface as HallSurfaceFunc
+internal SDFNode*
+BuildClusterSurfaceSDF( Array<Room> const& rooms, Array<Hall> const& halls, MemoryArena* arena )
+{
+    const v3 volumeBorder = V3( VoxelSizeMeters * 1.01f );
+
+    SDFNode* result = PushSDFConstant( arena, F32MAX );
+    for( int i = 0; i < halls.count; ++i )
+    {
+        Hall const& hall = halls[i];
+
+        SDFNode* hallSDF = nullptr;
+        for( int s = 0; s < ARRAYCOUNT(hall.sectionBounds); ++s )
+        {
+            aabb const& section = hall.sectionBounds[s];
+            SDFNode* sectionSDF = PushSDFTranslate( arena, PushSDFBox( arena, section.halfSize - volumeBorder ), section.center );
+            hallSDF = hallSDF ? PushSDFUnion( arena, hallSDF, sectionSDF ) : sectionSDF;
+        }
+        result = PushSDFBoundedUnion( arena, result, hallSDF, hall.bounds );
+    }
+
+    // Carve the inside and give it a thickness
+    result = PushSDFOnion( arena, result, VoxelSizeMeters * 0.5f, true );
+
+    for( int i = 0; i < rooms.count; ++i )
+    {
+        Room const& room = rooms[i];
+
+        SDFNode* roomSDF = PushSDFTranslate( arena, PushSDFBox( arena, room.bounds.halfSize - volumeBorder ), room.bounds.center );
+        result = PushSDFBoundedSubstraction( arena, result, roomSDF, room.bounds );
+    }
+
+    return result;
+}
+
+// Lists each volume in all the grid cells its bounds touch
+template <typename VolumeType>
+internal void
+BuildVolumeGridLists( Array<VolumeType> const& volumes, Array<i32>* starts, Array<i32>* indices, MemoryArena* arena )
+{
+    const i32 cellCount = VolumeGridCellsPerAxis * VolumeGridCellsPerAxis * VolumeGridCellsPerAxis;
+    // Grow the bounds a bit, so points that touch them only after rounding still find them
+    const v3 margin = V3( VoxelSizeMeters * 0.01f );
+
+    INIT( starts ) Array<i32>( arena, cellCount + 1, Tagged( MemoryTag::Clusters() ) );
+    starts->ResizeToCapacity();
+
+    // Count volumes in each cell, then turn the counts into the end of each list
+    i32 totalCount = 0;
+    for( int i = 0; i < volumes.count; ++i )
+    {
+        aabb const& bounds = volumes[i].bounds;
+        v3i minCell = VolumeGridCell( bounds.center - bounds.halfSize - margin );
+        v3i maxCell = VolumeGridCell( bounds.center + bounds.halfSize + margin );
+
+        for( int z = minCell.z; z <= maxCell.z; ++z )
+            for( int y = minCell.y; y <= maxCell.y; ++y )
+                for( int x = minCell.x; x <= maxCell.x; ++x )
+                {
+                    (*starts)[VolumeGridCellIndex( V3i( x, y, z ) )]++;
+                    totalCount++;
+                }
+    }
+
+    i32 sum = 0;
+    for( int c = 0; c < cellCount; ++c )
+    {
+        sum += (*starts)[c];
+        (*starts)[c] = sum;
+    }
+    (*starts)[cellCount] = sum;
+
+    // Fill each list back to front, which leaves every entry pointing at the start of its list
+    INIT( indices ) Array<i32>( arena, totalCount, Tagged( MemoryTag::Clusters() ) );
+    indices->ResizeToCapacity();
+
+    for( int i = volumes.count - 1; i >= 0; --i )
+    {
+        aabb const& bounds = volumes[i].bounds;
+        v3i minCell = VolumeGridCell( bounds.center - bounds.halfSize - margin );
+        v3i maxCell = VolumeGridCell( bounds.center + bounds.halfSize + margin );
+
+        for( int z = minCell.z; z <= maxCell.z; ++z )
+            for( int y = minCell.y; y <= maxCell.y; ++y )
+                for( int x = minCell.x; x <= maxCell.x; ++x )
+                {
+                    i32 cellIndex = VolumeGridCellIndex( V3i( x, y, z ) );
+                    (*indices)[--(*starts)[cellIndex]] = i;
+                }
+    }
+    ASSERT( (*starts)[0] == 0 );
+}
+
 internal void
 CreateEntitiesInCluster( Cluster* cluster, const v3i& clusterP, World* world, MemoryArena* arena, MemoryArena* tmpArena )
 {
     TIMED_FUNC;
 
+    // Only ever draw from this, so the result only depends on the seed, whatever other threads are doing meanwhile
+    RandomStream random = RandomStreamFromSeed( cluster->seed );
+
     // Partition cluster space
     SectorParams genParams = CollectSectorParams( clusterP );
     const int minVolumeSize = (int)(genParams.minVolumeRatio * (f32)VoxelsPerClusterAxis);
@@ -774,31 +1076,37 @@ CreateEntitiesInCluster( Cluster* cluster, const v3i& clusterP, World* world, Me
                 if( v.sizeVoxels.x > maxVolumeSize ||
                     v.sizeVoxels.y > maxVolumeSize ||
                     v.sizeVoxels.z > maxVolumeSize ||
-                    RandomNormalizedF32() > genParams.volumeExtraPartitioningProbability )
+                    RandomNormalizedF32( &random ) > genParams.volumeExtraPartitioningProbability )
                 {
-                    if( SplitVolume( &v, &volumes, minVolumeSize, &totalVolumesCount ) )
+                    if( SplitVolume( &v, &volumes, minVolumeSize, &random, &totalVolumesCount ) )
                         didSplit = true;
                 }
             }
         }
     }
 
-    // TODO This is huge, and not currently used for anything really. Maybe we just dont need it?
-    cluster->voxelGrid = ClusterVoxelGrid( arena, V3i( VoxelsPerClusterAxis ) );
+    // TODO Not currently used for anything really. Maybe we just dont need it?
+    cluster->voxelGrid = ClusterVoxelGrid( arena, V3i( VoxelsPerClusterAxis ), 0, Tagged( MemoryTag::ClusterVoxels() ) );
 
     // Create a room in each leaf volume and connect with halls
     // TODO Add a certain chance for empty volumes
     i32 totalRoomsCount = 0, totalHallsCount = 0;
-    CreateRooms( rootVolume, genParams, cluster, clusterP, world->samplingCache, &world->meshPools[0], world, arena, tmpArena,
+    CreateRooms( rootVolume, genParams, cluster, clusterP, world, arena, tmpArena, &random,
                  &totalRoomsCount, &totalHallsCount);
 
     // Copy result to permanent storage
-    INIT( &cluster->rooms ) Array<Room>( arena, totalRoomsCount );
-    INIT( &cluster->halls ) Array<Hall>( arena, totalHallsCount );
+    INIT( &cluster->rooms ) Array<Room>( arena, totalRoomsCount, Tagged( MemoryTag::Clusters() ) );
+    INIT( &cluster->halls ) Array<Hall>( arena, totalHallsCount, Tagged( MemoryTag::Clusters() ) );
     StoreInCluster( *rootVolume, cluster );
 
     ASSERT( cluster->rooms.count == totalRoomsCount );
     ASSERT( cluster->halls.count == totalHallsCount );
+
+    ClusterVolumeGrid* volumeGrid = &cluster->volumeGrid;
+    BuildVolumeGridLists( cluster->rooms, &volumeGrid->roomStarts, &volumeGrid->roomIndices, arena );
+    BuildVolumeGridLists( cluster->halls, &volumeGrid->hallStarts, &volumeGrid->hallIndices, arena );
+
+    cluster->surfaceSDF = BuildClusterSurfaceSDF( cluster->rooms, cluster->halls, arena );
 }
 
 inline MeshGeneratorJob*
@@ -837,10 +1145,9 @@ PLATFORM_JOBQUEUE_CALLBACK(GenerateOneEntity)
     // TODO Use CAS whenever worldOriginClusterP changes
     if( IsInSimRegion( clusterP, *job->worldOriginClusterP ) )
     {
-        // TODO Find a much more explicit and general way to associate thread-job data like this
-        // (also, make sure thread pool memory is aligned to 64 bit to avoid false sharing!)
-        IsoSurfaceSamplingCache* samplingCache = &job->samplingCache[workerThreadIndex];
-        MeshPool* meshPool = &job->meshPools[workerThreadIndex];
+        MeshGeneratorWorkerData* workerData = &job->workerData[workerThreadIndex];
+        IsoSurfaceSamplingCache* samplingCache = &workerData->samplingCache;
+        MeshPool* meshPool = &workerData->meshPool;
 
         // TODO We probably don't want a mesh pool per thread but just the bucket arrays
         // Make live entity from stored and put it in the world
@@ -860,66 +1167,280 @@ PLATFORM_JOBQUEUE_CALLBACK(GenerateOneEntity)
     job->occupied = false;
 }
 
-internal void
-LoadEntitiesInCluster( const v3i& clusterP, World* world, MemoryArena* arena, MemoryArena* tmpArena )
+internal
+PLATFORM_JOBQUEUE_CALLBACK(PartitionClusterJob)
 {
-    TIMED_FUNC_WITH_TOTALS;
-
-    Cluster* cluster = world->clusterTable.Find( clusterP );
+    ClusterGenerationJob* job = (ClusterGenerationJob*)userData;
 
-    if( !cluster )
+    if( !job->cluster->populated )
     {
-        cluster = world->clusterTable.InsertEmpty( clusterP );
-        cluster->populated = false;
-        INIT( &cluster->entityStorage ) BucketArray<StoredEntity>( arena, 256 );
-        INIT( &cluster->debugVolumes ) BucketArray<DebugVolume>( arena, 64 );
+        MemoryArena* workerArena = globalPlatform.GetWorkerArena( workerThreadIndex );
+        CreateEntitiesInCluster( job->cluster, job->clusterP, job->world, job->arena, workerArena );
+        job->cluster->populated = true;
     }
+}
 
-    if( !cluster->populated )
-    {
-        CreateEntitiesInCluster( cluster, clusterP, world, arena, tmpArena );
-        cluster->populated = true;
-    }
+internal
+PLATFORM_JOBQUEUE_CALLBACK(MeshVolumeJob)
+{
+    ClusterMeshJob* meshJob = (ClusterMeshJob*)userData;
+    ClusterGenerationJob* job = meshJob->clusterJob;
+
+    // Everything temporary goes to this worker's own scratch memory, and the result to its own mesh pool
+    MeshPool* meshPool = &job->world->workerData[workerThreadIndex].meshPool;
+    MemoryArena* workerArena = globalPlatform.GetWorkerArena( workerThreadIndex );
+    BucketArray<DebugVolume> debugVolumes( workerArena, 64, Temporary() );
+
+    i32 jobIndex = (i32)(meshJob - job->meshJobs);
+    Mesh** outMeshes = &job->meshes[jobIndex * MeshesPerVolume];
+    if( meshJob->isRoom )
+        CreateRoomMesh( meshJob->volumeIndex, job->cluster, job->clusterP, job->world, meshPool, workerArena,
+                        &debugVolumes, outMeshes );
+    else
+        CreateHallMesh( meshJob->volumeIndex, job->cluster, job->clusterP, job->world, meshPool, workerArena, outMeshes );
 
+#if !RELEASE
+    if( debugVolumes.count )
+    {
+        BeginTicketMutex( &job->arenaMutex );
+        INIT( &meshJob->debugVolumes ) Array<DebugVolume>( job->arena, debugVolumes.count, Tagged( MemoryTag::Clusters() ) );
+        EndTicketMutex( &job->arenaMutex );
 
-    // TODO Do all this in jobs in LoadEntitiesInCluster
-#if 1
+        debugVolumes.CopyTo( &meshJob->debugVolumes );
+    }
+#endif
+}
 
-    int totalMeshCount = (cluster->rooms.count + cluster->halls.count) * 2;
-    INIT( &cluster->meshStore ) Array<Mesh>( arena, totalMeshCount );
+internal
+PLATFORM_JOBQUEUE_CALLBACK(MeshClusterJob)
+{
+    ClusterGenerationJob* job = (ClusterGenerationJob*)userData;
+    Cluster* cluster = job->cluster;
 
-    TemporaryMemory tmpMemory = BeginTemporaryMemory( tmpArena );
-#if 1
     // This is what we'd like to do, as most of the 3d space is empty and we would save a huge amount of pointless iteration
     // but it's tricky to make disjointly sampled volumes that behave well together
+    // (The alternative would be to just call CreateClusterMesh, but it's slooooow)
 
     // FIXME We still have some Z-fighting due to overlapping at the contact points
     // NOTE Mesh simplification seems to make it worse!?
-    //for( int i = 0; i < cluster->rooms.count; ++i )
-    //{
-        //TemporaryMemory tmpMeshMemory = BeginTemporaryMemory( tmpArena );
-        //CreateRoomMesh( i, cluster, clusterP, world, arena, tmpArena, &cluster->meshStore );
-        //EndTemporaryMemory( tmpMeshMemory );
-    //}
-    for( int i = 0; i < cluster->halls.count; ++i )
+    i32 hallCount = cluster->halls.count;
+    i32 roomCount = MeshClusterRooms ? cluster->rooms.count : 0;
+    i32 jobCount = hallCount + roomCount;
+    INIT( &job->meshes ) Array<Mesh*>( job->arena, jobCount * MeshesPerVolume, Tagged( MemoryTag::Clusters() ) );
+    job->meshes.ResizeToCapacity();
+
+    // NOTE Nobody else allocates from the cluster arena until these are all added
+    job->meshJobs = PUSH_ARRAY( job->arena, ClusterMeshJob, jobCount, Tagged( MemoryTag::Clusters() ) );
+    job->meshJobCount = jobCount;
+    for( int i = 0; i < hallCount; ++i )
+        job->meshJobs[i] = { job, i, false };
+    for( int i = 0; i < roomCount; ++i )
+        job->meshJobs[hallCount + i] = { job, i, true };
+
+    // Still part of the mesh group, so the finish job will wait for all of these too
+    globalPlatform.AddNewJobs( globalPlatform.hiPriorityQueue, &job->meshGroup, MeshVolumeJob,
+                               job->meshJobs, sizeof(ClusterMeshJob), jobCount );
+}
+
+internal
+PLATFORM_JOBQUEUE_CALLBACK(FinishClusterJob)
+{
+    ClusterGenerationJob* job = (ClusterGenerationJob*)userData;
+
+    // NOTE Meshes are only handed over to the cluster from the main thread, once it sees the whole graph is done
+    // TODO Upload to GPU buffers from here
+    sz meshBytes = 0;
+    i32 meshCount = 0;
+    for( int m = 0; m < job->meshes.count; ++m )
     {
-        TemporaryMemory tmpMeshMemory = BeginTemporaryMemory( tmpArena );
-        CreateHallMesh( i, cluster, clusterP, world, arena, tmpArena, &cluster->meshStore );
-        EndTemporaryMemory( tmpMeshMemory );
+        // Empty volumes (or empty parts of them, when split) get no mesh, and neither do those that didn't fit in the heap
+        Mesh* mesh = job->meshes[m];
+        if( !mesh )
+            continue;
+
+        meshBytes += sizeof(Mesh) + mesh->vertices.capacity * sizeof(TexturedVertex) + mesh->indices.capacity * sizeof(i32);
+        job->meshes[meshCount++] = mesh;
     }
+    job->meshes.count = meshCount;
+    job->meshBytes = meshBytes;
+}
 
-#else
-    // This is what we may have to end up doing if creating a well behaved disjoint SDF ends up being too tricky, but it's slooooow
+internal void
+UnlinkClusterFromCache( ClusterCache* cache, Cluster* cluster )
+{
+    if( cluster->prevUsed )
+        cluster->prevUsed->nextUsed = cluster->nextUsed;
+    else
+        cache->mostRecentlyUsed = cluster->nextUsed;
 
-    Mesh mesh = CreateClusterMesh( cluster, clusterP, world, arena, tmpArena );
-    cluster->meshStore.Push( mesh );
+    if( cluster->nextUsed )
+        cluster->nextUsed->prevUsed = cluster->prevUsed;
+    else
+        cache->leastRecentlyUsed = cluster->prevUsed;
+
+    cluster->prevUsed = cluster->nextUsed = nullptr;
+}
+
+internal void
+MarkClusterUsed( ClusterCache* cache, Cluster* cluster )
+{
+    if( cache->mostRecentlyUsed == cluster )
+        return;
+
+    if( cluster->prevUsed || cluster->nextUsed || cache->leastRecentlyUsed == cluster )
+        UnlinkClusterFromCache( cache, cluster );
+
+    cluster->nextUsed = cache->mostRecentlyUsed;
+    if( cache->mostRecentlyUsed )
+        cache->mostRecentlyUsed->prevUsed = cluster;
+    else
+        cache->leastRecentlyUsed = cluster;
+    cache->mostRecentlyUsed = cluster;
+}
+
+internal void
+EvictCluster( Cluster* cluster, World* world )
+{
+    ClusterCache* cache = &world->clusterCache;
+    ASSERT( cluster->arena.base );
+    ASSERT( !cluster->generationJob );
+
+    // NOTE The main thread is always worker 0
+    for( int m = 0; m < cluster->meshStore.count; ++m )
+        ReleaseMesh( &cluster->meshStore[m], &world->workerData[0].meshPool );
+
+    ClearArena( &cluster->arena, false );
+    ReleaseToPool( &cache->memoryPool, cluster->arena.base );
+    cluster->arena = {};
+
+    cluster->voxelGrid = {};
+    cluster->rooms = {};
+    cluster->halls = {};
+    cluster->volumeGrid = {};
+    cluster->surfaceSDF = nullptr;
+    cluster->meshStore = {};
+    cluster->populated = false;
+
+    UnlinkClusterFromCache( cache, cluster );
+    cache->residentBytes -= cluster->residentBytes;
+    cache->residentCount--;
+    cache->evictionCount++;
+    cluster->residentBytes = 0;
+}
+
+// Evict the least recently used cluster that's not in the sim region (or still being generated)
+internal bool
+EvictLeastRecentlyUsedCluster( World* world )
+{
+    Cluster* cluster = world->clusterCache.leastRecentlyUsed;
+    while( cluster && (cluster->generationJob || IsInSimRegion( cluster->clusterP, world->originClusterP )) )
+        cluster = cluster->prevUsed;
+
+    if( cluster )
+        EvictCluster( cluster, world );
+    return cluster != nullptr;
+}
+
+internal bool
+MakeClusterResident( Cluster* cluster, World* world )
+{
+    ClusterCache* cache = &world->clusterCache;
+
+    void* memory = AllocateFromPool( &cache->memoryPool, ClusterArenaSize );
+    while( !memory && EvictLeastRecentlyUsedCluster( world ) )
+        memory = AllocateFromPool( &cache->memoryPool, ClusterArenaSize );
+
+    if( !memory )
+        return false;
+
+    InitArena( &cluster->arena, (u8*)memory, ClusterArenaSize );
+    SetArenaTag( &cluster->arena, MemoryTag::Clusters() );
+#if !RELEASE
+    INIT( &cluster->debugVolumes ) BucketArray<DebugVolume>( &cluster->arena, 64 );
 #endif
 
-    EndTemporaryMemory( tmpMemory );
+    MarkClusterUsed( cache, cluster );
+    cache->residentCount++;
+    return true;
+}
 
-    //*DEBUGglobalQuit = true;
+// Hand over the results of all finished generation jobs to their clusters, then evict whatever is over budget
+internal void
+UpdateClusterCache( World* world )
+{
+    ClusterCache* cache = &world->clusterCache;
 
-#else
+    for( Cluster* cluster = cache->mostRecentlyUsed; cluster; cluster = cluster->nextUsed )
+    {
+        ClusterGenerationJob* job = cluster->generationJob;
+        if( !job || !IsDone( &job->doneGroup ) )
+            continue;
+
+        cluster->meshStore = job->meshes;
+        cluster->generationJob = nullptr;
+
+#if !RELEASE
+        for( int j = 0; j < job->meshJobCount; ++j )
+        {
+            Array<DebugVolume> const& debugVolumes = job->meshJobs[j].debugVolumes;
+            for( int i = 0; i < debugVolumes.count; ++i )
+                cluster->debugVolumes.Push( debugVolumes[i] );
+        }
+#endif
+
+        cluster->residentBytes = cluster->arena.used + job->meshBytes;
+        cache->residentBytes += cluster->residentBytes;
+    }
+
+    while( cache->residentBytes > cache->budgetBytes && EvictLeastRecentlyUsedCluster( world ) )
+        ;
+}
+
+internal void
+LoadEntitiesInCluster( const v3i& clusterP, World* world, MemoryArena* arena, MemoryArena* tmpArena )
+{
+    TIMED_FUNC_WITH_TOTALS;
+
+    ClusterCache* cache = &world->clusterCache;
+    Cluster* cluster = world->clusterTable.Find( clusterP );
+
+    if( !cluster )
+    {
+        cluster = world->clusterTable.InsertEmpty( clusterP );
+        cluster->populated = false;
+        cluster->clusterP = clusterP;
+        cluster->seed = ClusterHash( clusterP, 0 );
+        INIT( &cluster->entityStorage ) BucketArray<StoredEntity>( arena, 256, Tagged( MemoryTag::Clusters() ) );
+    }
+
+    if( cluster->arena.base )
+    {
+        // Still resident from a previous visit, so there's nothing to generate
+        MarkClusterUsed( cache, cluster );
+        cache->hitCount++;
+        return;
+    }
+
+    cache->missCount++;
+    if( !MakeClusterResident( cluster, world ) )
+    {
+        LOG( "ERROR :: Out of memory for cluster %d, %d, %d", clusterP.x, clusterP.y, clusterP.z );
+        INVALID_CODE_PATH
+        return;
+    }
+
+    // Build the job graph backwards, so each stage is already registered when the previous one completes
+    // NOTE We don't wait for it. UpdateClusterCache picks up the results once it's done
+    ClusterGenerationJob* job = PUSH_STRUCT( &cluster->arena, ClusterGenerationJob, Tagged( MemoryTag::Clusters() ) );
+    *job = { cluster, clusterP, world, &cluster->arena };
+    cluster->generationJob = job;
+    PlatformJobQueue* queue = globalPlatform.hiPriorityQueue;
+
+    globalPlatform.AddContinuation( &job->meshGroup, queue, &job->doneGroup, FinishClusterJob, job );
+    globalPlatform.AddContinuation( &job->partitionGroup, queue, &job->meshGroup, MeshClusterJob, job );
+    globalPlatform.AddGroupJob( queue, &job->partitionGroup, PartitionClusterJob, job );
+
+#if 0
     {
         TIMED_BLOCK;
 
@@ -942,8 +1463,7 @@ LoadEntitiesInCluster( const v3i& clusterP, World* world, MemoryArena* arena, Me
                 {
                     &storedEntity,
                     &world->originClusterP,
-                    world->samplingCache,
-                    world->meshPools,
+                    world->workerData,
                     outputEntity,
                 };
                 job->occupied = true;
@@ -1005,7 +1525,8 @@ StoreEntitiesInCluster( const v3i& clusterP, World* world, MemoryArena* arena )
 
                 cluster->entityStorage.Push( storedEntity );
 
-                ReleaseMesh( &liveEntity.mesh );
+                // NOTE The main thread is always worker 0
+                ReleaseMesh( &liveEntity.mesh, &world->workerData[0].meshPool );
                 world->liveEntities.Remove( it );
             }
         }
@@ -1014,7 +1535,7 @@ StoreEntitiesInCluster( const v3i& clusterP, World* world, MemoryArena* arena )
     }
 }
 
-// @Leak
+// @Leak Stored entities are not reclaimed
 internal void
 RestartWorldGeneration( World* world )
 {
@@ -1022,6 +1543,18 @@ RestartWorldGeneration( World* world )
     //RandomSeed();
 
     world->liveEntities.Clear();
+
+    ClusterCache* cache = &world->clusterCache;
+    for( Cluster* cluster = cache->mostRecentlyUsed; cluster; cluster = cluster->nextUsed )
+    {
+        if( cluster->generationJob )
+        {
+            globalPlatform.WaitForJobGroup( globalPlatform.hiPriorityQueue, &cluster->generationJob->doneGroup );
+            cluster->generationJob = nullptr;
+        }
+    }
+    while( cache->leastRecentlyUsed )
+        EvictCluster( cache->leastRecentlyUsed, world );
     world->clusterTable.Clear();
 
     world->originClusterP = V3iZero;
@@ -1107,6 +1640,7 @@ UpdateWorldGeneration( GameInput* input, World* world, MemoryArena* arena, Memor
     }
     world->lastOriginClusterP = world->originClusterP;
 
+    UpdateClusterCache( world );
 
     {
         TIMED_SCOPE( "Translate live entities" );
@@ -1293,6 +1827,11 @@ UpdateAndRenderWorld( GameInput *input, GameMemory* gameMemory, RenderCommands *
         }
 #if !RELEASE
         debugState->totalEntities = world->liveEntities.count;
+        debugState->residentClusterCount = world->clusterCache.residentCount;
+        debugState->residentClusterBytes = world->clusterCache.residentBytes;
+        debugState->clusterCacheHits = world->clusterCache.hitCount;
+        debugState->clusterCacheMisses = world->clusterCache.missCount;
+        debugState->clusterCacheEvictions = world->clusterCache.evictionCount;
 #endif
     }
 
@@ -1310,7 +1849,9 @@ UpdateAndRenderWorld( GameInput *input, GameMemory* gameMemory, RenderCommands *
 
         Cluster* currentCluster = world->clusterTable.Find( world->originClusterP );
         // Render debug volumes
-        for( int i = 0; i < currentCluster->debugVolumes.count; ++i )
+        // NOTE Still being filled in while the cluster is generating
+        i32 debugVolumeCount = currentCluster->generationJob ? 0 : currentCluster->debugVolumes.count;
+        for( int i = 0; i < debugVolumeCount; ++i )
         {
             DebugVolume& v = currentCluster->debugVolumes[i];
             v4 color = v.color;
@@ -1334,7 +1875,7 @@ UpdateAndRenderWorld( GameInput *input, GameMemory* gameMemory, RenderCommands *
 
                     for( int m = 0; m < cluster->meshStore.count; ++m )
                     {
-                        Mesh const& mesh = cluster->meshStore[m];
+                        Mesh const& mesh = *cluster->meshStore[m];
                         RenderMeshCulled( mesh, renderCommands );
                     }
                 }
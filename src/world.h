@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #if NON_UNITY_BUILD
 #include "renderer.h"
 #include "meshgen.h"
+#include "sdf.h"
 #include "platform.h"
 #endif
 
@@ -103,14 +104,14 @@ struct LiveEntity
 
 // NOTE Everything related to maze generation and connectivity is measured in voxel units
 // Also, all integer voxel coords are relative to the "lower left" corner of the grid (cluster)
-const f32 VoxelSizeMeters = 2.f;
-const i32 VoxelsPerClusterAxis = 256;
+constexpr f32 VoxelSizeMeters = 2.f;
+constexpr i32 VoxelsPerClusterAxis = 256;
 
-const f32 ClusterSizeMeters = VoxelsPerClusterAxis * VoxelSizeMeters;
+constexpr f32 ClusterSizeMeters = VoxelsPerClusterAxis * VoxelSizeMeters;
 static_assert( (f32)(u32)(VoxelsPerClusterAxis * VoxelSizeMeters) == ClusterSizeMeters, "FAIL" );
 const v3 ClusterHalfSize = V3( ClusterSizeMeters * 0.5f );
 
-typedef Grid3D<u8> ClusterVoxelGrid;
+typedef BrickGrid3D<u8> ClusterVoxelGrid;
 
 
 // TODO Most of this will be in the stored entity when we turn rooms into that
@@ -134,6 +135,27 @@ struct Hall
     u8 axisOrder;
 };
 
+// Uniform grid over the whole cluster listing which rooms & halls touch each cell, so sampling only needs to look
+// at the volumes around each point instead of all of them
+constexpr i32 VolumeGridCellsPerAxis = 16;
+constexpr f32 VolumeGridCellSizeMeters = ClusterSizeMeters / VolumeGridCellsPerAxis;
+
+struct ClusterVolumeGrid
+{
+    // Where the index list for each cell starts, plus an extra entry at the end,
+    // so the list for cell c spans [starts[c], starts[c+1])
+    Array<i32> roomStarts;
+    Array<i32> hallStarts;
+    Array<i32> roomIndices;
+    Array<i32> hallIndices;
+};
+
+struct DebugVolume
+{
+    aabb bounds;
+    v4 color;
+};
+
 // TODO Pack minimal 8 byte coords for rooms and halls inline into this struct so everything is in contiguous memory and fast
 struct ClusterSamplingData
 {
@@ -141,16 +163,18 @@ struct ClusterSamplingData
 
     Array<Room> const& rooms;
     Array<Hall> const& halls;
-    // Show debug visualizations for this guy
-    Cluster* debugCluster;
+    ClusterVolumeGrid const& volumeGrid;
+    // Debug visualizations go here (if set)
+    BucketArray<DebugVolume>* debugVolumes;
     // Room index when sampling rooms, hall index for halls
     i32 sampledVolumeIndex;
 };
 
-ClusterSamplingData InitClusterSamplingData( Array<Room> const& rooms, Array<Hall> const& halls, int sampledVolumeIndex )
+ClusterSamplingData InitClusterSamplingData( Array<Room> const& rooms, Array<Hall> const& halls, ClusterVolumeGrid const& volumeGrid,
+                                             int sampledVolumeIndex )
 {
     SamplingData header = { SamplingDataType::ClusterData, true };
-    ClusterSamplingData result = { header, rooms, halls };
+    ClusterSamplingData result = { header, rooms, halls, volumeGrid };
     result.sampledVolumeIndex = sampledVolumeIndex;
 
     return result;
@@ -181,33 +205,111 @@ struct BinaryVolume
     u32 flags;
 };
 
-struct DebugVolume
-{
-    aabb bounds;
-    v4 color;
-};
-
 struct Cluster
 {
     // TODO Determine what the bucket size should be so we have just one bucket most of the time
     BucketArray<StoredEntity> entityStorage;
 
+    // Everything generated for the cluster lives here (except meshes), so it can all be dropped at once when evicted
+    // NOTE Only valid while the cluster is resident
+    MemoryArena arena;
+
     ClusterVoxelGrid voxelGrid;
     // TODO These should be actual entities (maybe just keep a minimal cache-friendly version here for fast iteration)
     Array<Room> rooms;
     Array<Hall> halls;
+    ClusterVolumeGrid volumeGrid;
+    // Whole cluster surface (halls minus rooms), compiled for each region we mesh
+    SDFNode* surfaceSDF;
 
 #if !RELEASE
     // Just for visualization
     BucketArray<DebugVolume> debugVolumes;
 #endif
 
-    // TODO This probably should go in a global mesh pool
-    Array<Mesh> meshStore;
+    // NOTE Each mesh lives in the pool of whichever worker generated it
+    Array<Mesh*> meshStore;
+    // Set while the cluster's generation job graph is running. Nothing in the cluster can be read or evicted
+    // from the main thread until the graph is done and this is cleared
+    struct ClusterGenerationJob* generationJob;
+
+    v3i clusterP;
+    // All that's needed to deterministically regenerate the cluster after it's been evicted
+    u32 seed;
+    // Arena plus meshes
+    sz residentBytes;
+    // Position in the cache's LRU list
+    Cluster* prevUsed;
+    Cluster* nextUsed;
 
     bool populated;
 };
 
+// Default budget for all resident clusters (arenas & meshes) before we start evicting the least recently used ones
+constexpr sz DefaultClusterCacheBudget = MEGABYTES(512);
+// The voxel grid is sparse, so this leaves room for a few thousand non-empty bricks
+constexpr sz ClusterArenaSize = MEGABYTES(4);
+
+// Clusters stay resident after leaving the sim region, until they go over budget. Evicted clusters keep their
+// table entry (and seed) but drop everything else, and are regenerated the next time they're needed
+struct ClusterCache
+{
+    // Backs the arenas of all resident clusters
+    MemoryPool memoryPool;
+    Cluster* mostRecentlyUsed;
+    Cluster* leastRecentlyUsed;
+
+    sz budgetBytes;
+    sz residentBytes;
+    i32 residentCount;
+
+    u32 hitCount;
+    u32 missCount;
+    u32 evictionCount;
+};
+
+// Data shared by all stages of a cluster's generation job graph
+// (partition -> meshing -> finish). Stages are chained as continuations of each other, so they never run concurrently
+// Lives in the cluster's arena. The main thread polls doneGroup and only then hands the results over to the cluster
+struct ClusterGenerationJob
+{
+    Cluster* cluster;
+    v3i clusterP;
+    struct World* world;
+    MemoryArena* arena;
+    // Mesh jobs copy their debug volumes to the arena while others may still be running
+    TicketMutex arenaMutex;
+    struct ClusterMeshJob* meshJobs;
+    i32 meshJobCount;
+    Array<Mesh*> meshes;
+    // Total size of all generated meshes
+    sz meshBytes;
+
+    PlatformJobGroup partitionGroup;
+    PlatformJobGroup meshGroup;
+    PlatformJobGroup doneGroup;
+};
+
+// Meshes each room or hall
+struct ClusterMeshJob
+{
+    ClusterGenerationJob* clusterJob;
+    i32 volumeIndex;
+    bool isRoom;
+
+#if !RELEASE
+    // Copied over from scratch memory once the job is done. The main thread merges them into the cluster
+    Array<DebugVolume> debugVolumes;
+#endif
+};
+
+// FIXME Rooms and halls still Z-fight where they touch, so only halls are meshed for now
+const bool MeshClusterRooms = false;
+// Split each volume into separately decimated inner & outer meshes
+// FIXME Off until FastDecimate is fixed (see there)
+const bool SplitVolumeMeshes = false;
+const int MeshesPerVolume = SplitVolumeMeshes ? 2 : 1;
+
 inline u32 ClusterHash( const v3i& key, i32 tableSize );
 inline u32 EntityHash( const u32& key, i32 tableSize );
 
@@ -236,6 +338,7 @@ struct World
     //
     // For now this will be the primary storage for (stored) entities
     HashTable<v3i, Cluster, ClusterHash> clusterTable;
+    ClusterCache clusterCache;
     // Scratch buffer for all the entities in the simulation region
     // (We take the clusters we want to simulate, expand the entities stored there to their live version, and then store them back
     // when they're no longer active. Clusters around the player are always kept live)
@@ -250,9 +353,10 @@ struct World
     v3i originClusterP;
     v3i lastOriginClusterP;
 
-    // TODO Should this be aligned and/or padded for cache niceness?
-    IsoSurfaceSamplingCache* samplingCache;
-    MeshPool* meshPools;
+    // One per worker thread
+    MeshGeneratorWorkerData* workerData;
+    i32 workerCount;
+    MeshHeap meshHeap;
 
     MeshGeneratorJob generatorJobs[PLATFORM_MAX_JOBQUEUE_JOBS];
     i32 lastAddedJob;